@@ -0,0 +1,86 @@
+#include "AsyncRaycaster.h"
+#include <memory>
+
+using namespace DirectX;
+
+void AsyncRaycaster::Run(std::function<void()> work)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mInFlight;
+    }
+
+    mPool.Submit([this, work]() {
+        work();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mInFlight == 0)
+            mIdleCv.notify_all();
+    });
+}
+
+void AsyncRaycaster::PushCompleted(std::function<void()> invoke)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCompleted.push_back(std::move(invoke));
+}
+
+std::future<RayHit> AsyncRaycaster::Query(const XMFLOAT3& orig, const XMFLOAT3& dir,
+    float tMin, float tMax)
+{
+    auto promise = std::make_shared<std::promise<RayHit>>();
+    std::future<RayHit> result = promise->get_future();
+    Run([this, promise, orig, dir, tMin, tMax]() {
+        RayHit hit;
+        mBvh.IntersectClosest(XMLoadFloat3(&orig), XMLoadFloat3(&dir), tMin, tMax, hit);
+        promise->set_value(hit);
+    });
+    return result;
+}
+
+void AsyncRaycaster::Query(const XMFLOAT3& orig, const XMFLOAT3& dir,
+    float tMin, float tMax, Callback onComplete)
+{
+    Run([this, onComplete, orig, dir, tMin, tMax]() {
+        RayHit hit;
+        mBvh.IntersectClosest(XMLoadFloat3(&orig), XMLoadFloat3(&dir), tMin, tMax, hit);
+        PushCompleted([onComplete, hit]() { onComplete(hit); });
+    });
+}
+
+void AsyncRaycaster::QueryBatch(std::vector<RayQuery> rays, BatchCallback onComplete)
+{
+    auto shared = std::make_shared<std::vector<RayQuery>>(std::move(rays));
+    Run([this, shared, onComplete]() {
+        auto hits = std::make_shared<std::vector<RayQueryHit>>(shared->size());
+        RaycastBatch batch;
+        batch.Trace(mBvh, mSubmeshes, shared->data(), shared->size(), hits->data(), &mPool);
+        PushCompleted([shared, hits, onComplete]() { onComplete(*shared, *hits); });
+    });
+}
+
+size_t AsyncRaycaster::DispatchCompleted()
+{
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ready.swap(mCompleted);
+    }
+
+    // Колбэк может сам отправить новый запрос, поэтому вызываем без блокировки.
+    for (auto& invoke : ready)
+        invoke();
+    return ready.size();
+}
+
+void AsyncRaycaster::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mIdleCv.wait(lock, [this] { return mInFlight == 0; });
+}
+
+uint32_t AsyncRaycaster::InFlight() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mInFlight;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+#include "BVH.h"
+#include "RaycastBatch.h"
+#include "WorkerPool.h"
+
+// Асинхронные запросы ближайшего пересечения к BVH на пуле потоков.
+// BVH читается из воркеров, поэтому перед Build/Refit нужно вызвать WaitIdle.
+class AsyncRaycaster
+{
+public:
+    typedef std::function<void(const RayHit& hit)> Callback;
+    typedef std::function<void(const std::vector<RayQuery>& rays,
+        const std::vector<RayQueryHit>& hits)> BatchCallback;
+
+    // submeshes — для SubmeshId в пачечных запросах, может быть nullptr.
+    AsyncRaycaster(WorkerPool& pool, const BVH& bvh, const SubmeshTable* submeshes = nullptr)
+        : mPool(pool), mBvh(bvh), mSubmeshes(submeshes) {}
+    ~AsyncRaycaster() { WaitIdle(); }
+
+    AsyncRaycaster(const AsyncRaycaster&) = delete;
+    AsyncRaycaster& operator=(const AsyncRaycaster&) = delete;
+
+    // Результат приходит через future (промах — RayHit с IsHit() == false).
+    std::future<RayHit> Query(const DirectX::XMFLOAT3& orig, const DirectX::XMFLOAT3& dir,
+        float tMin, float tMax);
+
+    // Колбэк вызывается не из воркера, а в DispatchCompleted на потоке, который его зовёт
+    // (в приложении — Update), так что ему можно трогать состояние кадра без блокировок.
+    void Query(const DirectX::XMFLOAT3& orig, const DirectX::XMFLOAT3& dir,
+        float tMin, float tMax, Callback onComplete);
+
+    // Пачка лучей через RaycastBatch; колбэк так же вызывается из DispatchCompleted.
+    void QueryBatch(std::vector<RayQuery> rays, BatchCallback onComplete);
+
+    // Вызывает колбэки завершённых запросов, возвращает их число.
+    size_t DispatchCompleted();
+
+    // Ждёт, пока воркеры закончат все запросы (колбэки при этом не вызываются).
+    void WaitIdle();
+
+    uint32_t InFlight() const;
+
+private:
+    // Выполняет work на пуле с учётом в InFlight.
+    void Run(std::function<void()> work);
+    void PushCompleted(std::function<void()> invoke);
+
+    WorkerPool&             mPool;
+    const BVH&              mBvh;
+    const SubmeshTable*     mSubmeshes;
+
+    mutable std::mutex      mMutex;
+    std::condition_variable mIdleCv;
+    uint32_t                mInFlight = 0;
+    std::vector<std::function<void()>> mCompleted;   // колбэки с уже привязанным результатом
+};
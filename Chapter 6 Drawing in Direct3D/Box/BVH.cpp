@@ -0,0 +1,369 @@
+#include "BVH.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    const int      kSahBins = 16;
+    const uint32_t kMaxLeafTris = 8;
+    const float    kTraversalCost = 1.0f;
+    const float    kIntersectCost = 1.0f;
+
+    float HalfArea(const XMFLOAT3& mn, const XMFLOAT3& mx)
+    {
+        float ex = mx.x - mn.x, ey = mx.y - mn.y, ez = mx.z - mn.z;
+        return ex * ey + ey * ez + ez * ex;
+    }
+
+    float Axis(const XMFLOAT3& v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    void Grow(XMFLOAT3& mn, XMFLOAT3& mx, const XMFLOAT3& p)
+    {
+        mn = { std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z) };
+        mx = { std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z) };
+    }
+
+    struct Bin
+    {
+        XMFLOAT3 Min = { FLT_MAX, FLT_MAX, FLT_MAX };
+        XMFLOAT3 Max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        uint32_t Count = 0;
+    };
+
+    // Расстояние входа в AABB или FLT_MAX, если луч его не пересекает.
+    float RayAabb(const XMFLOAT3& o, const XMFLOAT3& invD, const BVHNode& n, float tMin, float tMax)
+    {
+        float tx1 = (n.BoundsMin.x - o.x) * invD.x, tx2 = (n.BoundsMax.x - o.x) * invD.x;
+        float t0 = std::min(tx1, tx2), t1 = std::max(tx1, tx2);
+        float ty1 = (n.BoundsMin.y - o.y) * invD.y, ty2 = (n.BoundsMax.y - o.y) * invD.y;
+        t0 = std::max(t0, std::min(ty1, ty2)); t1 = std::min(t1, std::max(ty1, ty2));
+        float tz1 = (n.BoundsMin.z - o.z) * invD.z, tz2 = (n.BoundsMax.z - o.z) * invD.z;
+        t0 = std::max(t0, std::min(tz1, tz2)); t1 = std::min(t1, std::max(tz1, tz2));
+        t0 = std::max(t0, tMin);
+        t1 = std::min(t1, tMax);
+        return t0 <= t1 ? t0 : FLT_MAX;
+    }
+
+    float SafeInv(float d)
+    {
+        return std::fabs(d) > 1e-20f ? 1.0f / d : (d < 0.0f ? -1e30f : 1e30f);
+    }
+}
+
+void BVH::Clear()
+{
+    mNodes.clear();
+    mTriIds.clear();
+    mTris.Clear();
+    mDepth = 0;
+    mStorage.reset();
+    mView = BVHView();
+}
+
+void BVH::UpdateView()
+{
+    mView.Nodes = mNodes.data();
+    mView.NodeCount = mNodes.size();
+    mView.TriIds = mTriIds.data();
+    mView.TriCount = mTriIds.size();
+    mView.Tris = mTris.View();
+    mView.Depth = mDepth;
+}
+
+void BVH::Attach(const BVHView& view, std::shared_ptr<const void> storage)
+{
+    Clear();
+    mView = view;
+    mStorage = std::move(storage);
+}
+
+void BVH::Build(const PositionsSoA& positions, const uint32_t* indices, size_t indexCount)
+{
+    Clear();
+
+    const uint32_t triCount = (uint32_t)(indexCount / 3);
+    if (triCount == 0 || positions.Count == 0) return;
+
+    std::vector<BuildTri> tris(triCount);
+    mTriIds.resize(triCount);
+    for (uint32_t i = 0; i < triCount; ++i)
+    {
+        XMFLOAT3 a = positions.Get(indices[3 * i + 0]);
+        XMFLOAT3 b = positions.Get(indices[3 * i + 1]);
+        XMFLOAT3 c = positions.Get(indices[3 * i + 2]);
+
+        BuildTri& t = tris[i];
+        t.Min = a; t.Max = a;
+        Grow(t.Min, t.Max, b);
+        Grow(t.Min, t.Max, c);
+        t.Centroid = {
+            (t.Min.x + t.Max.x) * 0.5f,
+            (t.Min.y + t.Max.y) * 0.5f,
+            (t.Min.z + t.Max.z) * 0.5f };
+        mTriIds[i] = i;
+    }
+
+    // Бинарное дерево с листьями >= 1 треугольника не превышает 2N-1 узлов.
+    mNodes.reserve(2 * (size_t)triCount);
+    BVHNode root = {};
+    root.LeftFirst = 0;
+    root.TriCount = triCount;
+    mNodes.push_back(root);
+    UpdateNodeBounds(0, tris);
+    Subdivide(0, tris, 1);
+    mNodes.shrink_to_fit();
+
+    mTris.Build(positions, indices, mTriIds.size(), mTriIds.data());
+    UpdateView();
+}
+
+void BVH::Refit(const PositionsSoA& positions, const uint32_t* indices, size_t indexCount)
+{
+    if (mStorage)
+    {
+        // Отображённый кэш только для чтения — переносим в свои массивы
+        BVHView view = mView;
+        std::shared_ptr<const void> storage = std::move(mStorage);
+        mNodes.assign(view.Nodes, view.Nodes + view.NodeCount);
+        mTriIds.assign(view.TriIds, view.TriIds + view.TriCount);
+        mDepth = view.Depth;
+    }
+
+    if (mNodes.empty() || indexCount / 3 != mTriIds.size())
+    {
+        Build(positions, indices, indexCount);
+        return;
+    }
+
+    mTris.Build(positions, indices, mTriIds.size(), mTriIds.data());
+
+    // Дети всегда лежат после родителя, поэтому обратный проход идёт снизу вверх.
+    for (size_t i = mNodes.size(); i-- > 0;)
+    {
+        BVHNode& node = mNodes[i];
+        node.BoundsMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+        node.BoundsMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        if (node.IsLeaf())
+        {
+            for (uint32_t t = 0; t < node.TriCount; ++t)
+            {
+                const uint32_t* tri = indices + 3 * (size_t)mTriIds[node.LeftFirst + t];
+                for (int k = 0; k < 3; ++k)
+                    Grow(node.BoundsMin, node.BoundsMax, positions.Get(tri[k]));
+            }
+        }
+        else
+        {
+            for (uint32_t c = 0; c < 2; ++c)
+            {
+                Grow(node.BoundsMin, node.BoundsMax, mNodes[node.LeftFirst + c].BoundsMin);
+                Grow(node.BoundsMin, node.BoundsMax, mNodes[node.LeftFirst + c].BoundsMax);
+            }
+        }
+    }
+
+    UpdateView();
+}
+
+void BVH::UpdateNodeBounds(uint32_t nodeIdx, const std::vector<BuildTri>& tris)
+{
+    BVHNode& node = mNodes[nodeIdx];
+    node.BoundsMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    node.BoundsMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = 0; i < node.TriCount; ++i)
+    {
+        const BuildTri& t = tris[mTriIds[node.LeftFirst + i]];
+        Grow(node.BoundsMin, node.BoundsMax, t.Min);
+        Grow(node.BoundsMin, node.BoundsMax, t.Max);
+    }
+}
+
+float BVH::FindBestSplit(const BVHNode& node, const std::vector<BuildTri>& tris,
+    int& axis, float& splitPos) const
+{
+    XMFLOAT3 cMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    XMFLOAT3 cMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = 0; i < node.TriCount; ++i)
+        Grow(cMin, cMax, tris[mTriIds[node.LeftFirst + i]].Centroid);
+
+    float bestCost = FLT_MAX;
+    for (int a = 0; a < 3; ++a)
+    {
+        float lo = Axis(cMin, a), hi = Axis(cMax, a);
+        if (hi <= lo) continue;
+
+        Bin bins[kSahBins];
+        float scale = kSahBins / (hi - lo);
+        for (uint32_t i = 0; i < node.TriCount; ++i)
+        {
+            const BuildTri& t = tris[mTriIds[node.LeftFirst + i]];
+            int b = std::min(kSahBins - 1, (int)((Axis(t.Centroid, a) - lo) * scale));
+            bins[b].Count++;
+            Grow(bins[b].Min, bins[b].Max, t.Min);
+            Grow(bins[b].Min, bins[b].Max, t.Max);
+        }
+
+        float    leftArea[kSahBins - 1], rightArea[kSahBins - 1];
+        uint32_t leftCount[kSahBins - 1], rightCount[kSahBins - 1];
+        Bin l, r;
+        uint32_t lSum = 0, rSum = 0;
+        for (int i = 0; i < kSahBins - 1; ++i)
+        {
+            lSum += bins[i].Count;
+            leftCount[i] = lSum;
+            if (bins[i].Count) { Grow(l.Min, l.Max, bins[i].Min); Grow(l.Min, l.Max, bins[i].Max); }
+            leftArea[i] = lSum ? HalfArea(l.Min, l.Max) : 0.0f;
+
+            int j = kSahBins - 1 - i;
+            rSum += bins[j].Count;
+            rightCount[j - 1] = rSum;
+            if (bins[j].Count) { Grow(r.Min, r.Max, bins[j].Min); Grow(r.Min, r.Max, bins[j].Max); }
+            rightArea[j - 1] = rSum ? HalfArea(r.Min, r.Max) : 0.0f;
+        }
+
+        for (int i = 0; i < kSahBins - 1; ++i)
+        {
+            if (leftCount[i] == 0 || rightCount[i] == 0) continue;
+            float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                axis = a;
+                splitPos = lo + (i + 1) / scale;
+            }
+        }
+    }
+    return bestCost;
+}
+
+void BVH::Subdivide(uint32_t nodeIdx, std::vector<BuildTri>& tris, uint32_t depth)
+{
+    mDepth = std::max(mDepth, depth);
+
+    BVHNode& node = mNodes[nodeIdx];
+    if (node.TriCount <= 1 || depth >= kBVHMaxDepth) return;
+
+    int   axis = -1;
+    float splitPos = 0.0f;
+    float splitCost = FindBestSplit(node, tris, axis, splitPos);
+
+    // Все центроиды совпали — делить нечем.
+    if (axis < 0) return;
+
+    float leafCost = kIntersectCost * node.TriCount * HalfArea(node.BoundsMin, node.BoundsMax);
+    splitCost = kTraversalCost * HalfArea(node.BoundsMin, node.BoundsMax) + kIntersectCost * splitCost;
+    if (splitCost >= leafCost && node.TriCount <= kMaxLeafTris) return;
+
+    uint32_t* first = mTriIds.data() + node.LeftFirst;
+    uint32_t* last = first + node.TriCount;
+    uint32_t* mid = std::partition(first, last, [&](uint32_t id) {
+        return Axis(tris[id].Centroid, axis) < splitPos;
+        });
+
+    // Бины не разделили набор (float-граница) — режем по медиане.
+    if (mid == first || mid == last)
+    {
+        mid = first + node.TriCount / 2;
+        std::nth_element(first, mid, last, [&](uint32_t a, uint32_t b) {
+            return Axis(tris[a].Centroid, axis) < Axis(tris[b].Centroid, axis);
+            });
+    }
+
+    uint32_t leftCount = (uint32_t)(mid - first);
+    uint32_t leftIdx = (uint32_t)mNodes.size();
+
+    BVHNode left = {};
+    left.LeftFirst = node.LeftFirst;
+    left.TriCount = leftCount;
+    BVHNode right = {};
+    right.LeftFirst = node.LeftFirst + leftCount;
+    right.TriCount = node.TriCount - leftCount;
+
+    node.LeftFirst = leftIdx;
+    node.TriCount = 0;
+
+    mNodes.push_back(left);
+    mNodes.push_back(right);
+    UpdateNodeBounds(leftIdx, tris);
+    UpdateNodeBounds(leftIdx + 1, tris);
+
+    Subdivide(leftIdx, tris, depth + 1);
+    Subdivide(leftIdx + 1, tris, depth + 1);
+}
+
+bool BVH::IntersectClosest(FXMVECTOR orig, FXMVECTOR dir,
+    float tMin, float tMax, RayHit& hit) const
+{
+    if (mView.NodeCount == 0) return false;
+
+    XMFLOAT3 o, d;
+    XMStoreFloat3(&o, orig);
+    XMStoreFloat3(&d, dir);
+    XMFLOAT3 invD = { SafeInv(d.x), SafeInv(d.y), SafeInv(d.z) };
+
+    float closest = tMax;
+    uint32_t closestTri = UINT32_MAX;
+
+    const BVHNode*     nodes = mView.Nodes;
+    const TrianglesSoA& tris = mView.Tris;
+
+    uint32_t stack[kBVHMaxDepth];
+    int      sp = 0;
+    uint32_t nodeIdx = 0;
+    if (RayAabb(o, invD, nodes[0], tMin, closest) == FLT_MAX) return false;
+
+    for (;;)
+    {
+        const BVHNode& node = nodes[nodeIdx];
+        if (node.IsLeaf())
+        {
+            uint32_t tri = IntersectTriangles(tris, node.LeftFirst, node.TriCount, o, d, tMin, closest);
+            if (tri != UINT32_MAX) closestTri = tri;
+            if (sp == 0) break;
+            nodeIdx = stack[--sp];
+            continue;
+        }
+
+        uint32_t nearIdx = node.LeftFirst, farIdx = node.LeftFirst + 1;
+        float dNear = RayAabb(o, invD, nodes[nearIdx], tMin, closest);
+        float dFar = RayAabb(o, invD, nodes[farIdx], tMin, closest);
+        if (dFar < dNear) { std::swap(nearIdx, farIdx); std::swap(dNear, dFar); }
+
+        if (dNear == FLT_MAX)
+        {
+            if (sp == 0) break;
+            nodeIdx = stack[--sp];
+        }
+        else
+        {
+            nodeIdx = nearIdx;
+            if (dFar != FLT_MAX) stack[sp++] = farIdx;
+        }
+    }
+
+    if (closestTri == UINT32_MAX) return false;
+    hit.T = closest;
+    hit.TriangleId = mView.TriIds[closestTri];
+    return true;
+}
+
+float BVH::SahCost() const
+{
+    if (mView.NodeCount == 0) return 0.0f;
+    float rootArea = HalfArea(mView.Nodes[0].BoundsMin, mView.Nodes[0].BoundsMax);
+    if (rootArea <= 0.0f) return 0.0f;
+
+    float cost = 0.0f;
+    for (size_t i = 0; i < mView.NodeCount; ++i)
+    {
+        const BVHNode& n = mView.Nodes[i];
+        float a = HalfArea(n.BoundsMin, n.BoundsMax) / rootArea;
+        cost += n.IsLeaf() ? kIntersectCost * n.TriCount * a : kTraversalCost * a;
+    }
+    return cost;
+}
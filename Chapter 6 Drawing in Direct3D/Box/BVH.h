@@ -0,0 +1,87 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cfloat>
+#include <memory>
+#include <vector>
+#include "RayTriangle.h"
+
+// Глубина дерева = верхняя граница стека обхода; Build глубже не делит, LoadBVHCache глубже не принимает.
+static const uint32_t kBVHMaxDepth = 64;
+
+// 32 байта: два узла на кэш-линию.
+struct BVHNode
+{
+    DirectX::XMFLOAT3 BoundsMin;
+    uint32_t          LeftFirst;   // inner: индекс левого ребёнка (правый = +1), leaf: первый треугольник
+    DirectX::XMFLOAT3 BoundsMax;
+    uint32_t          TriCount;    // 0 у внутренних узлов
+
+    bool IsLeaf() const { return TriCount > 0; }
+};
+
+// То, что нужно обходу: узлы, leaf-порядок треугольников и их SoA.
+// Указывает либо на собственные массивы BVH, либо на внешнюю память (отображённый кэш).
+struct BVHView
+{
+    const BVHNode*  Nodes = nullptr;
+    size_t          NodeCount = 0;
+    const uint32_t* TriIds = nullptr;   // leaf-порядок -> исходный треугольник
+    size_t          TriCount = 0;
+    TrianglesSoA    Tris;
+    uint32_t        Depth = 0;
+};
+
+// BVH над треугольным супом (позиции + 32-битные индексы), SAH-сборка по бинам.
+class BVH
+{
+public:
+    BVH() = default;
+
+    void Build(const PositionsSoA& positions, const uint32_t* indices, size_t indexCount);
+
+    // Топология та же, позиции сдвинулись: пересчёт боксов снизу вверх без пересборки.
+    void Refit(const PositionsSoA& positions, const uint32_t* indices, size_t indexCount);
+
+    void Clear();
+
+    // Обход по чужой памяти без копирования; storage держит её живой.
+    // Refit после Attach сначала копирует данные в собственные массивы.
+    void Attach(const BVHView& view, std::shared_ptr<const void> storage);
+
+    // Ближайшее пересечение с t в (tMin, tMax). dir не обязан быть нормализован.
+    bool IntersectClosest(
+        DirectX::FXMVECTOR orig, DirectX::FXMVECTOR dir,
+        float tMin, float tMax, RayHit& hit) const;
+
+    bool     Empty()         const { return mView.NodeCount == 0; }
+    size_t   NodeCount()     const { return mView.NodeCount; }
+    size_t   TriangleCount() const { return mView.TriCount; }
+    uint32_t Depth()         const { return mView.Depth; }
+    bool     IsAttached()    const { return mStorage != nullptr; }
+    float    SahCost()       const;
+
+    const BVHView& View() const { return mView; }
+
+private:
+    struct BuildTri
+    {
+        DirectX::XMFLOAT3 Min;
+        DirectX::XMFLOAT3 Max;
+        DirectX::XMFLOAT3 Centroid;
+    };
+
+    void UpdateNodeBounds(uint32_t nodeIdx, const std::vector<BuildTri>& tris);
+    void Subdivide(uint32_t nodeIdx, std::vector<BuildTri>& tris, uint32_t depth);
+    float FindBestSplit(const BVHNode& node, const std::vector<BuildTri>& tris,
+        int& axis, float& splitPos) const;
+    void UpdateView();
+
+    std::vector<BVHNode>           mNodes;
+    std::vector<uint32_t>          mTriIds;    // leaf-порядок -> исходный треугольник
+    TriangleStream                 mTris;      // SoA-треугольники в leaf-порядке
+    uint32_t                       mDepth = 0;
+
+    BVHView                        mView;
+    std::shared_ptr<const void>    mStorage;   // не null, пока mView смотрит во внешнюю память
+};
@@ -0,0 +1,144 @@
+#include "BVHCache.h"
+#include "BinaryFile.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+    // Обход идёт без проверок, поэтому дерево проверяется целиком: у внутреннего узла пара детей
+    // после него и в массиве, у каждого узла один родитель, лист — в пределах треугольников,
+    // глубина не больше depth. Build кладёт детей после родителя, так что хватает прохода по порядку.
+    bool ValidNodes(const BVHNode* nodes, uint32_t nodeCount, uint32_t triCount, uint32_t depth)
+    {
+        std::vector<uint32_t> nodeDepth(nodeCount, UINT32_MAX);
+        nodeDepth[0] = 0;
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            const BVHNode& node = nodes[i];
+            if (nodeDepth[i] == UINT32_MAX) return false;
+            if (node.IsLeaf())
+            {
+                if ((uint64_t)node.LeftFirst + node.TriCount > triCount) return false;
+                continue;
+            }
+            uint32_t left = node.LeftFirst;
+            if (left <= i || (uint64_t)left + 1 >= nodeCount || nodeDepth[i] >= depth) return false;
+            if (nodeDepth[left] != UINT32_MAX || nodeDepth[left + 1] != UINT32_MAX) return false;
+            nodeDepth[left] = nodeDepth[left + 1] = nodeDepth[i] + 1;
+        }
+        return true;
+    }
+}
+
+std::string BVHCachePath(const std::string& objPath)
+{
+    return objPath + ".bvh";
+}
+
+bool SaveBVHCache(const std::string& path, const BVH& bvh, uint64_t sourceHash, uint64_t indexCount)
+{
+    const BVHView& view = bvh.View();
+    if (view.NodeCount == 0) return false;
+
+    BVHCacheHeader h = {};
+    h.Version = kBVHCacheVersion;
+    h.SourceHash = sourceHash;
+    h.IndexCount = indexCount;
+    h.NodeCount = (uint32_t)view.NodeCount;
+    h.TriCount = (uint32_t)view.TriCount;
+    h.Depth = view.Depth;
+    h.NodeSize = sizeof(BVHNode);
+    h.TriStride = AlignUp((view.TriCount + 8) * sizeof(float)) / sizeof(float);
+    h.NodesOffset = AlignUp(sizeof(BVHCacheHeader));
+    h.TriIdsOffset = AlignUp(h.NodesOffset + (uint64_t)view.NodeCount * sizeof(BVHNode));
+    h.TrisOffset = AlignUp(h.TriIdsOffset + (uint64_t)view.TriCount * sizeof(uint32_t));
+    h.FileSize = h.TrisOffset + 9 * h.TriStride * sizeof(float);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    out.write((const char*)&h, sizeof(h));
+    WritePadding(out, h.NodesOffset);
+    out.write((const char*)view.Nodes, (std::streamsize)(view.NodeCount * sizeof(BVHNode)));
+    WritePadding(out, h.TriIdsOffset);
+    out.write((const char*)view.TriIds, (std::streamsize)(view.TriCount * sizeof(uint32_t)));
+
+    const float* const arrays[9] = {
+        view.Tris.V0[0], view.Tris.V0[1], view.Tris.V0[2],
+        view.Tris.E1[0], view.Tris.E1[1], view.Tris.E1[2],
+        view.Tris.E2[0], view.Tris.E2[1], view.Tris.E2[2] };
+    for (int k = 0; k < 9; ++k)
+    {
+        WritePadding(out, h.TrisOffset + k * h.TriStride * sizeof(float));
+        out.write((const char*)arrays[k], (std::streamsize)(view.TriCount * sizeof(float)));
+    }
+    WritePadding(out, h.FileSize);
+
+    h.Magic = kBVHCacheMagic;
+    out.seekp(0);
+    out.write((const char*)&h, sizeof(h));
+    return (bool)out;
+}
+
+bool LoadBVHCache(const std::string& path, uint64_t sourceHash, uint64_t indexCount, BVH& bvh)
+{
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(path) || file->Size() < sizeof(BVHCacheHeader)) return false;
+
+    BVHCacheHeader h;
+    std::memcpy(&h, file->Data(), sizeof(h));
+    if (h.Magic != kBVHCacheMagic || h.Version != kBVHCacheVersion ||
+        h.SourceHash != sourceHash || h.IndexCount != indexCount ||
+        h.NodeSize != sizeof(BVHNode) || h.FileSize != file->Size())
+        return false;
+
+    // Границы и выравнивание секций: данные будут читаться по этим указателям напрямую.
+    bool aligned = h.NodesOffset % kSectionAlign == 0 && h.TriIdsOffset % kSectionAlign == 0 &&
+        h.TrisOffset % kSectionAlign == 0 && (h.TriStride * sizeof(float)) % kSectionAlign == 0;
+    bool inside = h.NodeCount > 0 && h.TriStride >= (uint64_t)h.TriCount + 8 &&
+        h.NodesOffset + (uint64_t)h.NodeCount * sizeof(BVHNode) <= h.TriIdsOffset &&
+        h.TriIdsOffset + (uint64_t)h.TriCount * sizeof(uint32_t) <= h.TrisOffset &&
+        h.TrisOffset + 9 * h.TriStride * sizeof(float) <= h.FileSize;
+    if (!aligned || !inside || h.Depth > kBVHMaxDepth) return false;
+
+    const uint8_t* base = file->Data();
+    const float* tris = (const float*)(base + h.TrisOffset);
+    const BVHNode* nodes = (const BVHNode*)(base + h.NodesOffset);
+    const uint32_t* triIds = (const uint32_t*)(base + h.TriIdsOffset);
+    if (!ValidNodes(nodes, h.NodeCount, h.TriCount, h.Depth)) return false;
+    for (uint32_t i = 0; i < h.TriCount; ++i)
+        if (triIds[i] >= indexCount / 3) return false;
+
+    BVHView view;
+    view.Nodes = nodes;
+    view.NodeCount = h.NodeCount;
+    view.TriIds = triIds;
+    view.TriCount = h.TriCount;
+    view.Depth = h.Depth;
+    for (int k = 0; k < 3; ++k)
+    {
+        view.Tris.V0[k] = tris + (0 + k) * h.TriStride;
+        view.Tris.E1[k] = tris + (3 + k) * h.TriStride;
+        view.Tris.E2[k] = tris + (6 + k) * h.TriStride;
+    }
+    view.Tris.Count = h.TriCount;
+
+    bvh.Attach(view, file);
+    return true;
+}
+
+BVHSource LoadOrBuildBVH(const std::string& objPath, uint64_t objHash,
+    const PositionsSoA& positions, const uint32_t* indices, size_t indexCount, BVH& bvh)
+{
+    uint64_t hash = HashBytes64(indices, indexCount * sizeof(uint32_t), objHash);
+    std::string cachePath = BVHCachePath(objPath);
+
+    if (LoadBVHCache(cachePath, hash, indexCount, bvh))
+        return BVHSource::Cache;
+
+    bvh.Build(positions, indices, indexCount);
+    SaveBVHCache(cachePath, bvh, hash, indexCount);
+    return BVHSource::Built;
+}
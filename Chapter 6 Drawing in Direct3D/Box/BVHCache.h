@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "BVH.h"
+
+// Бинарный кэш BVH рядом с моделью (<obj>.bvh). Файл отображается в память, и BVH
+// обходит его напрямую (BVH::Attach), без копирования и разбора.
+//
+// Layout (little-endian, секции выровнены по 64 байтам):
+//   BVHCacheHeader
+//   BVHNode[NodeCount]
+//   uint32_t TriIds[TriCount]
+//   float Tris[9][TriStride]   — V0xyz, E1xyz, E2xyz, хвост до TriStride нулевой
+
+static const uint32_t kBVHCacheMagic = 0x43485642;   // "BVHC"
+static const uint32_t kBVHCacheVersion = 2;          // менять при смене BVHNode, сборки или ядра
+
+struct BVHCacheHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t SourceHash;     // хэш исходного OBJ и итогового index buffer
+    uint64_t IndexCount;     // размер index buffer, по которому строилось дерево
+    uint32_t NodeCount;
+    uint32_t TriCount;
+    uint32_t Depth;
+    uint32_t NodeSize;       // sizeof(BVHNode) на момент записи
+    uint64_t NodesOffset;
+    uint64_t TriIdsOffset;
+    uint64_t TrisOffset;
+    uint64_t TriStride;      // floats на каждый из 9 SoA-массивов, >= TriCount + 8
+    uint64_t FileSize;
+};
+
+std::string BVHCachePath(const std::string& objPath);
+
+bool SaveBVHCache(const std::string& path, const BVH& bvh, uint64_t sourceHash, uint64_t indexCount);
+
+// false, если файла нет, он другой версии, от другого OBJ или повреждён.
+bool LoadBVHCache(const std::string& path, uint64_t sourceHash, uint64_t indexCount, BVH& bvh);
+
+enum class BVHSource
+{
+    Cache,
+    Built,
+};
+
+// Кэш по хэшу OBJ (objHash, см. HashFile64) и indices — порядок треугольников зависит
+// от обработки меша после импорта; при промахе строит BVH и перезаписывает кэш.
+BVHSource LoadOrBuildBVH(const std::string& objPath, uint64_t objHash,
+    const PositionsSoA& positions, const uint32_t* indices, size_t indexCount, BVH& bvh);
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+// Общее для файлов, которые пишутся рядом с моделью (пакет меша, кэш BVH, окклюдеры), и для сварки
+// вершин. Секции файла выровнены по kSectionAlign, чтобы читать их прямо из MappedFile.
+// Заголовок пишется дважды: сначала с нулевым Magic, в конце — с настоящим, поэтому оборванная
+// запись не примется за валидный файл.
+
+const uint64_t kSectionAlign = 64;
+
+inline uint64_t AlignUp(uint64_t v)
+{
+    return (v + kSectionAlign - 1) & ~(kSectionAlign - 1);
+}
+
+inline void WritePadding(std::ofstream& out, uint64_t to)
+{
+    static const char zeros[kSectionAlign] = {};
+    uint64_t pos = (uint64_t)out.tellp();
+    if (to > pos) out.write(zeros, (std::streamsize)(to - pos));
+}
+
+// Позиция, сравниваемая побитово, как при сварке в WeldObjIndices
+struct PositionKey
+{
+    uint32_t Bits[3];
+    bool operator==(const PositionKey& o) const
+    {
+        return Bits[0] == o.Bits[0] && Bits[1] == o.Bits[1] && Bits[2] == o.Bits[2];
+    }
+};
+
+struct PositionKeyHash
+{
+    size_t operator()(const PositionKey& k) const
+    {
+        uint64_t h = (uint64_t)k.Bits[0] * 0x9E3779B97F4A7C15ull;
+        h ^= (uint64_t)k.Bits[1] * 0xC2B2AE3D27D4EB4Full;
+        h ^= (uint64_t)k.Bits[2] * 0x165667B19E3779F9ull;
+        return (size_t)(h ^ (h >> 32));
+    }
+};
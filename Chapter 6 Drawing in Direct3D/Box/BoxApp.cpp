@@ -1,6 +1,6 @@
 //***************************************************************************************
 // BoxApp.cpp
-// Deferred rendering with Sponza + shot point lights (Space = shoot from camera)
+// Deferred rendering with Sponza + shot point lights (Space = shoot from camera, V = volley)
 //***************************************************************************************
 
 #include "Common/d3dApp.h"
@@ -10,21 +10,91 @@
 #include "Common/DDSTextureLoader.h"
 #include "Common/d3dx12.h"
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
+#include "ModelImporter.h"
 #include "RenderingSystem.h"
+#include "AsyncRaycaster.h"
+#include "BVHCache.h"
+#include "MeshOptimizer.h"
+#include "MeshPackage.h"
+#include "GeometryUploadQueue.h"
+#include "Meshlet.h"
+#include "MeshSimplifier.h"
+#include "FrustumCull.h"
+#include "OcclusionBuffer.h"
+#include "OccluderMesh.h"
+#include "CameraPath.h"
+#include <chrono>
+#include <filesystem>
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 using namespace DirectX::PackedVector;
 
-struct Vertex
+static const char kSponzaObjPath[] = "Sponza-master/sponza.obj";
+static const char kStarObjPath[] = "models/source/725b3a4da0ef_Tiny_green_starw__3.obj";
+
+// OBJ от этого размера (фотограмметрия) импортируются потоково, без ImportedMesh и пакета
+static const std::uintmax_t kStreamImportMinBytes = 512ull << 20;
+// Сколько upload-памяти копится при потоковом импорте, прежде чем дождаться GPU
+static const UINT64 kStreamUploadBudget = 256ull << 20;
+
+// Compressed — 16-байтные PackedVertex вместо 32-байтных (см. VertexCompression.h)
+static const VertexFormat kVertexFormat = VertexFormat::Full;
+
+// Допустимая ошибка LOD на экране, в пикселях (см. SelectLod)
+static const float kLodPixelError = 1.0f;
+static const float kFovY = XM_PIDIV4;
+
+// Время фаз запуска — в окно Output отладчика
+static void LogStartupPhase(const char* name, double ms, const char* note = "")
+{
+    char line[256];
+    snprintf(line, sizeof(line), "[startup] %-18s %8.1f ms  %s\n", name, ms, note);
+    OutputDebugStringA(line);
+}
+
+class StartupPhase
 {
-    XMFLOAT3 Pos;
-    XMFLOAT3 Normal;
-    XMFLOAT2 TexC;
+public:
+    explicit StartupPhase(const char* name)
+        : mName(name), mStart(std::chrono::high_resolution_clock::now()) {}
+    ~StartupPhase() { LogStartupPhase(mName, ElapsedMs(), mNote.c_str()); }
+
+    double ElapsedMs() const
+    {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - mStart).count();
+    }
+    void SetNote(const std::string& note) { mNote = note; }
+
+private:
+    const char* mName;
+    std::string mNote;
+    std::chrono::high_resolution_clock::time_point mStart;
 };
 
+// Раскладка вершины общая с ImportObjMesh и бинарным пакетом модели
+using Vertex = MeshVertex;
+
+// Размер VB до/после сварки (до — по вершине на индекс) и ACMR после сварки и оптимизации порядка
+static void LogWeldStats(const char* name, const std::uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    VertexCacheStats stats = AnalyzeVertexCache(indices, indexCount, vertexCount);
+    char line[256];
+    snprintf(line, sizeof(line), "[startup] %-18s VB %.2f -> %.2f MB (%zu -> %zu verts), ACMR 3.00 -> %.2f\n",
+        name, indexCount * sizeof(Vertex) / 1048576.0, vertexCount * sizeof(Vertex) / 1048576.0,
+        indexCount, vertexCount, stats.ACMR);
+    OutputDebugStringA(line);
+}
+
+// Расстояние от точки до AABB, 0 — точка внутри
+static float DistanceToBox(const BoundingBox& box, FXMVECTOR point)
+{
+    XMVECTOR outside = XMVectorSubtract(XMVectorAbs(XMVectorSubtract(point, XMLoadFloat3(&box.Center))),
+        XMLoadFloat3(&box.Extents));
+    return XMVectorGetX(XMVector3Length(XMVectorMax(outside, XMVectorZero())));
+}
+
 struct MyTexture
 {
     std::string Name;
@@ -35,32 +105,40 @@ struct MyTexture
 
 struct RenderItem
 {
-    std::string SubmeshName;
-    int         TexSrvIndex;
-    bool        IsStar = false;
+    std::string  SubmeshName;
+    int          TexSrvIndex;
+    bool         IsStar = false;
+    XMFLOAT4X4   World = MathHelper::Identity4x4();
+    int          PickRange = -1;   // диапазон в WorldVertexCache, -1 — не участвует в пикинге
+    MeshletRange Meshlets;         // в mSponzaMeshlets
+
+    // Уровни детализации в DrawArgs: LodNames[0] == SubmeshName, дальше "<name>#lod1"...
+    std::vector<std::string> LodNames;
+    std::vector<float>       LodErrors;    // геометрическая ошибка уровня, у LOD0 — 0
 };
 
-static bool RayTriangleIntersect(
-    FXMVECTOR orig, FXMVECTOR dir,
-    FXMVECTOR v0, GXMVECTOR v1, HXMVECTOR v2,
-    float& t)
-{
-    const float EPS = 1e-7f;
-    XMVECTOR edge1 = v1 - v0;
-    XMVECTOR edge2 = v2 - v0;
-    XMVECTOR h = XMVector3Cross(dir, edge2);
-    float    a = XMVectorGetX(XMVector3Dot(edge1, h));
-    if (a > -EPS && a < EPS) return false;
-    float    f = 1.0f / a;
-    XMVECTOR s = orig - v0;
-    float    u = f * XMVectorGetX(XMVector3Dot(s, h));
-    if (u < 0.0f || u > 1.0f) return false;
-    XMVECTOR q = XMVector3Cross(s, edge1);
-    float    v = f * XMVectorGetX(XMVector3Dot(dir, q));
-    if (v < 0.0f || u + v > 1.0f) return false;
-    t = f * XMVectorGetX(XMVector3Dot(edge2, q));
-    return t > 0.001f;
-}
+// Итог отсечения по frustum за последний кадр (сабмеши Sponza и маркеры выстрелов)
+struct CullStats
+{
+    UINT Visible = 0;
+    UINT Culled = 0;
+    UINT Occluded = 0;    // прошли frustum, но закрыты окклюдерами
+    UINT Triangles = 0;   // в нарисованных уровнях LOD
+};
+
+// Запись команд за кадр: draw-вызовы и занятые слоты cbPerObject (их kMaxGeometryCBs)
+struct DrawStats
+{
+    UINT DrawCalls = 0;
+    UINT GeometryCBs = 0;
+    UINT Instances = 0;   // маркеров в инстансном вызове
+};
+
+struct VisibleItem
+{
+    UINT          Item;   // индекс в mRenderItems
+    std::uint32_t Lod;
+};
 
 class BoxApp : public D3DApp
 {
@@ -78,11 +156,22 @@ private:
     virtual void OnMouseMove(WPARAM btnState, int x, int y) override;
     virtual LRESULT MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) override;
 
-    void LoadTextures();
+    void LoadTextures(const std::vector<std::string>& diffuseTextures);
     void BuildDescriptorHeaps();
-    void BuildModelGeometry();
+    void BuildModelGeometry(const MeshPackage& sponza);
+    bool StreamModelGeometry(std::string& error);
+    void AddSponzaSubmesh(const ImportedSubmesh& shape, const std::vector<std::string>& diffuseTextures,
+        const SubmeshGeometry& submesh);
+    void AddPickGeometry(const XMFLOAT3* positions, UINT vertexCount, UINT positionStride,
+        const std::uint32_t* indices, UINT indexCount, UINT indexOffset);
+    void AddSubmeshLods(const SubmeshGeometry& lod0, const std::uint32_t* lodIndices, const MeshLod* lods,
+        std::uint32_t lodCount, UINT indexOffset);
+    void FinishModelGeometry(std::uint64_t sponzaHash);
+    UINT AppendModelVertices(const Vertex* vertices, UINT count, BoundingBox& bounds);
+    void ExecuteUploads(bool reopen);
     void BuildDepthSRV();
-    void ShootLightFromCamera();
+    void ShootLightsFromCamera(uint32_t count);
+    void CullRenderItems(FXMMATRIX world, CXMMATRIX view, CXMMATRIX proj);
 
 private:
     RenderingSystem mRenderingSystem;
@@ -94,6 +183,20 @@ private:
     D3D12_GPU_DESCRIPTOR_HANDLE mDepthSrvGpuHandle = {};
 
     std::vector<RenderItem> mRenderItems;
+    std::vector<VisibleItem> mVisibleItems;   // Sponza после CullRenderItems
+    AabbStream mItemBounds;                   // Bounds LOD0 по индексу RenderItem, в пространстве модели
+    std::vector<uint32_t> mVisibleScratch;
+    OccluderSet mOccluders;                   // <obj>.occ или крупные треугольники Sponza, в пространстве модели
+    OcclusionBuffer mOcclusion;
+    bool mOcclusionCulling = true;            // O — вкл/выкл
+    std::vector<CameraPose> mCameraPath;      // C — запись пути камеры в kDefaultCameraPath
+    bool mRecordingPath = false;
+    BoundingFrustum mViewFrustumW;            // в мировых координатах, для маркеров
+    CullStats mCullStats;
+    DrawStats mDrawStats;
+    bool mInstancedStars = true;              // I — маркеры одним DrawIndexedInstanced или по вызову на свет
+    std::vector<GeometryInstance> mStarInstances;
+    std::wstring mBaseCaption;
     XMFLOAT3 mEyePosW = { 0.0f, 0.0f, 0.0f };
 
     static const UINT mGbufferRtvOffset = 0;
@@ -102,9 +205,16 @@ private:
 
     std::vector<std::unique_ptr<MyTexture>> mAllTextures;
     std::unique_ptr<MeshGeometry> mModelGeo = nullptr;
+    GeometryUploadQueue           mGeometryQueue;   // VB/IB mModelGeo, растут по мере импорта
+    std::vector<PackedVertex>     mPackedScratch;
 
-    std::vector<XMFLOAT3>    mCpuVertices;
+    WorldVertexCache         mPickVertices;   // мировые позиции Sponza (SoA); при потоковом импорте — прокси
     std::vector<uint32_t>    mCpuIndices;
+    BVH                      mSponzaBVH;      // над mPickVertices, refit при смене World
+    SubmeshTable             mSponzaSubmeshes; // id = индекс RenderItem
+    MeshletSet               mSponzaMeshlets;  // вершины — номера в VB mModelGeo
+    WorkerPool               mWorkers;
+    AsyncRaycaster           mRaycaster{ mWorkers, mSponzaBVH, &mSponzaSubmeshes };
     XMFLOAT4X4 mSponzaWorld = MathHelper::Identity4x4();
 
     XMFLOAT4X4 mWorld = MathHelper::Identity4x4();
@@ -114,6 +224,7 @@ private:
     float mTheta = 1.5f * XM_PI;
     float mPhi = XM_PIDIV4;
     float mRadius = 7.0f;
+    float mLodProjectionScale = 1.0f;   // LodProjectionScale для текущей высоты окна
     float mStarRotation = 0.0f;
     POINT mLastMousePos;
 
@@ -125,15 +236,18 @@ private:
         XMFLOAT3 Velocity;     
         XMFLOAT3 Color;
         float    Range;
-        float    TargetT;      
+        float    TargetT;      // FLT_MAX, пока не пришёл результат рейкаста
         float    CurrentT;     
         bool     IsFlying;     
+        int      Id;
     };
 
     std::vector<ShotLight> mShotLights;
     const float mLightSpeed = 150.0f;
     int mShotCount = 0;
-    bool mShootRequested = false;
+    int mNextShotId = 0;      // не сбрасывается по R, чтобы старый результат не попал в новый свет
+    uint32_t mShotsRequested = 0;   // копятся между кадрами, стреляются одной пачкой
+    static const uint32_t kVolleySize = 32;
     static const size_t mMaxShotLights = 48;
 };
 
@@ -157,6 +271,7 @@ BoxApp::BoxApp(HINSTANCE hInstance) : D3DApp(hInstance)
 {
     mLastMousePos.x = 0;
     mLastMousePos.y = 0;
+    mBaseCaption = mMainWndCaption;
 }
 
 BoxApp::~BoxApp() {}
@@ -164,15 +279,80 @@ BoxApp::~BoxApp() {}
 bool BoxApp::Initialize()
 {
     if (!D3DApp::Initialize()) return false;
+    StartupPhase total("total");
     ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
 
-    BuildDescriptorHeaps();
-    BuildModelGeometry();
+    // Модель берётся из бинарного пакета рядом с OBJ; текст разбирается, только если пакет устарел.
+    // Материалы идут в LoadTextures, геометрия — в BuildModelGeometry. Очень большие OBJ
+    // разбираются потоково: сабмеши уходят в GPU по мере разбора, пакет не пишется
+    mModelGeo = std::make_unique<MeshGeometry>();
+    mModelGeo->Name = "sponzaGeo";
+    UINT vertexStride = kVertexFormat == VertexFormat::Compressed ? sizeof(PackedVertex) : sizeof(Vertex);
+    mGeometryQueue.Init(md3dDevice.Get(), vertexStride, 1 << 20, 3 << 20);
 
-    ThrowIfFailed(mCommandList->Close());
-    ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
-    mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
-    FlushCommandQueue();
+    std::error_code sizeError;
+    std::uintmax_t objBytes = std::filesystem::file_size(kSponzaObjPath, sizeError);
+    std::uint64_t sponzaHash = 0;
+    if (!sizeError && objBytes >= kStreamImportMinBytes)
+    {
+        {
+            StartupPhase phase("sponza stream");
+            std::string objError;
+            if (!StreamModelGeometry(objError))
+            {
+                MessageBoxA(nullptr, objError.c_str(), "OBJ Load Error", MB_OK);
+                return false;
+            }
+        }
+        BuildDescriptorHeaps();
+        HashFile64(kSponzaObjPath, sponzaHash);
+    }
+    else
+    {
+        MeshPackage sponza;
+        {
+            StartupPhase phase("sponza mesh");
+            std::string objError;
+            double parseMs = 0.0;
+            MeshSource source = LoadOrImportMeshPackage(kSponzaObjPath, sponza, &parseMs, &objError, &mWorkers);
+            if (source == MeshSource::Failed)
+            {
+                MessageBoxA(nullptr, objError.c_str(), "OBJ Load Error", MB_OK);
+                return false;
+            }
+            phase.SetNote(source == MeshSource::Package ? "mapped package" :
+                "imported, parse " + std::to_string((int)parseMs) + " ms");
+        }
+
+        {
+            StartupPhase phase("textures");
+            LoadTextures(sponza.DiffuseTextures());
+        }
+        BuildDescriptorHeaps();
+        {
+            StartupPhase phase("geometry");
+            BuildModelGeometry(sponza);
+        }
+        {
+            // Сабмеши пакета лежат в VB с нуля и подряд, индексы пакета — сразу номера в VB
+            StartupPhase phase("meshlets");
+            for (size_t i = 0; i < sponza.Submeshes().size(); ++i)
+            {
+                const ImportedSubmesh& shape = sponza.Submeshes()[i];
+                mRenderItems[i].Meshlets = AppendMeshlets(mSponzaMeshlets, &sponza.Vertices()->Pos.x, sizeof(Vertex),
+                    sponza.Indices() + shape.FirstIndex, shape.IndexCount, 0);
+            }
+            phase.SetNote(std::to_string(mSponzaMeshlets.Meshlets.size()) + " meshlets");
+        }
+        LogWeldStats("sponza weld", sponza.Indices(), sponza.IndexCount(), sponza.VertexCount());
+        sponzaHash = sponza.SourceHash();
+    }
+    FinishModelGeometry(sponzaHash);
+
+    {
+        StartupPhase phase("gpu upload");
+        ExecuteUploads(false);
+    }
 
     BuildDepthSRV();
     return true;
@@ -199,16 +379,8 @@ void BoxApp::BuildDepthSRV()
     md3dDevice->CreateShaderResourceView(mDepthStencilBuffer.Get(), &srvDesc, cpuHandle);
 }
 
-void BoxApp::LoadTextures()
+void BoxApp::LoadTextures(const std::vector<std::string>& diffuseTextures)
 {
-    tinyobj::ObjReader       reader;
-    tinyobj::ObjReaderConfig config;
-    config.triangulate = false;
-
-    if (!reader.ParseFromFile("Sponza-master/sponza.obj", config))
-        return;
-
-    auto& materials = reader.GetMaterials();
     std::wstring texDir = L"Sponza-master/textures/";
 
     auto addTex = [&](const std::string& name) -> bool
@@ -247,13 +419,16 @@ void BoxApp::LoadTextures()
             return true;
         };
 
-    for (const auto& mat : materials)
-        addTex(mat.diffuse_texname);
+    for (const auto& texName : diffuseTextures)
+        addTex(texName);
 
     if (mAllTextures.empty())
         addTex("default");
 
+    // При потоковом импорте LoadTextures зовётся на каждой mtllib
     auto addTexDDS = [&](std::wstring path, std::string name) {
+        for (auto& t : mAllTextures)
+            if (t->Name == name) return;
         auto tex = std::make_unique<MyTexture>();
         tex->Name = name;
         tex->Filename = path;
@@ -270,8 +445,6 @@ void BoxApp::LoadTextures()
 
 void BoxApp::BuildDescriptorHeaps()
 {
-    LoadTextures();
-
     D3D12_DESCRIPTOR_HEAP_DESC rtvDesc = {};
     rtvDesc.NumDescriptors = GBuffer::NumRTs;
     rtvDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
@@ -295,7 +468,8 @@ void BoxApp::BuildDescriptorHeaps()
         mClientWidth, mClientHeight,
         mBackBufferFormat, mDepthStencilFormat,
         mGbufferRtvHeap.Get(), mSrvHeap.Get(),
-        mGbufferRtvOffset, mGbufferSrvOffset
+        mGbufferRtvOffset, mGbufferSrvOffset,
+        kVertexFormat
     );
 
     UINT srvSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -312,137 +486,210 @@ void BoxApp::BuildDescriptorHeaps()
     }
 }
 
-void BoxApp::BuildModelGeometry()
+void BoxApp::ExecuteUploads(bool reopen)
 {
-    tinyobj::ObjReader       reader;
-    tinyobj::ObjReaderConfig config;
-    config.triangulate = true; 
+    ThrowIfFailed(mCommandList->Close());
+    ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
+    mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+    FlushCommandQueue();
+    mGeometryQueue.Retire();
 
-    if (!reader.ParseFromFile("Sponza-master/sponza.obj", config))
+    if (reopen)
     {
-        MessageBoxA(nullptr, reader.Error().c_str(), "OBJ Load Error", MB_OK);
-        return;
+        ThrowIfFailed(mDirectCmdListAlloc->Reset());
+        ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
     }
+}
 
-    auto& attrib = reader.GetAttrib();
-    auto& shapes = reader.GetShapes();
-    auto& materials = reader.GetMaterials();
-
-    std::vector<Vertex>        allVertices;
-    std::vector<std::uint32_t> allIndices;
-
-    mModelGeo = std::make_unique<MeshGeometry>();
-    mModelGeo->Name = "sponzaGeo";
+void BoxApp::AddSponzaSubmesh(const ImportedSubmesh& shape, const std::vector<std::string>& diffuseTextures,
+    const SubmeshGeometry& submesh)
+{
+    mModelGeo->DrawArgs[shape.Name] = submesh;
 
-    for (const auto& shape : shapes)
+    int texIndex = 0;
+    if (shape.Material >= 0)
     {
-        UINT indexOffset = (UINT)allIndices.size();
-        UINT indexCount = 0;
-
-        int matId = -1;
-        if (!shape.mesh.material_ids.empty())
-            matId = shape.mesh.material_ids[0];
-
-        for (const auto& index : shape.mesh.indices)
-        {
-            Vertex v = {};
-            v.Pos = {
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2]
-            };
-            if (index.normal_index >= 0)
-                v.Normal = {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2]
-            };
-            else
-                v.Normal = { 0.0f, 1.0f, 0.0f };
-            if (index.texcoord_index >= 0)
-                v.TexC = {
-                    attrib.texcoords[2 * index.texcoord_index + 0],
-                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-            };
-            else
-                v.TexC = { 0.0f, 0.0f }; 
-            allVertices.push_back(v);
-            allIndices.push_back((std::uint32_t)(allVertices.size() - 1));
-            ++indexCount;
-        }
-
-        SubmeshGeometry submesh;
-        submesh.IndexCount = indexCount;
-        submesh.StartIndexLocation = indexOffset;
-        submesh.BaseVertexLocation = 0;
-        mModelGeo->DrawArgs[shape.name] = submesh;
-
-        int texIndex = 0;
-        if (matId >= 0 && matId < (int)materials.size())
+        const std::string& texName = diffuseTextures[shape.Material];
+        for (int i = 0; i < (int)mAllTextures.size(); ++i)
         {
-            const std::string& texName = materials[matId].diffuse_texname;
-            for (int i = 0; i < (int)mAllTextures.size(); ++i)
+            std::string loaded = mAllTextures[i]->Name;
+            if (loaded.find(texName) != std::string::npos ||
+                texName.find(loaded) != std::string::npos)
             {
-                std::string loaded = mAllTextures[i]->Name;
-                if (loaded.find(texName) != std::string::npos ||
-                    texName.find(loaded) != std::string::npos)
-                {
-                    texIndex = i;
-                    break;
-                }
+                texIndex = i;
+                break;
             }
         }
-
-        RenderItem ri;
-        ri.SubmeshName = shape.name;
-        ri.TexSrvIndex = texIndex;
-        ri.IsStar = false;
-        mRenderItems.push_back(ri);
     }
 
-    mCpuVertices.reserve(allVertices.size());
-    for (const auto& v : allVertices)
-        mCpuVertices.push_back(v.Pos);
-    mCpuIndices = allIndices;
+    RenderItem ri;
+    ri.SubmeshName = shape.Name;
+    ri.TexSrvIndex = texIndex;
+    ri.IsStar = false;
+    ri.LodNames = { shape.Name };
+    ri.LodErrors = { 0.0f };
+    mRenderItems.push_back(ri);
+}
 
-    // Загрузка звезды
-    {
-        tinyobj::ObjReader reader2;
-        tinyobj::ObjReaderConfig config2;
-        config2.triangulate = true;
-        reader2.ParseFromFile("models/source/725b3a4da0ef_Tiny_green_starw__3.obj", config2);
+// Треугольники последнего RenderItem для BVH и окклюдеров; indices - indexOffset — номера в positions.
+// Диапазон в mSponzaSubmeshes добавляется и пустым: по нему BVH находит RenderItem попадания
+void BoxApp::AddPickGeometry(const XMFLOAT3* positions, UINT vertexCount, UINT positionStride,
+    const std::uint32_t* indices, UINT indexCount, UINT indexOffset)
+{
+    RenderItem& ri = mRenderItems.back();
+    UINT firstVertex = (UINT)mPickVertices.VertexCount();
+    if (indexCount > 0)
+        ri.PickRange = (int)mPickVertices.AddRange(positions, vertexCount, positionStride);
+    mSponzaSubmeshes.Add((std::uint32_t)(mCpuIndices.size() / 3), indexCount / 3);
+    for (UINT i = 0; i < indexCount; ++i)
+        mCpuIndices.push_back(firstVertex + indices[i] - indexOffset);
+}
 
-        auto& attrib2 = reader2.GetAttrib();
-        auto& shapes2 = reader2.GetShapes();
+// LOD1.. последнего RenderItem: индексы от тех же вершин, что и LOD0, поэтому BaseVertexLocation общий
+void BoxApp::AddSubmeshLods(const SubmeshGeometry& lod0, const std::uint32_t* lodIndices, const MeshLod* lods,
+    std::uint32_t lodCount, UINT indexOffset)
+{
+    RenderItem& ri = mRenderItems.back();
+    for (std::uint32_t l = 0; l < lodCount; ++l)
+    {
+        SubmeshGeometry submesh = mGeometryQueue.AppendIndices(mCommandList.Get(),
+            lodIndices + lods[l].FirstIndex, lods[l].IndexCount, indexOffset, lod0.BaseVertexLocation);
+        submesh.Bounds = lod0.Bounds;
+        std::string name = ri.SubmeshName + "#lod" + std::to_string(l + 1);
+        mModelGeo->DrawArgs[name] = submesh;
+        ri.LodNames.push_back(name);
+        ri.LodErrors.push_back(lods[l].Error);
+    }
+}
 
-        UINT indexOffset = (UINT)allIndices.size();
-        UINT indexCount = 0;
+void BoxApp::BuildModelGeometry(const MeshPackage& sponza)
+{
+    // Сварка, сборка вершин и оптимизация порядка уже сделаны в ImportObjMesh:
+    // каждый shape — сабмеш с подряд лежащими вершинами, индексы пакета абсолютные.
+    // Вершины пакета уходят в GPU посабмешно (сжатие квантует их в AABB сабмеша);
+    // индексы сдвигаются к началу сабмеша, чтобы почти все сабмеши обошлись 16 битами.
+    // LOD из пакета идут в тот же IB и рисуются из тех же вершин
+    for (const ImportedSubmesh& shape : sponza.Submeshes())
+    {
+        BoundingBox bounds;
+        UINT baseVertex = AppendModelVertices(sponza.Vertices() + shape.FirstVertex, shape.VertexCount, bounds);
+        SubmeshGeometry submesh = mGeometryQueue.AppendIndices(mCommandList.Get(),
+            sponza.Indices() + shape.FirstIndex, shape.IndexCount, shape.FirstVertex, (INT)baseVertex);
+        submesh.Bounds = bounds;
+        AddSponzaSubmesh(shape, sponza.DiffuseTextures(), submesh);
+        AddPickGeometry(&sponza.Vertices()[shape.FirstVertex].Pos, shape.VertexCount, sizeof(Vertex),
+            sponza.Indices() + shape.FirstIndex, shape.IndexCount, shape.FirstVertex);
+        AddSubmeshLods(submesh, sponza.LodIndices(), sponza.Lods() + shape.FirstLod, shape.LodCount,
+            shape.FirstVertex);
+    }
+}
 
-        for (const auto& shape : shapes2)
+bool BoxApp::StreamModelGeometry(std::string& error)
+{
+    // Текстуры грузятся по mtllib, до первых граней; их SRV создаст BuildDescriptorHeaps.
+    // Индексы сабмеша локальные, сдвиг задаёт BaseVertexLocation. Пакета нет, поэтому цепочка LOD
+    // строится здесь же. Весь файл в памяти не остаётся: пикинг, BVH и окклюдеры получают только
+    // грубейший LOD сабмешей в пределах kStreamPickTriangles (см. ExtractCoarsestLod)
+    std::vector<std::string> diffuseTextures;
+    std::vector<std::uint32_t> lodIndices;
+    std::vector<MeshLod> lods;
+    std::vector<XMFLOAT3> proxyPositions;
+    std::vector<std::uint32_t> proxyIndices;
+    size_t skippedSubmeshes = 0;
+    ObjStreamStats stats;
+    bool ok = StreamObjMesh(kSponzaObjPath,
+        [&](const std::vector<std::string>& textures)
+        {
+            diffuseTextures = textures;
+            LoadTextures(diffuseTextures);
+        },
+        [&](const ImportedSubmesh& shape, const std::vector<Vertex>& vertices, const std::vector<std::uint32_t>& indices)
         {
-            for (const auto& index : shape.mesh.indices)
+            BoundingBox bounds;
+            UINT baseVertex = AppendModelVertices(vertices.data(), (UINT)vertices.size(), bounds);
+            SubmeshGeometry submesh = mGeometryQueue.AppendIndices(mCommandList.Get(),
+                indices.data(), (UINT)indices.size(), 0, (INT)baseVertex);
+            submesh.Bounds = bounds;
+            AddSponzaSubmesh(shape, diffuseTextures, submesh);
+            lodIndices.clear();
+            lods.clear();
+            std::uint32_t lodCount = BuildLodChain(indices.data(), indices.size(), &vertices.data()->Pos.x,
+                vertices.size(), sizeof(Vertex), lodIndices, lods);
+
+            ExtractCoarsestLod(vertices.data(), vertices.size(), indices.data(), indices.size(),
+                lodIndices.data(), lods.data(), lodCount, proxyPositions, proxyIndices);
+            if (mCpuIndices.size() / 3 + proxyIndices.size() / 3 > kStreamPickTriangles)
             {
-                Vertex v = {};
-                v.Pos = { attrib2.vertices[3 * index.vertex_index + 0],
-                          attrib2.vertices[3 * index.vertex_index + 1],
-                          attrib2.vertices[3 * index.vertex_index + 2] };
-                if (index.normal_index >= 0)
-                    v.Normal = { attrib2.normals[3 * index.normal_index + 0],
-                                 attrib2.normals[3 * index.normal_index + 1],
-                                 attrib2.normals[3 * index.normal_index + 2] };
-                if (index.texcoord_index >= 0)
-                    v.TexC = { attrib2.texcoords[2 * index.texcoord_index + 0],
-                               1.0f - attrib2.texcoords[2 * index.texcoord_index + 1] };
-                allVertices.push_back(v);
-                allIndices.push_back((UINT)(allVertices.size() - 1));
-                ++indexCount;
+                proxyIndices.clear();
+                ++skippedSubmeshes;
             }
-        }
+            AddPickGeometry(proxyPositions.data(), (UINT)proxyPositions.size(), sizeof(XMFLOAT3),
+                proxyIndices.data(), (UINT)proxyIndices.size(), 0);
+
+            AddSubmeshLods(submesh, lodIndices.data(), lods.data(), lodCount, 0);
+            mRenderItems.back().Meshlets = AppendMeshlets(mSponzaMeshlets, &vertices.data()->Pos.x, sizeof(Vertex),
+                indices.data(), indices.size(), baseVertex);
+
+            if (mGeometryQueue.PendingBytes() >= kStreamUploadBudget)
+                ExecuteUploads(true);
+        },
+        &error, &stats);
+    if (!ok) return false;
+
+    if (mAllTextures.empty())
+        LoadTextures({});
+
+    char line[256];
+    snprintf(line, sizeof(line), "[startup] %-18s %zu submeshes, resident %.1f MB attributes + %.1f MB largest submesh\n",
+        "sponza stream", stats.Submeshes, stats.AttributeBytes / 1048576.0, stats.PeakSubmeshBytes / 1048576.0);
+    OutputDebugStringA(line);
+    snprintf(line, sizeof(line), "[startup] %-18s %zu of %zu triangles, %.1f MB positions + %.1f MB indices, "
+        "%zu submeshes over budget\n",
+        "sponza pick proxy", mCpuIndices.size() / 3, stats.Indices / 3,
+        mPickVertices.VertexCount() * 6 * sizeof(float) / 1048576.0,
+        mCpuIndices.size() * sizeof(std::uint32_t) / 1048576.0, skippedSubmeshes);
+    OutputDebugStringA(line);
+    return true;
+}
 
-        SubmeshGeometry submesh;
-        submesh.IndexCount = indexCount;
-        submesh.StartIndexLocation = indexOffset;
-        submesh.BaseVertexLocation = 0;
+void BoxApp::FinishModelGeometry(std::uint64_t sponzaHash)
+{
+    // BVH строится по мировым позициям при единичной World — ровно то, что лежит в кэше
+    {
+        StartupPhase phase("sponza bvh");
+        BVHSource bvhSource = LoadOrBuildBVH(kSponzaObjPath, sponzaHash,
+            mPickVertices.WorldPositions(), mCpuIndices.data(), mCpuIndices.size(), mSponzaBVH);
+        phase.SetNote(std::string(bvhSource == BVHSource::Cache ? "mapped from cache, " : "built, ") +
+            std::to_string(mSponzaBVH.NodeCount()) + " nodes");
+    }
+    {
+        // Офлайн-окклюдер от occluder-build; без него — крупнейшие треугольники модели (или её прокси)
+        StartupPhase phase("sponza occluders");
+        bool offline = LoadOccluderMesh(OccluderMeshPath(kSponzaObjPath), sponzaHash, mOccluders);
+        if (!offline)
+            SelectOccluders(mPickVertices.LocalPositions(), mCpuIndices.data(), mCpuIndices.size() / 3,
+                kMaxOccluderTriangles, mOccluders);
+        phase.SetNote(std::string(offline ? "offline " : "runtime ") +
+            std::to_string(mOccluders.Indices.size() / 3) + " triangles");
+    }
+
+    // Звезда — один сабмеш из всех её shape; её VB идёт следом за VB Sponza,
+    // поэтому индексы остаются локальными, а сдвиг задаёт BaseVertexLocation
+    MeshPackage star;
+    {
+        StartupPhase phase("star mesh");
+        double parseMs = 0.0;
+        MeshSource source = LoadOrImportMeshPackage(kStarObjPath, star, &parseMs, nullptr, &mWorkers);
+        phase.SetNote(source == MeshSource::Package ? "mapped package" :
+            "imported, parse " + std::to_string((int)parseMs) + " ms");
+    }
+    LogWeldStats("star weld", star.Indices(), star.IndexCount(), star.VertexCount());
+    {
+        BoundingBox bounds;
+        UINT baseVertex = AppendModelVertices(star.Vertices(), (UINT)star.VertexCount(), bounds);
+        SubmeshGeometry submesh = mGeometryQueue.AppendIndices(mCommandList.Get(),
+            star.Indices(), (UINT)star.IndexCount(), 0, (INT)baseVertex);
+        submesh.Bounds = bounds;
         mModelGeo->DrawArgs["star"] = submesh;
 
         int texIndex = 0;
@@ -456,28 +703,52 @@ void BoxApp::BuildModelGeometry()
         mRenderItems.push_back(ri);
     }
 
-    const UINT vbSize = (UINT)allVertices.size() * sizeof(Vertex);
-    const UINT ibSize = (UINT)allIndices.size() * sizeof(std::uint32_t);
+    mGeometryQueue.Finish(mCommandList.Get(), *mModelGeo);
 
-    ThrowIfFailed(D3DCreateBlob(vbSize, &mModelGeo->VertexBufferCPU));
-    CopyMemory(mModelGeo->VertexBufferCPU->GetBufferPointer(), allVertices.data(), vbSize);
-    ThrowIfFailed(D3DCreateBlob(ibSize, &mModelGeo->IndexBufferCPU));
-    CopyMemory(mModelGeo->IndexBufferCPU->GetBufferPointer(), allIndices.data(), ibSize);
+    size_t lodLevels = 0, lodSubmeshes = 0, lod0IndexCount = 0, lodIndexCount = 0;
+    for (const auto& ri : mRenderItems)
+    {
+        if (!ri.LodNames.empty()) lod0IndexCount += mModelGeo->DrawArgs[ri.LodNames[0]].IndexCount;
+        lodSubmeshes += ri.LodNames.size() > 1;
+        for (size_t l = 1; l < ri.LodNames.size(); ++l, ++lodLevels)
+            lodIndexCount += mModelGeo->DrawArgs[ri.LodNames[l]].IndexCount;
+    }
 
-    mModelGeo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(
-        md3dDevice.Get(), mCommandList.Get(),
-        allVertices.data(), vbSize, mModelGeo->VertexBufferUploader);
-    mModelGeo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(
-        md3dDevice.Get(), mCommandList.Get(),
-        allIndices.data(), ibSize, mModelGeo->IndexBufferUploader);
+    char line[256];
+    snprintf(line, sizeof(line), "[startup] %-18s %u submeshes 16-bit, %u 32-bit, %.2f MB (all 32-bit: %.2f MB)\n",
+        "index buffers", mGeometryQueue.NarrowSubmeshCount(), mGeometryQueue.WideSubmeshCount(),
+        mGeometryQueue.IndexBytes() / 1048576.0,
+        (lod0IndexCount + lodIndexCount + star.IndexCount()) * sizeof(std::uint32_t) / 1048576.0);
+    OutputDebugStringA(line);
+    snprintf(line, sizeof(line), "[startup] %-18s %zu levels over %zu submeshes, +%.0f%% indices\n",
+        "sponza lods", lodLevels, lodSubmeshes, lod0IndexCount == 0 ? 0.0 : 100.0 * lodIndexCount / lod0IndexCount);
+    OutputDebugStringA(line);
+    snprintf(line, sizeof(line), "[startup] %-18s %u vertices, %.2f MB (%s, %u bytes each)\n",
+        "vertex buffer", mGeometryQueue.VertexCount(), mModelGeo->VertexBufferByteSize / 1048576.0,
+        kVertexFormat == VertexFormat::Compressed ? "compressed" : "full", mModelGeo->VertexByteStride);
+    OutputDebugStringA(line);
+
+    MeshletStats meshlets = AnalyzeMeshlets(mSponzaMeshlets);
+    snprintf(line, sizeof(line), "[startup] %-18s %zu, fill %.0f%% verts / %.0f%% tris, %zu open cones\n",
+        "sponza meshlets", meshlets.Meshlets, meshlets.VertexFill * 100.0f, meshlets.TriangleFill * 100.0f,
+        meshlets.OpenCones);
+    OutputDebugStringA(line);
+}
 
-    mModelGeo->VertexByteStride = sizeof(Vertex);
-    mModelGeo->VertexBufferByteSize = vbSize;
-    mModelGeo->IndexFormat = DXGI_FORMAT_R32_UINT;
-    mModelGeo->IndexBufferByteSize = ibSize;
+// Вершины одного сабмеша; bounds — их AABB, в нём же квантуются позиции в режиме Compressed
+UINT BoxApp::AppendModelVertices(const Vertex* vertices, UINT count, BoundingBox& bounds)
+{
+    PositionBounds box = ComputePositionBounds(vertices, count);
+    bounds.Center = box.Center;
+    bounds.Extents = box.Extents;
+    if (kVertexFormat == VertexFormat::Full)
+        return mGeometryQueue.AppendVertices(mCommandList.Get(), vertices, count);
+
+    PackVertices(vertices, count, box, mPackedScratch);
+    return mGeometryQueue.AppendVertices(mCommandList.Get(), mPackedScratch.data(), count);
 }
 
-void BoxApp::ShootLightFromCamera()
+void BoxApp::ShootLightsFromCamera(uint32_t count)
 {
     XMVECTOR eye = XMLoadFloat3(&mEyePosW);
     XMVECTOR dir = XMVector3Normalize(XMVectorNegate(eye));
@@ -485,49 +756,63 @@ void BoxApp::ShootLightFromCamera()
     const float kStartOffset = 0.12f;
     XMVECTOR rayOrigin = eye + dir * kStartOffset;
 
-    XMMATRIX world = XMLoadFloat4x4(&mSponzaWorld);
-
-    float tMin = FLT_MAX;
-    bool hit = false;
     const float kMinHitDistance = 0.001f; 
+    const float kVolleySpread = 0.15f;
 
-    //CPU Raycast 
-    uint32_t triCount = (uint32_t)mCpuIndices.size() / 3;
-    for (uint32_t i = 0; i < triCount; ++i)
-    {
-        XMVECTOR v0 = XMVector3Transform(XMLoadFloat3(&mCpuVertices[mCpuIndices[3 * i + 0]]), world);
-        XMVECTOR v1 = XMVector3Transform(XMLoadFloat3(&mCpuVertices[mCpuIndices[3 * i + 1]]), world);
-        XMVECTOR v2 = XMVector3Transform(XMLoadFloat3(&mCpuVertices[mCpuIndices[3 * i + 2]]), world);
-
-        float t = 0.0f;
-        if (RayTriangleIntersect(rayOrigin, dir, v0, v1, v2, t) && t > kMinHitDistance)
-        {
-            if (t < tMin) { tMin = t; hit = true; }
-        }
-    }
-
-    if (!hit) tMin = 60.0f; 
-
-    ShotLight sl;
-    XMStoreFloat3(&sl.Origin, rayOrigin);
-    XMStoreFloat3(&sl.Direction, dir);
-    XMStoreFloat3(&sl.Position, rayOrigin);
-    XMStoreFloat3(&sl.Velocity, dir * mLightSpeed);
+    // Базис для разброса залпа вокруг направления взгляда
+    XMVECTOR right = XMVector3Normalize(XMVector3Cross(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), dir));
+    XMVECTOR up = XMVector3Cross(dir, right);
 
     static const XMFLOAT3 palette[] = {
         { 1.0f, 0.4f, 0.1f }, { 0.2f, 0.6f, 1.0f }, { 0.4f, 1.0f, 0.4f },
         { 1.0f, 0.2f, 0.8f }, { 1.0f, 1.0f, 0.3f }, { 0.5f, 0.2f, 1.0f }
     };
-    sl.Color = palette[mShotCount % 6];
-    sl.Range = 10.0f;    
-    sl.TargetT = tMin;   
-    sl.CurrentT = 0.0f;
-    sl.IsFlying = true;
 
-    mShotLights.push_back(sl);
+    std::vector<RayQuery> rays(count);
+    int firstId = mNextShotId;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        // Первый луч — строго в центр, остальные с разбросом
+        XMVECTOR d = dir;
+        if (i > 0)
+            d = XMVector3Normalize(dir +
+                right * MathHelper::RandF(-kVolleySpread, kVolleySpread) +
+                up * MathHelper::RandF(-kVolleySpread, kVolleySpread));
+
+        ShotLight sl;
+        XMStoreFloat3(&sl.Origin, rayOrigin);
+        XMStoreFloat3(&sl.Direction, d);
+        XMStoreFloat3(&sl.Position, rayOrigin);
+        XMStoreFloat3(&sl.Velocity, d * mLightSpeed);
+        sl.Color = palette[mShotCount % 6];
+        sl.Range = 10.0f;    
+        sl.TargetT = FLT_MAX;
+        sl.CurrentT = 0.0f;
+        sl.IsFlying = true;
+        sl.Id = mNextShotId++;
+
+        rays[i].Origin = sl.Origin;
+        rays[i].Dir = sl.Direction;
+        rays[i].TMin = kMinHitDistance;
+        rays[i].TMax = FLT_MAX;
+
+        mShotLights.push_back(sl);
+        mShotCount++;
+    }
     if (mShotLights.size() > mMaxShotLights)
-        mShotLights.erase(mShotLights.begin());
-    mShotCount++;
+        mShotLights.erase(mShotLights.begin(), mShotLights.end() - mMaxShotLights);
+
+    // Свет вылетает сразу, точки попадания подставит колбэк из Update.
+    // Свет к тому моменту мог быть вытеснен или сброшен по R — тогда результат просто теряется.
+    mRaycaster.QueryBatch(std::move(rays), [this, firstId](const std::vector<RayQuery>&,
+        const std::vector<RayQueryHit>& hits) {
+        for (auto& shot : mShotLights)
+        {
+            int i = shot.Id - firstId;
+            if (i < 0 || i >= (int)hits.size()) continue;
+            shot.TargetT = hits[i].IsHit() ? hits[i].T : 60.0f;
+        }
+    });
 }
 
 LRESULT BoxApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
@@ -535,12 +820,32 @@ LRESULT BoxApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     if (msg == WM_KEYDOWN)
     {
         if (wParam == VK_SPACE && ((lParam & 0x40000000) == 0))
-            mShootRequested = true;
+            ++mShotsRequested;
+        if (wParam == 'V' && ((lParam & 0x40000000) == 0))
+            mShotsRequested += kVolleySize;
         if (wParam == 'R')
         {
             mShotLights.clear();
             mShotCount = 0;
         }
+        if (wParam == 'O' && ((lParam & 0x40000000) == 0))
+            mOcclusionCulling = !mOcclusionCulling;
+        if (wParam == 'I' && ((lParam & 0x40000000) == 0))
+            mInstancedStars = !mInstancedStars;
+        if (wParam == 'C' && ((lParam & 0x40000000) == 0))
+        {
+            // Повторное нажатие пишет путь для BoxTools occlusion-bench
+            if (mRecordingPath)
+            {
+                bool saved = SaveCameraPath(kDefaultCameraPath, mCameraPath);
+                char line[256];
+                snprintf(line, sizeof(line), "[camera] %zu poses %s %s\n", mCameraPath.size(),
+                    saved ? "written to" : "FAILED to write", kDefaultCameraPath);
+                OutputDebugStringA(line);
+            }
+            mCameraPath.clear();
+            mRecordingPath = !mRecordingPath;
+        }
     }
     return D3DApp::MsgProc(hwnd, msg, wParam, lParam);
 }
@@ -551,6 +856,8 @@ void BoxApp::Update(const GameTimer& gt)
     float z = mRadius * sinf(mPhi) * sinf(mTheta);
     float y = mRadius * cosf(mPhi);
     mEyePosW = { x, y, z };
+    if (mRecordingPath)
+        mCameraPath.push_back({ mEyePosW, { 0.0f, 0.0f, 0.0f } });
 
     XMVECTOR pos = XMVectorSet(x, y, z, 1.0f);
     XMVECTOR target = XMVectorZero();
@@ -562,12 +869,27 @@ void BoxApp::Update(const GameTimer& gt)
     XMStoreFloat4x4(&mWorld, sponzaWorld);
     mSponzaWorld = mWorld; 
 
-    if (mShootRequested)
+    // Кэш пересчитывается только если матрица реально поменялась
+    for (auto& ri : mRenderItems)
+    {
+        if (ri.PickRange < 0) continue;
+        ri.World = mSponzaWorld;
+        mPickVertices.SetWorld((uint32_t)ri.PickRange, ri.World);
+    }
+    if (mPickVertices.Update())
     {
-        ShootLightFromCamera();
-        mShootRequested = false;
+        // Воркеры читают BVH — дожидаемся их перед refit
+        mRaycaster.WaitIdle();
+        mSponzaBVH.Refit(mPickVertices.WorldPositions(), mCpuIndices.data(), mCpuIndices.size());
     }
 
+    if (mShotsRequested > 0)
+    {
+        ShootLightsFromCamera(mShotsRequested);
+        mShotsRequested = 0;
+    }
+    mRaycaster.DispatchCompleted();
+
     // 2. Обновляем полет света
     const float kMarkerRadius = 50.8f;   
     const float kSurfaceBias = 0.03f;    
@@ -600,6 +922,77 @@ void BoxApp::Update(const GameTimer& gt)
     }
 }
 
+// Сабмеши Sponza против frustum камеры и буфера окклюзии; у прошедших сразу выбирается LOD. Проверка идёт
+// в пространстве модели: там лежат Bounds и окклюдеры, а ошибка LOD с расстоянием масштабируются World одинаково
+void BoxApp::CullRenderItems(FXMMATRIX world, CXMMATRIX view, CXMMATRIX proj)
+{
+    BoundingFrustum frustumV;
+    BoundingFrustum::CreateFromMatrix(frustumV, proj);
+    frustumV.Transform(mViewFrustumW, XMMatrixInverse(nullptr, view));
+    XMVECTOR eyeL = XMVector3TransformCoord(XMLoadFloat3(&mEyePosW), XMMatrixInverse(nullptr, world));
+
+    // Элементы только добавляются (стриминг), поэтому хватает досчитать хвост
+    size_t known = mItemBounds.Count();
+    if (known != mRenderItems.size())
+    {
+        AabbStream grown;
+        grown.Resize(mRenderItems.size());
+        AabbSoA old = mItemBounds.View();
+        for (size_t i = 0; i < mRenderItems.size(); ++i)
+        {
+            if (i < known)
+            {
+                grown.Set(i, { old.Center[0][i], old.Center[1][i], old.Center[2][i] },
+                    { old.Extents[0][i], old.Extents[1][i], old.Extents[2][i] });
+                continue;
+            }
+            const BoundingBox& b = mModelGeo->DrawArgs[mRenderItems[i].SubmeshName].Bounds;
+            grown.Set(i, b.Center, b.Extents);
+        }
+        mItemBounds = std::move(grown);
+    }
+
+    // Плоскости из World * View * Proj — сразу в пространстве модели, как и Bounds
+    FrustumPlanes frustumL = ExtractFrustumPlanes(world * view * proj);
+    mVisibleScratch.resize(mItemBounds.Count());
+    size_t visibleCount = CullAabbs(mItemBounds.View(), 0, mItemBounds.Count(), frustumL, mVisibleScratch.data());
+
+    // Окклюдеры в том же пространстве модели; буфер 256x128 строится заново каждый кадр
+    bool occlusion = mOcclusionCulling && !mOccluders.Indices.empty();
+    if (occlusion)
+    {
+        mOcclusion.Begin(world * view * proj);
+        mOcclusion.RenderOccluders(mOccluders);
+        mOcclusion.Finish();
+    }
+
+    mVisibleItems.clear();
+    mCullStats = CullStats();
+    for (size_t v = 0; v < visibleCount; ++v)
+    {
+        UINT i = mVisibleScratch[v];
+        const RenderItem& ri = mRenderItems[i];
+        if (ri.IsStar) continue;
+        const SubmeshGeometry& lod0 = mModelGeo->DrawArgs[ri.SubmeshName];
+        if (occlusion && mOcclusion.IsOccluded(lod0.Bounds.Center, lod0.Bounds.Extents))
+        {
+            ++mCullStats.Occluded;
+            continue;
+        }
+
+        std::uint32_t lod = 0;
+        if (ri.LodErrors.size() > 1)
+            lod = SelectLod(ri.LodErrors.data(), (std::uint32_t)ri.LodErrors.size(),
+                DistanceToBox(lod0.Bounds, eyeL), mLodProjectionScale, kLodPixelError);
+        mVisibleItems.push_back({ i, lod });
+        ++mCullStats.Visible;
+        mCullStats.Triangles += mModelGeo->DrawArgs[ri.LodNames[lod]].IndexCount / 3;
+    }
+    for (const RenderItem& ri : mRenderItems)
+        mCullStats.Culled += !ri.IsStar;
+    mCullStats.Culled -= mCullStats.Visible + mCullStats.Occluded;
+}
+
 void BoxApp::Draw(const GameTimer& gt)
 {
     ThrowIfFailed(mDirectCmdListAlloc->Reset());
@@ -639,24 +1032,58 @@ void BoxApp::Draw(const GameTimer& gt)
         D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
     mCommandList->IASetVertexBuffers(0, 1, &mModelGeo->VertexBufferView());
-    mCommandList->IASetIndexBuffer(&mModelGeo->IndexBufferView());
+    // Сабмеши лежат в R16 или R32 IB; буфер меняется, только когда формат другой.
+    // Сжатым позициям нужен ещё AABB сабмеша
+    DXGI_FORMAT boundIndexFormat = DXGI_FORMAT_UNKNOWN;
+    auto bindSubmesh = [&](const SubmeshGeometry& sub)
+        {
+            if (kVertexFormat == VertexFormat::Compressed)
+                mRenderingSystem.SetPositionBounds(mCommandList.Get(), sub.Bounds);
+            if (sub.IndexFormat == boundIndexFormat) return;
+            mCommandList->IASetIndexBuffer(&mModelGeo->IndexBufferView(sub));
+            boundIndexFormat = sub.IndexFormat;
+        };
     mCommandList->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
+    CullRenderItems(world, view, proj);
+
+    mDrawStats = DrawStats();
     UINT geomCbIndex = 0;
     mRenderingSystem.SetGeometryPassConstants(mCommandList.Get(), geomConsts, geomCbIndex++);
-    for (const auto& ri : mRenderItems)
+    for (const VisibleItem& visible : mVisibleItems)
     {
-        if (ri.IsStar) continue;
+        const RenderItem& ri = mRenderItems[visible.Item];
         CD3DX12_GPU_DESCRIPTOR_HANDLE texHandle(
             mObjectSrvHeap->GetGPUDescriptorHandleForHeapStart());
         texHandle.Offset(ri.TexSrvIndex, srvSize);
         mCommandList->SetGraphicsRootDescriptorTable(1, texHandle);
-        const auto& sub = mModelGeo->DrawArgs[ri.SubmeshName];
+        const auto& sub = mModelGeo->DrawArgs[ri.LodNames[visible.Lod]];
+        bindSubmesh(sub);
         mCommandList->DrawIndexedInstanced(
             sub.IndexCount, 1, sub.StartIndexLocation, sub.BaseVertexLocation, 0);
+        ++mDrawStats.DrawCalls;
     }
 
     //маркер полёта
+    auto drawStars = [&](UINT instanceCount)
+        {
+            for (const auto& ri : mRenderItems)
+            {
+                if (!ri.IsStar) continue;
+                CD3DX12_GPU_DESCRIPTOR_HANDLE texHandle(
+                    mObjectSrvHeap->GetGPUDescriptorHandleForHeapStart());
+                texHandle.Offset(ri.TexSrvIndex, srvSize);
+                mCommandList->SetGraphicsRootDescriptorTable(1, texHandle);
+                const auto& sub = mModelGeo->DrawArgs[ri.SubmeshName];
+                bindSubmesh(sub);
+                mCommandList->DrawIndexedInstanced(
+                    sub.IndexCount, instanceCount, sub.StartIndexLocation, sub.BaseVertexLocation, 0);
+                ++mDrawStats.DrawCalls;
+            }
+        };
+
+    const SubmeshGeometry& starSub = mModelGeo->DrawArgs["star"];
+    mStarInstances.clear();
     for (const auto& sl : mShotLights)
     {
         XMMATRIX shotWorld =
@@ -664,33 +1091,63 @@ void BoxApp::Draw(const GameTimer& gt)
             XMMatrixRotationY(gt.TotalTime() * 2.0f) *
             XMMatrixTranslation(sl.Position.x, sl.Position.y, sl.Position.z);
 
+        BoundingBox shotBounds;
+        starSub.Bounds.Transform(shotBounds, shotWorld);
+        if (!mViewFrustumW.Intersects(shotBounds))
+        {
+            ++mCullStats.Culled;
+            continue;
+        }
+        ++mCullStats.Visible;
+        mCullStats.Triangles += starSub.IndexCount / 3;
+
+        XMMATRIX shotWit = XMMatrixTranspose(XMMatrixInverse(nullptr, shotWorld));
+        if (mInstancedStars)
+        {
+            GeometryInstance instance;
+            XMStoreFloat4x4(&instance.World, XMMatrixTranspose(shotWorld));
+            XMStoreFloat4x4(&instance.WorldInvTranspose, XMMatrixTranspose(shotWit));
+            mStarInstances.push_back(instance);
+            continue;
+        }
+
         GeometryPassConstants shotConsts;
         XMStoreFloat4x4(&shotConsts.WorldViewProj,
             XMMatrixTranspose(shotWorld * view * proj));
         XMStoreFloat4x4(&shotConsts.World,
             XMMatrixTranspose(shotWorld));
-        XMMATRIX shotWit = XMMatrixTranspose(XMMatrixInverse(nullptr, shotWorld));
         XMStoreFloat4x4(&shotConsts.WorldInvTranspose,
             XMMatrixTranspose(shotWit));
         shotConsts.Time = gt.TotalTime();
 
         mRenderingSystem.SetGeometryPassConstants(mCommandList.Get(), shotConsts, geomCbIndex++);
+        drawStars(1);
+    }
 
-        for (const auto& ri : mRenderItems)
-        {
-            if (!ri.IsStar) continue;
-            CD3DX12_GPU_DESCRIPTOR_HANDLE texHandle(
-                mObjectSrvHeap->GetGPUDescriptorHandleForHeapStart());
-            texHandle.Offset(ri.TexSrvIndex, srvSize);
-            mCommandList->SetGraphicsRootDescriptorTable(1, texHandle);
-            const auto& sub = mModelGeo->DrawArgs[ri.SubmeshName];
-            mCommandList->DrawIndexedInstanced(
-                sub.IndexCount, 1, sub.StartIndexLocation, sub.BaseVertexLocation, 0);
-        }
+    // Все видимые маркеры — один CB с ViewProj и по вызову на сабмеш звезды
+    if (!mStarInstances.empty())
+    {
+        GeometryPassConstants starConsts;
+        XMStoreFloat4x4(&starConsts.WorldViewProj, XMMatrixTranspose(view * proj));
+        starConsts.Time = gt.TotalTime();
+        mRenderingSystem.SetGeometryPassConstants(mCommandList.Get(), starConsts, geomCbIndex++);
+        mDrawStats.Instances = mRenderingSystem.SetGeometryInstances(
+            mCommandList.Get(), mStarInstances.data(), (UINT)mStarInstances.size());
+        drawStars(mDrawStats.Instances);
     }
+    mDrawStats.GeometryCBs = geomCbIndex;
 
     mRenderingSystem.EndGeometryPass(mCommandList.Get());
 
+    // Счётчики кадра — в заголовок окна рядом с fps (см. D3DApp::CalculateFrameStats)
+    mMainWndCaption = mBaseCaption + L"    drawn: " + std::to_wstring(mCullStats.Visible) +
+        L"  culled: " + std::to_wstring(mCullStats.Culled) + L"  occluded: " + std::to_wstring(mCullStats.Occluded) +
+        L"  tris: " + std::to_wstring(mCullStats.Triangles) +
+        L"  draws: " + std::to_wstring(mDrawStats.DrawCalls) + L"  cbs: " + std::to_wstring(mDrawStats.GeometryCBs) +
+        L"/" + std::to_wstring(mRenderingSystem.GetMaxGeometryCBs()) +
+        (mInstancedStars ? L"  stars x" + std::to_wstring(mDrawStats.Instances) : L"") +
+        (mRecordingPath ? L"  [rec]" : L"");
+
     mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
         mDepthStencilBuffer.Get(),
         D3D12_RESOURCE_STATE_DEPTH_WRITE,
@@ -780,7 +1237,8 @@ void BoxApp::OnResize()
 {
     D3DApp::OnResize();
     XMStoreFloat4x4(&mProj,
-        XMMatrixPerspectiveFovLH(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 5000.0f));
+        XMMatrixPerspectiveFovLH(kFovY, AspectRatio(), 1.0f, 5000.0f));
+    mLodProjectionScale = LodProjectionScale(kFovY, (float)mClientHeight);
 
     if (mGbufferRtvHeap == nullptr) return;
     mRenderingSystem.OnResize(
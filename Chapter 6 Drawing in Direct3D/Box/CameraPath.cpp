@@ -0,0 +1,68 @@
+#include "CameraPath.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace DirectX;
+
+bool SaveCameraPath(const std::string& path, const std::vector<CameraPose>& poses)
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    out.precision(9);
+    out << "# eye.xyz target.xyz\n";
+    for (const CameraPose& p : poses)
+        out << p.Eye.x << ' ' << p.Eye.y << ' ' << p.Eye.z << ' '
+            << p.Target.x << ' ' << p.Target.y << ' ' << p.Target.z << '\n';
+    return (bool)out;
+}
+
+bool LoadCameraPath(const std::string& path, std::vector<CameraPose>& poses, std::string* error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        if (error) *error = "cannot open file";
+        return false;
+    }
+
+    poses.clear();
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number)
+    {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+
+        std::istringstream in(line);
+        CameraPose p;
+        if (!(in >> p.Eye.x >> p.Eye.y >> p.Eye.z >> p.Target.x >> p.Target.y >> p.Target.z))
+        {
+            if (error) *error = "bad pose at line " + std::to_string(number);
+            return false;
+        }
+        poses.push_back(p);
+    }
+    return true;
+}
+
+XMMATRIX CameraPoseView(const CameraPose& pose)
+{
+    return XMMatrixLookAtLH(XMLoadFloat3(&pose.Eye), XMLoadFloat3(&pose.Target), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+}
+
+std::vector<CameraPose> MakeWalkPath(const XMFLOAT3& lo, const XMFLOAT3& hi, int count)
+{
+    XMFLOAT3 c = { (lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f, (lo.z + hi.z) * 0.5f };
+    XMFLOAT3 e = { (hi.x - lo.x) * 0.5f, (hi.y - lo.y) * 0.5f, (hi.z - lo.z) * 0.5f };
+    std::vector<CameraPose> poses;
+    for (int i = 0; i < count; ++i)
+    {
+        float a = 2.0f * XM_PI * (float)i / (float)count;
+        CameraPose p;
+        p.Eye = { c.x + std::cos(a) * e.x * 0.7f, lo.y + e.y * 0.3f, c.z + std::sin(a) * e.z * 0.7f };
+        float yaw = a + XM_PIDIV2 + (i & 1 ? 0.6f : 0.3f);
+        p.Target = { p.Eye.x + std::cos(yaw), p.Eye.y, p.Eye.z + std::sin(yaw) };
+        poses.push_back(p);
+    }
+    return poses;
+}
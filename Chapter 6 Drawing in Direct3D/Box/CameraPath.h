@@ -0,0 +1,26 @@
+#pragma once
+#include <DirectXMath.h>
+#include <string>
+#include <vector>
+
+// Записанный путь камеры для повторяемых замеров без окна (BoxApp пишет его по клавише C).
+// Текстовый файл, поза на строку: "eye.x eye.y eye.z target.x target.y target.z";
+// пустые строки и строки с # пропускаются. Up всегда +Y, как в BoxApp::Update.
+static const char kDefaultCameraPath[] = "camera_path.txt";
+
+struct CameraPose
+{
+    DirectX::XMFLOAT3 Eye;
+    DirectX::XMFLOAT3 Target;
+};
+
+bool SaveCameraPath(const std::string& path, const std::vector<CameraPose>& poses);
+
+// false, если файла нет или строка не разбирается; error — номер строки.
+bool LoadCameraPath(const std::string& path, std::vector<CameraPose>& poses, std::string* error = nullptr);
+
+DirectX::XMMATRIX CameraPoseView(const CameraPose& pose);
+
+// Путь для замеров без записанного: облёт внутри AABB сцены на высоте человека, взгляд по касательной
+// с поворотом к центру.
+std::vector<CameraPose> MakeWalkPath(const DirectX::XMFLOAT3& lo, const DirectX::XMFLOAT3& hi, int count);
@@ -152,6 +152,9 @@ struct SubmeshGeometry
 	UINT StartIndexLocation = 0;
 	INT BaseVertexLocation = 0;
 
+	// Which of the MeshGeometry index buffers holds this range (see IndexBufferView(submesh)).
+	DXGI_FORMAT IndexFormat = DXGI_FORMAT_R16_UINT;
+
     // Bounding box of the geometry defined by this submesh. 
     // This is used in later chapters of the book.
 	DirectX::BoundingBox Bounds;
@@ -181,6 +184,11 @@ struct MeshGeometry
 	DXGI_FORMAT IndexFormat = DXGI_FORMAT_R16_UINT;
 	UINT IndexBufferByteSize = 0;
 
+	// Optional R32 index buffer for submeshes that do not fit 16-bit indices
+	// when IndexFormat is R16.
+	Microsoft::WRL::ComPtr<ID3D12Resource> WideIndexBufferGPU = nullptr;
+	UINT WideIndexBufferByteSize = 0;
+
 	// A MeshGeometry may store multiple geometries in one vertex/index buffer.
 	// Use this container to define the Submesh geometries so we can draw
 	// the Submeshes individually.
@@ -206,6 +214,19 @@ struct MeshGeometry
 		return ibv;
 	}
 
+	D3D12_INDEX_BUFFER_VIEW IndexBufferView(const SubmeshGeometry& submesh)const
+	{
+		if (submesh.IndexFormat == IndexFormat || WideIndexBufferGPU == nullptr)
+			return IndexBufferView();
+
+		D3D12_INDEX_BUFFER_VIEW ibv;
+		ibv.BufferLocation = WideIndexBufferGPU->GetGPUVirtualAddress();
+		ibv.Format = DXGI_FORMAT_R32_UINT;
+		ibv.SizeInBytes = WideIndexBufferByteSize;
+
+		return ibv;
+	}
+
 	// We can free this memory after we finish upload to the GPU.
 	void DisposeUploaders()
 	{
@@ -0,0 +1,260 @@
+#include "FrustumCull.h"
+#include "SimdDispatch.h"
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+using namespace DirectX;
+
+namespace
+{
+    // Для каждой 8-битной маски — номера установленных линий по байту, младшие первыми.
+    struct CompactTable
+    {
+        uint64_t Lanes[256];
+
+        constexpr CompactTable() : Lanes()
+        {
+            for (int mask = 0; mask < 256; ++mask)
+            {
+                uint64_t lanes = 0;
+                int k = 0;
+                for (int l = 0; l < 8; ++l)
+                    if (mask & (1 << l))
+                        lanes |= (uint64_t)l << (8 * k++);
+                Lanes[mask] = lanes;
+            }
+        }
+    };
+
+    constexpr CompactTable kCompact;
+
+    // Модули нормалей — для проекции полуразмеров на нормаль
+    void AbsPlanes(const FrustumPlanes& frustum, float abs[6][3])
+    {
+        for (int p = 0; p < 6; ++p)
+        {
+            abs[p][0] = std::fabs(frustum.Planes[p].x);
+            abs[p][1] = std::fabs(frustum.Planes[p].y);
+            abs[p][2] = std::fabs(frustum.Planes[p].z);
+        }
+    }
+}
+
+FrustumPlanes ExtractFrustumPlanes(FXMMATRIX viewProj)
+{
+    XMFLOAT4X4 m;
+    XMStoreFloat4x4(&m, viewProj);
+    auto column = [&](int j) { return XMVectorSet(m.m[0][j], m.m[1][j], m.m[2][j], m.m[3][j]); };
+    XMVECTOR c0 = column(0), c1 = column(1), c2 = column(2), c3 = column(3);
+    XMVECTOR planes[6] = { c3 + c0, c3 - c0, c3 + c1, c3 - c1, c2, c3 - c2 };
+
+    FrustumPlanes frustum;
+    for (int p = 0; p < 6; ++p)
+    {
+        float len = XMVectorGetX(XMVector3Length(planes[p]));
+        XMStoreFloat4(&frustum.Planes[p], len > 0.0f ? planes[p] / len : planes[p]);
+    }
+    return frustum;
+}
+
+void AabbStream::Resize(size_t count)
+{
+    mCount = count;
+    for (auto& d : mData)
+        d.assign(count + 8, 0.0f);
+}
+
+void AabbStream::Set(size_t index, const XMFLOAT3& center, const XMFLOAT3& extents)
+{
+    mData[0][index] = center.x;
+    mData[1][index] = center.y;
+    mData[2][index] = center.z;
+    mData[3][index] = extents.x;
+    mData[4][index] = extents.y;
+    mData[5][index] = extents.z;
+}
+
+void AabbStream::Clear()
+{
+    for (auto& d : mData)
+    {
+        d.clear();
+        d.shrink_to_fit();
+    }
+    mCount = 0;
+}
+
+AabbSoA AabbStream::View() const
+{
+    AabbSoA v;
+    for (int a = 0; a < 3; ++a)
+    {
+        v.Center[a] = mData[a].data();
+        v.Extents[a] = mData[3 + a].data();
+    }
+    v.Count = mCount;
+    return v;
+}
+
+size_t CullAabbsScalar(const AabbSoA& boxes, size_t first, size_t count,
+    const FrustumPlanes& frustum, uint32_t* visible)
+{
+    float abs[6][3];
+    AbsPlanes(frustum, abs);
+
+    size_t n = 0;
+    for (size_t i = first; i < first + count; ++i)
+    {
+        const float cx = boxes.Center[0][i], cy = boxes.Center[1][i], cz = boxes.Center[2][i];
+        const float ex = boxes.Extents[0][i], ey = boxes.Extents[1][i], ez = boxes.Extents[2][i];
+        bool outside = false;
+        for (int p = 0; p < 6; ++p)
+        {
+            const XMFLOAT4& pl = frustum.Planes[p];
+            float dist = pl.x * cx + pl.y * cy + pl.z * cz + pl.w;
+            float radius = abs[p][0] * ex + abs[p][1] * ey + abs[p][2] * ez;
+            outside |= dist + radius < 0.0f;
+        }
+        if (!outside) visible[n++] = (uint32_t)i;
+    }
+    return n;
+}
+
+size_t CullAabbsSSE(const AabbSoA& boxes, size_t first, size_t count,
+    const FrustumPlanes& frustum, uint32_t* visible)
+{
+    float abs[6][3];
+    AbsPlanes(frustum, abs);
+    __m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        nx[p] = _mm_set1_ps(frustum.Planes[p].x);
+        ny[p] = _mm_set1_ps(frustum.Planes[p].y);
+        nz[p] = _mm_set1_ps(frustum.Planes[p].z);
+        nw[p] = _mm_set1_ps(frustum.Planes[p].w);
+        ax[p] = _mm_set1_ps(abs[p][0]);
+        ay[p] = _mm_set1_ps(abs[p][1]);
+        az[p] = _mm_set1_ps(abs[p][2]);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t n = 0;
+    for (size_t i = 0; i < count; i += 4)
+    {
+        const size_t b = first + i;
+        __m128 cx = _mm_loadu_ps(boxes.Center[0] + b), cy = _mm_loadu_ps(boxes.Center[1] + b), cz = _mm_loadu_ps(boxes.Center[2] + b);
+        __m128 ex = _mm_loadu_ps(boxes.Extents[0] + b), ey = _mm_loadu_ps(boxes.Extents[1] + b), ez = _mm_loadu_ps(boxes.Extents[2] + b);
+
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+                _mm_mul_ps(nz[p], cz)), nw[p]);
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, radius), zero));
+        }
+
+        int bits = ~_mm_movemask_ps(outside) & 0xF;
+        if (count - i < 4) bits &= (1 << (count - i)) - 1;
+        for (; bits; bits &= bits - 1)
+        {
+            int l = 0;
+            while (!(bits & (1 << l))) ++l;
+            visible[n++] = (uint32_t)(b + l);
+        }
+    }
+    return n;
+}
+
+AVX2_TARGET
+size_t CullAabbsAVX2(const AabbSoA& boxes, size_t first, size_t count,
+    const FrustumPlanes& frustum, uint32_t* visible)
+{
+    float abs[6][3];
+    AbsPlanes(frustum, abs);
+    __m256 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        nx[p] = _mm256_set1_ps(frustum.Planes[p].x);
+        ny[p] = _mm256_set1_ps(frustum.Planes[p].y);
+        nz[p] = _mm256_set1_ps(frustum.Planes[p].z);
+        nw[p] = _mm256_set1_ps(frustum.Planes[p].w);
+        ax[p] = _mm256_set1_ps(abs[p][0]);
+        ay[p] = _mm256_set1_ps(abs[p][1]);
+        az[p] = _mm256_set1_ps(abs[p][2]);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t n = 0;
+    for (size_t i = 0; i < count; i += 8)
+    {
+        const size_t b = first + i;
+        __m256 cx = _mm256_loadu_ps(boxes.Center[0] + b), cy = _mm256_loadu_ps(boxes.Center[1] + b), cz = _mm256_loadu_ps(boxes.Center[2] + b);
+        __m256 ex = _mm256_loadu_ps(boxes.Extents[0] + b), ey = _mm256_loadu_ps(boxes.Extents[1] + b), ez = _mm256_loadu_ps(boxes.Extents[2] + b);
+
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; ++p)
+        {
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx[p], cx), _mm256_mul_ps(ny[p], cy)),
+                _mm256_mul_ps(nz[p], cz)), nw[p]);
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)), _mm256_mul_ps(az[p], ez));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(dist, radius), zero, _CMP_LT_OQ));
+        }
+
+        int bits = ~_mm256_movemask_ps(outside) & 0xFF;
+        if (count - i >= 8)
+        {
+            // Полный блок: 8 индексов пишутся разом, лишние перезапишет следующий блок.
+            // n <= i, поэтому запись не выходит за [0, count)
+            __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&kCompact.Lanes[bits]));
+            _mm256_storeu_si256((__m256i*)(visible + n), _mm256_add_epi32(lanes, _mm256_set1_epi32((int)b)));
+            n += (size_t)_mm_popcnt_u32((unsigned)bits);
+        }
+        else
+        {
+            bits &= (1 << (count - i)) - 1;
+            for (; bits; bits &= bits - 1)
+                visible[n++] = (uint32_t)(b + (size_t)_tzcnt_u32((unsigned)bits));
+        }
+    }
+
+    _mm256_zeroupper();
+    return n;
+}
+
+size_t CullAabbs(const AabbSoA& boxes, size_t first, size_t count,
+    const FrustumPlanes& frustum, uint32_t* visible)
+{
+    static const CullAabbsFn kernel = CpuSupportsAVX2() ? CullAabbsAVX2 : CullAabbsSSE;
+    return kernel(boxes, first, count, frustum, visible);
+}
+
+size_t CullAabbsParallel(WorkerPool& pool, const AabbSoA& boxes, const FrustumPlanes& frustum,
+    std::vector<uint32_t>& visible, size_t chunkBoxes)
+{
+    visible.resize(boxes.Count);
+    if (boxes.Count == 0) return 0;
+    if (chunkBoxes == 0) chunkBoxes = boxes.Count;
+
+    const size_t chunks = (boxes.Count + chunkBoxes - 1) / chunkBoxes;
+    std::vector<size_t> counts(chunks);
+    pool.ParallelFor(chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c)
+        {
+            size_t first = c * chunkBoxes;
+            size_t count = first + chunkBoxes < boxes.Count ? chunkBoxes : boxes.Count - first;
+            counts[c] = CullAabbs(boxes, first, count, frustum, visible.data() + first);
+        }
+    });
+
+    // Начало куска не левее его места в итоговом списке, поэтому сдвиг по порядку безопасен
+    size_t n = counts[0];
+    for (size_t c = 1; c < chunks; ++c)
+    {
+        std::memmove(visible.data() + n, visible.data() + c * chunkBoxes, counts[c] * sizeof(uint32_t));
+        n += counts[c];
+    }
+    visible.resize(n);
+    return n;
+}
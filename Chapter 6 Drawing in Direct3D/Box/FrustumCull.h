@@ -0,0 +1,65 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "WorkerPool.h"
+
+// Плоскости смотрят внутрь: точка внутри, если dot(n, p) + w >= 0 для всех шести.
+// Порядок: left, right, bottom, top, near, far; n нормирована.
+struct FrustumPlanes
+{
+    DirectX::XMFLOAT4 Planes[6];
+};
+
+// Gribb, Hartmann: плоскости из столбцов матрицы (вектор-строка, как в DirectXMath;
+// z клипа в [0, w], как в D3D). Для World * View * Proj плоскости получаются в пространстве модели.
+FrustumPlanes ExtractFrustumPlanes(DirectX::FXMMATRIX viewProj);
+
+// AABB в SoA: центры и полуразмеры по компонентам [0]=x [1]=y [2]=z.
+// За Count лежит минимум 8 нулевых боксов, так что 8-wide загрузка с любого индекса < Count
+// не выходит за буфер.
+struct AabbSoA
+{
+    const float* Center[3] = {};
+    const float* Extents[3] = {};
+    size_t       Count = 0;
+};
+
+class AabbStream
+{
+public:
+    void Resize(size_t count);
+    void Set(size_t index, const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents);
+    void Clear();
+
+    AabbSoA View() const;
+    size_t  Count() const { return mCount; }
+
+private:
+    std::vector<float> mData[6];   // Center xyz, Extents xyz
+    size_t             mCount = 0;
+};
+
+// Боксы [first, first + count) против frustum: видим бокс, который не лежит целиком снаружи
+// ни одной плоскости (как BoundingFrustum::Intersects, с теми же ложными срабатываниями у углов).
+// Индексы видимых пишутся в visible по возрастанию, места нужно на count; возвращает их число.
+// Варианты и выбор — см. SimdDispatch.h.
+typedef size_t (*CullAabbsFn)(const AabbSoA& boxes, size_t first, size_t count,
+    const FrustumPlanes& frustum, uint32_t* visible);
+
+size_t CullAabbsScalar(const AabbSoA& boxes, size_t first, size_t count,
+    const FrustumPlanes& frustum, uint32_t* visible);
+size_t CullAabbsSSE(const AabbSoA& boxes, size_t first, size_t count,
+    const FrustumPlanes& frustum, uint32_t* visible);
+// 8 боксов против 6 плоскостей за итерацию, сжатие маски в индексы — через таблицу перестановок.
+size_t CullAabbsAVX2(const AabbSoA& boxes, size_t first, size_t count,
+    const FrustumPlanes& frustum, uint32_t* visible);
+
+size_t CullAabbs(const AabbSoA& boxes, size_t first, size_t count,
+    const FrustumPlanes& frustum, uint32_t* visible);
+
+// Все боксы кусками по chunkBoxes на пуле потоков. Каждый кусок пишет индексы на своё место
+// в visible, затем куски сдвигаются вплотную — порядок тот же, что у последовательного CullAabbs.
+size_t CullAabbsParallel(WorkerPool& pool, const AabbSoA& boxes, const FrustumPlanes& frustum,
+    std::vector<uint32_t>& visible, size_t chunkBoxes = 16384);
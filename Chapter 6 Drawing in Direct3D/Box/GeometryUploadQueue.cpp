@@ -0,0 +1,171 @@
+#include "GeometryUploadQueue.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cstring>
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    const UINT64 kUploadPageBytes = 16ull << 20;
+}
+
+void GeometryUploadQueue::Init(ID3D12Device* device, UINT vertexStride, UINT64 vertexCapacity, UINT64 indexCapacity)
+{
+    mDevice = device;
+    mVertexStride = vertexStride;
+    mVertexCount = 0;
+    mNarrowSubmeshes = 0;
+    mWideSubmeshes = 0;
+
+    // Буферы создаются при первой записи; Capacity до этого — начальный размер.
+    // 32-битные индексы — редкость (сабмеши больше 64K вершин), им хватает меньшего старта
+    mVertexBuffer = GrowableBuffer();
+    mVertexBuffer.Capacity = std::max<UINT64>(vertexCapacity, 1) * vertexStride;
+    mNarrowIndices = GrowableBuffer();
+    mNarrowIndices.Capacity = std::max<UINT64>(indexCapacity, 1) * sizeof(uint16_t);
+    mWideIndices = GrowableBuffer();
+    mWideIndices.Capacity = std::max<UINT64>(indexCapacity / 8, 1) * sizeof(uint32_t);
+    Retire();
+}
+
+ComPtr<ID3D12Resource> GeometryUploadQueue::CreateBuffer(UINT64 byteSize, D3D12_HEAP_TYPE heap,
+    D3D12_RESOURCE_STATES state)
+{
+    CD3DX12_HEAP_PROPERTIES heapProps(heap);
+    CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+    ComPtr<ID3D12Resource> buffer;
+    ThrowIfFailed(mDevice->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, state,
+        nullptr, IID_PPV_ARGS(buffer.GetAddressOf())));
+    return buffer;
+}
+
+void GeometryUploadQueue::Reserve(ID3D12GraphicsCommandList* cmdList, GrowableBuffer& buffer, UINT64 byteSize)
+{
+    if (buffer.Resource && buffer.Size + byteSize <= buffer.Capacity) return;
+
+    UINT64 capacity = buffer.Resource ? buffer.Capacity * 2 : buffer.Capacity;
+    capacity = std::max(capacity, buffer.Size + byteSize);
+
+    ComPtr<ID3D12Resource> grown = CreateBuffer(capacity, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON);
+    CD3DX12_RESOURCE_BARRIER toCopyDest = CD3DX12_RESOURCE_BARRIER::Transition(grown.Get(),
+        D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
+    cmdList->ResourceBarrier(1, &toCopyDest);
+
+    // Уже записанное переезжает на GPU; старый буфер живёт до Retire
+    if (buffer.Resource)
+    {
+        if (buffer.Size > 0)
+        {
+            CD3DX12_RESOURCE_BARRIER toCopySource = CD3DX12_RESOURCE_BARRIER::Transition(buffer.Resource.Get(),
+                D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+            cmdList->ResourceBarrier(1, &toCopySource);
+            cmdList->CopyBufferRegion(grown.Get(), 0, buffer.Resource.Get(), 0, buffer.Size);
+        }
+        mRetired.push_back(buffer.Resource);
+    }
+
+    buffer.Resource = grown;
+    buffer.Capacity = capacity;
+}
+
+void GeometryUploadQueue::Upload(ID3D12GraphicsCommandList* cmdList, GrowableBuffer& buffer,
+    const void* data, UINT64 byteSize)
+{
+    if (byteSize == 0) return;
+    Reserve(cmdList, buffer, byteSize);
+
+    // Used выравнивается по 16, поэтому и страница под крупную загрузку — тоже: иначе Used
+    // перешагнёт Capacity, а разность в проверке ниже уйдёт через ноль.
+    const UINT64 alignedSize = (byteSize + 15) & ~15ull;
+    if (mPages.empty() || mPages.back().Used + byteSize > mPages.back().Capacity)
+    {
+        UploadPage page;
+        page.Capacity = std::max(kUploadPageBytes, alignedSize);
+        page.Resource = CreateBuffer(page.Capacity, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
+        CD3DX12_RANGE noRead(0, 0);
+        ThrowIfFailed(page.Resource->Map(0, &noRead, reinterpret_cast<void**>(&page.Mapped)));
+        mPendingBytes += page.Capacity;
+        mPages.push_back(page);
+    }
+
+    UploadPage& page = mPages.back();
+    std::memcpy(page.Mapped + page.Used, data, (size_t)byteSize);
+    cmdList->CopyBufferRegion(buffer.Resource.Get(), buffer.Size, page.Resource.Get(), page.Used, byteSize);
+    page.Used += alignedSize;
+    buffer.Size += byteSize;
+}
+
+UINT GeometryUploadQueue::AppendVertices(ID3D12GraphicsCommandList* cmdList, const void* vertices, UINT vertexCount)
+{
+    UINT baseVertex = mVertexCount;
+    Upload(cmdList, mVertexBuffer, vertices, (UINT64)vertexCount * mVertexStride);
+    mVertexCount += vertexCount;
+    return baseVertex;
+}
+
+SubmeshGeometry GeometryUploadQueue::AppendIndices(ID3D12GraphicsCommandList* cmdList,
+    const uint32_t* indices, UINT indexCount, UINT indexOffset, INT baseVertex)
+{
+    SubmeshGeometry submesh;
+    submesh.IndexCount = indexCount;
+    submesh.BaseVertexLocation = baseVertex;
+
+    if (NarrowIndices(indices, indexCount, indexOffset, mNarrowScratch))
+    {
+        submesh.IndexFormat = DXGI_FORMAT_R16_UINT;
+        submesh.StartIndexLocation = (UINT)(mNarrowIndices.Size / sizeof(uint16_t));
+        Upload(cmdList, mNarrowIndices, mNarrowScratch.data(), (UINT64)indexCount * sizeof(uint16_t));
+        ++mNarrowSubmeshes;
+        return submesh;
+    }
+
+    submesh.IndexFormat = DXGI_FORMAT_R32_UINT;
+    submesh.StartIndexLocation = (UINT)(mWideIndices.Size / sizeof(uint32_t));
+    if (indexOffset == 0)
+    {
+        Upload(cmdList, mWideIndices, indices, (UINT64)indexCount * sizeof(uint32_t));
+    }
+    else
+    {
+        std::vector<uint32_t> local(indices, indices + indexCount);
+        for (uint32_t& i : local) i -= indexOffset;
+        Upload(cmdList, mWideIndices, local.data(), (UINT64)indexCount * sizeof(uint32_t));
+    }
+    ++mWideSubmeshes;
+    return submesh;
+}
+
+void GeometryUploadQueue::Retire()
+{
+    mPages.clear();
+    mRetired.clear();
+    mPendingBytes = 0;
+}
+
+void GeometryUploadQueue::Finish(ID3D12GraphicsCommandList* cmdList, MeshGeometry& geo)
+{
+    // Пустая геометрия тоже получает буферы, чтобы у MeshGeometry были валидные view
+    Reserve(cmdList, mVertexBuffer, 0);
+    Reserve(cmdList, mNarrowIndices, 0);
+    Reserve(cmdList, mWideIndices, 0);
+
+    CD3DX12_RESOURCE_BARRIER toRead[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(mVertexBuffer.Resource.Get(),
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ),
+        CD3DX12_RESOURCE_BARRIER::Transition(mNarrowIndices.Resource.Get(),
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ),
+        CD3DX12_RESOURCE_BARRIER::Transition(mWideIndices.Resource.Get(),
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ),
+    };
+    cmdList->ResourceBarrier(_countof(toRead), toRead);
+
+    geo.VertexBufferGPU = mVertexBuffer.Resource;
+    geo.VertexByteStride = mVertexStride;
+    geo.VertexBufferByteSize = (UINT)mVertexBuffer.Size;
+    geo.IndexBufferGPU = mNarrowIndices.Resource;
+    geo.IndexFormat = DXGI_FORMAT_R16_UINT;
+    geo.IndexBufferByteSize = (UINT)mNarrowIndices.Size;
+    geo.WideIndexBufferGPU = mWideIndices.Resource;
+    geo.WideIndexBufferByteSize = (UINT)mWideIndices.Size;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "Common/d3dUtil.h"
+#include "Common/d3dx12.h"
+#include <cstdint>
+#include <vector>
+
+// Общий VB и два IB (16- и 32-битный) в default heap, куда геометрия дописывается
+// по частям, пока идёт импорт. Данные кладутся в страницы upload heap и копируются CopyBufferRegion; когда места
+// не хватает, буфер пересоздаётся вдвое большим, а старое содержимое копируется на GPU.
+// Страницы и старые буферы держатся до Retire — его зовут, когда GPU выполнил записанные команды.
+class GeometryUploadQueue
+{
+public:
+    GeometryUploadQueue() = default;
+    GeometryUploadQueue(const GeometryUploadQueue&) = delete;
+    GeometryUploadQueue& operator=(const GeometryUploadQueue&) = delete;
+
+    void Init(ID3D12Device* device, UINT vertexStride, UINT64 vertexCapacity, UINT64 indexCapacity);
+
+    // Возвращает baseVertex — номер первой дописанной вершины.
+    UINT AppendVertices(ID3D12GraphicsCommandList* cmdList, const void* vertices, UINT vertexCount);
+
+    // Индексы сабмеша, чьи вершины начинаются с baseVertex; в буфер идёт index - indexOffset.
+    // Если все такие индексы влезают в 16 бит, сабмеш попадает в R16 IB, иначе — в R32.
+    SubmeshGeometry AppendIndices(ID3D12GraphicsCommandList* cmdList, const uint32_t* indices, UINT indexCount,
+        UINT indexOffset, INT baseVertex);
+
+    UINT   VertexCount() const { return mVertexCount; }
+    UINT64 IndexBytes() const  { return mNarrowIndices.Size + mWideIndices.Size; }
+    UINT   WideSubmeshCount() const   { return mWideSubmeshes; }
+    UINT   NarrowSubmeshCount() const { return mNarrowSubmeshes; }
+
+    // Upload-память, которая освободится после Retire.
+    UINT64 PendingBytes() const { return mPendingBytes; }
+    void   Retire();
+
+    // Переводит буферы в GENERIC_READ и отдаёт их в geo (без CPU-копий).
+    void Finish(ID3D12GraphicsCommandList* cmdList, MeshGeometry& geo);
+
+private:
+    struct GrowableBuffer
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+        UINT64 Capacity = 0;
+        UINT64 Size = 0;
+    };
+
+    struct UploadPage
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+        BYTE*  Mapped = nullptr;
+        UINT64 Capacity = 0;
+        UINT64 Used = 0;
+    };
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> CreateBuffer(UINT64 byteSize, D3D12_HEAP_TYPE heap,
+        D3D12_RESOURCE_STATES state);
+    void Reserve(ID3D12GraphicsCommandList* cmdList, GrowableBuffer& buffer, UINT64 byteSize);
+    void Upload(ID3D12GraphicsCommandList* cmdList, GrowableBuffer& buffer, const void* data, UINT64 byteSize);
+
+    ID3D12Device*  mDevice = nullptr;
+    UINT           mVertexStride = 0;
+    UINT           mVertexCount = 0;
+    UINT           mNarrowSubmeshes = 0;
+    UINT           mWideSubmeshes = 0;
+    GrowableBuffer mVertexBuffer;
+    GrowableBuffer mNarrowIndices;   // R16
+    GrowableBuffer mWideIndices;     // R32
+
+    std::vector<uint16_t> mNarrowScratch;
+
+    std::vector<UploadPage>                             mPages;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> mRetired;   // буферы до роста
+    UINT64                                              mPendingBytes = 0;
+};
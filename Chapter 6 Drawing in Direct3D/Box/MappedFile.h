@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Файл, отображённый в память только для чтения. Адрес начала выровнен по странице.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool           IsOpen() const { return mData != nullptr; }
+    const uint8_t* Data()   const { return mData; }
+    size_t         Size()   const { return mSize; }
+
+private:
+    const uint8_t* mData = nullptr;
+    size_t         mSize = 0;
+#if defined(_WIN32)
+    void*          mFile = nullptr;
+    void*          mMapping = nullptr;
+#endif
+};
+
+// FNV-1a 64 по 8-байтовым словам — ключ кэшей, производных от исходных файлов.
+uint64_t HashBytes64(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
+// Хэш содержимого файла; false, если файл не открылся.
+bool HashFile64(const std::string& path, uint64_t& hash);
@@ -0,0 +1,396 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount,
+    size_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStats stats;
+    if (indexCount < 3 || vertexCount == 0) return stats;
+
+    // Вершина в кэше, если с её последней загрузки было меньше cacheSize промахов.
+    std::vector<uint64_t> loadedAt(vertexCount, UINT64_MAX);
+    std::vector<uint8_t>  used(vertexCount, 0);
+    uint64_t misses = 0;
+    size_t   unique = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t v = indices[i];
+        if (loadedAt[v] == UINT64_MAX || misses - loadedAt[v] >= cacheSize)
+        {
+            loadedAt[v] = misses;
+            ++misses;
+        }
+        if (!used[v])
+        {
+            used[v] = 1;
+            ++unique;
+        }
+    }
+
+    stats.ACMR = (float)misses / (float)(indexCount / 3);
+    stats.ATVR = unique ? (float)misses / (float)unique : 0.0f;
+    return stats;
+}
+
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+    const size_t triCount = indexCount / 3;
+    if (triCount == 0 || vertexCount == 0) return;
+
+    // Смежность вершина -> треугольники (CSR)
+    std::vector<uint32_t> live(vertexCount, 0);
+    for (size_t i = 0; i < triCount * 3; ++i)
+        ++live[indices[i]];
+    std::vector<uint32_t> adjOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        adjOffset[v + 1] = adjOffset[v] + live[v];
+    std::vector<uint32_t> adj(adjOffset[vertexCount]);
+    {
+        std::vector<uint32_t> fill(adjOffset.begin(), adjOffset.end() - 1);
+        for (size_t t = 0; t < triCount; ++t)
+            for (int k = 0; k < 3; ++k)
+                adj[fill[indices[3 * t + k]]++] = (uint32_t)t;
+    }
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<uint8_t>  emitted(triCount, 0);
+    std::vector<uint32_t> deadEnd;            // недавно выданные вершины — кандидаты при тупике
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> out;
+    out.reserve(triCount * 3);
+
+    uint32_t timestamp = cacheSize + 1;
+    size_t   cursor = 0;                       // следующий кандидат при полном тупике
+    int64_t  fan = indices[0];
+
+    while (fan >= 0)
+    {
+        candidates.clear();
+        for (uint32_t a = adjOffset[(size_t)fan]; a < adjOffset[(size_t)fan + 1]; ++a)
+        {
+            uint32_t t = adj[a];
+            if (emitted[t]) continue;
+            emitted[t] = 1;
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = indices[3 * t + k];
+                out.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (timestamp - cacheTime[v] > cacheSize)
+                    cacheTime[v] = timestamp++;
+            }
+        }
+
+        // Следующая вершина-веер: та, что ещё останется в кэше после её живых треугольников
+        // и при этом дольше всех в нём.
+        int64_t best = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates)
+        {
+            if (live[v] == 0) continue;
+            int64_t priority = 0;
+            if ((int64_t)timestamp - cacheTime[v] + 2 * (int64_t)live[v] <= (int64_t)cacheSize)
+                priority = (int64_t)timestamp - cacheTime[v];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                best = v;
+            }
+        }
+
+        if (best < 0)
+        {
+            while (!deadEnd.empty() && best < 0)
+            {
+                uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) best = v;
+            }
+            while (best < 0 && cursor < vertexCount)
+            {
+                if (live[cursor] > 0) best = (int64_t)cursor;
+                ++cursor;
+            }
+        }
+        fan = best;
+    }
+
+    std::copy(out.begin(), out.end(), indices);
+}
+
+size_t OptimizeVertexFetchRemap(uint32_t* indices, size_t indexCount, size_t vertexCount,
+    std::vector<uint32_t>& remap)
+{
+    remap.assign(vertexCount, UINT32_MAX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t& r = remap[indices[i]];
+        if (r == UINT32_MAX) r = next++;
+        indices[i] = r;
+    }
+    return next;
+}
+
+namespace
+{
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    Float3 LoadPosition(const float* positions, size_t stride, uint32_t v)
+    {
+        Float3 p;
+        std::memcpy(&p, (const uint8_t*)positions + v * stride, sizeof(p));
+        return p;
+    }
+
+    // FIFO-кэш с явным сбросом — для подсчёта промахов на отрезках index buffer.
+    class CacheSim
+    {
+    public:
+        CacheSim(size_t vertexCount, uint32_t cacheSize)
+            : mLoadedAt(vertexCount, 0), mCacheSize(cacheSize) {}
+
+        void Reset() { mTime += mCacheSize; }
+
+        uint32_t Triangle(const uint32_t* tri)
+        {
+            uint32_t misses = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                uint64_t& at = mLoadedAt[tri[k]];
+                if (at == 0 || mTime - at >= mCacheSize)
+                {
+                    at = ++mTime;
+                    ++misses;
+                }
+            }
+            return misses;
+        }
+
+    private:
+        std::vector<uint64_t> mLoadedAt;   // 0 — ни разу не загружалась
+        uint64_t              mTime = 0;
+        uint32_t              mCacheSize;
+    };
+
+    struct Cluster
+    {
+        size_t First;   // первый треугольник
+        size_t Count;
+        float  SortKey;
+    };
+}
+
+void OptimizeOverdraw(uint32_t* indices, size_t indexCount,
+    const float* positions, size_t vertexCount, size_t positionStride,
+    uint32_t cacheSize, float threshold)
+{
+    const size_t triCount = indexCount / 3;
+    if (triCount < 2 || vertexCount == 0) return;
+
+    // Жёсткие границы: треугольник, у которого промахнулись все три вершины, начинает новый кусок.
+    std::vector<size_t> hard;
+    {
+        CacheSim cache(vertexCount, cacheSize);
+        for (size_t t = 0; t < triCount; ++t)
+            if (cache.Triangle(indices + 3 * t) == 3 || t == 0)
+                hard.push_back(t);
+        hard.push_back(triCount);
+    }
+
+    // Мягкие границы внутри куска: режем, как только ACMR от начала кластера не хуже порога.
+    std::vector<Cluster> clusters;
+    CacheSim cache(vertexCount, cacheSize);
+    for (size_t h = 0; h + 1 < hard.size(); ++h)
+    {
+        size_t begin = hard[h], end = hard[h + 1];
+
+        cache.Reset();
+        uint32_t misses = 0;
+        for (size_t t = begin; t < end; ++t)
+            misses += cache.Triangle(indices + 3 * t);
+        float limit = threshold * (float)misses / (float)(end - begin);
+
+        cache.Reset();
+        size_t   first = begin;
+        uint32_t clusterMisses = 0;
+        for (size_t t = begin; t < end; ++t)
+        {
+            clusterMisses += cache.Triangle(indices + 3 * t);
+            if ((float)clusterMisses / (float)(t + 1 - first) <= limit || t + 1 == end)
+            {
+                clusters.push_back({ first, t + 1 - first, 0.0f });
+                first = t + 1;
+                clusterMisses = 0;
+                cache.Reset();
+            }
+        }
+    }
+    if (clusters.size() < 2) return;
+
+    // Центр меша — по площади; ключ кластера — насколько он повёрнут наружу от центра.
+    double cx = 0.0, cy = 0.0, cz = 0.0, totalArea = 0.0;
+    std::vector<float> areas(triCount);
+    std::vector<Float3> centroids(triCount), normals(triCount);
+    for (size_t t = 0; t < triCount; ++t)
+    {
+        Float3 a = LoadPosition(positions, positionStride, indices[3 * t + 0]);
+        Float3 b = LoadPosition(positions, positionStride, indices[3 * t + 1]);
+        Float3 c = LoadPosition(positions, positionStride, indices[3 * t + 2]);
+        Float3 e1 = { b.x - a.x, b.y - a.y, b.z - a.z };
+        Float3 e2 = { c.x - a.x, c.y - a.y, c.z - a.z };
+        Float3 n = { e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+        float area = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+        normals[t] = n;   // длина = удвоенная площадь, сумма даёт взвешенную нормаль
+        areas[t] = area;
+        centroids[t] = { (a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f, (a.z + b.z + c.z) / 3.0f };
+        cx += centroids[t].x * area;
+        cy += centroids[t].y * area;
+        cz += centroids[t].z * area;
+        totalArea += area;
+    }
+    if (totalArea > 0.0)
+    {
+        cx /= totalArea;
+        cy /= totalArea;
+        cz /= totalArea;
+    }
+
+    for (Cluster& cl : clusters)
+    {
+        double px = 0.0, py = 0.0, pz = 0.0, nx = 0.0, ny = 0.0, nz = 0.0, area = 0.0;
+        for (size_t t = cl.First; t < cl.First + cl.Count; ++t)
+        {
+            px += centroids[t].x * areas[t];
+            py += centroids[t].y * areas[t];
+            pz += centroids[t].z * areas[t];
+            nx += normals[t].x;
+            ny += normals[t].y;
+            nz += normals[t].z;
+            area += areas[t];
+        }
+        double len = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (area <= 0.0 || len <= 0.0) continue;
+        cl.SortKey = (float)(((px / area - cx) * nx + (py / area - cy) * ny + (pz / area - cz) * nz) / len);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+        [](const Cluster& a, const Cluster& b) { return a.SortKey > b.SortKey; });
+
+    std::vector<uint32_t> out;
+    out.reserve(triCount * 3);
+    for (const Cluster& cl : clusters)
+        out.insert(out.end(), indices + 3 * cl.First, indices + 3 * (cl.First + cl.Count));
+    std::copy(out.begin(), out.end(), indices);
+}
+
+OverdrawStats AnalyzeOverdraw(const uint32_t* indices, size_t indexCount,
+    const float* positions, size_t vertexCount, size_t positionStride, uint32_t resolution)
+{
+    OverdrawStats stats;
+    const size_t triCount = indexCount / 3;
+    if (triCount == 0 || vertexCount == 0 || resolution == 0) return stats;
+
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t i = 0; i < triCount * 3; ++i)
+    {
+        Float3 p = LoadPosition(positions, positionStride, indices[i]);
+        const float c[3] = { p.x, p.y, p.z };
+        for (int a = 0; a < 3; ++a)
+        {
+            lo[a] = std::min(lo[a], c[a]);
+            hi[a] = std::max(hi[a], c[a]);
+        }
+    }
+
+    const float size = (float)resolution;
+    std::vector<float> depth(resolution * resolution);
+
+    for (int view = 0; view < 6; ++view)
+    {
+        const int   axis = view / 2;
+        const int   u = (axis + 1) % 3, v = (axis + 2) % 3;
+        const float sign = (view & 1) ? -1.0f : 1.0f;
+        const float su = hi[u] > lo[u] ? size / (hi[u] - lo[u]) : 0.0f;
+        const float sv = hi[v] > lo[v] ? size / (hi[v] - lo[v]) : 0.0f;
+        std::fill(depth.begin(), depth.end(), FLT_MAX);
+
+        for (size_t t = 0; t < triCount; ++t)
+        {
+            float x[3], y[3], z[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                Float3 p = LoadPosition(positions, positionStride, indices[3 * t + k]);
+                const float c[3] = { p.x, p.y, p.z };
+                x[k] = (c[u] - lo[u]) * su;
+                y[k] = (c[v] - lo[v]) * sv;
+                z[k] = sign * c[axis];
+            }
+
+            float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+            if (area == 0.0f) continue;
+            float invArea = 1.0f / area;
+
+            int x0 = std::max(0, (int)std::floor(std::min({ x[0], x[1], x[2] })));
+            int y0 = std::max(0, (int)std::floor(std::min({ y[0], y[1], y[2] })));
+            int x1 = std::min((int)resolution - 1, (int)std::ceil(std::max({ x[0], x[1], x[2] })));
+            int y1 = std::min((int)resolution - 1, (int)std::ceil(std::max({ y[0], y[1], y[2] })));
+
+            for (int py = y0; py <= y1; ++py)
+            {
+                float cy = (float)py + 0.5f;
+                for (int px = x0; px <= x1; ++px)
+                {
+                    float cx = (float)px + 0.5f;
+                    // Барицентрики через рёберные функции; знак площади учитывает обе ориентации.
+                    float w0 = ((x[2] - x[1]) * (cy - y[1]) - (y[2] - y[1]) * (cx - x[1])) * invArea;
+                    float w1 = ((x[0] - x[2]) * (cy - y[2]) - (y[0] - y[2]) * (cx - x[2])) * invArea;
+                    float w2 = 1.0f - w0 - w1;
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+                    float d = w0 * z[0] + w1 * z[1] + w2 * z[2];
+                    float& stored = depth[(size_t)py * resolution + px];
+                    if (d < stored)
+                    {
+                        stored = d;
+                        ++stats.Shaded;
+                    }
+                }
+            }
+        }
+
+        for (float d : depth)
+            if (d != FLT_MAX) ++stats.Covered;
+    }
+
+    stats.Overdraw = stats.Covered ? (float)stats.Shaded / (float)stats.Covered : 0.0f;
+    return stats;
+}
+
+bool NarrowIndices(const uint32_t* indices, size_t indexCount, uint32_t indexOffset,
+    std::vector<uint16_t>& out)
+{
+    out.resize(indexCount);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t local = indices[i] - indexOffset;
+        if (local >= kMaxIndex16Vertices)
+        {
+            out.clear();
+            return false;
+        }
+        out[i] = (uint16_t)local;
+    }
+    return true;
+}
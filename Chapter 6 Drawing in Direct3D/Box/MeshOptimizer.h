@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Размер FIFO post-transform кэша для статистики (типичное значение для современных GPU).
+static const uint32_t kVertexCacheSize = 16;
+
+struct VertexCacheStats
+{
+    float ACMR = 0.0f;   // промахи кэша на треугольник: 3 — без повторного использования, ~0.5 — идеал
+    float ATVR = 0.0f;   // промахи на уникальную вершину: 1 — каждая вершина трансформируется один раз
+};
+
+// Симуляция FIFO-кэша по index buffer. vertexCount — верхняя граница индексов.
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount,
+    size_t vertexCount, uint32_t cacheSize = kVertexCacheSize);
+
+// Tipsify (Sander, Nehab, Barczak 2007): переупорядочивает треугольники под post-transform кэш
+// за линейное время. Порядок вершин внутри треугольника (winding) сохраняется.
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount,
+    uint32_t cacheSize = kVertexCacheSize);
+
+// Нумерует вершины в порядке первого использования и переписывает индексы.
+// remap[old] = new, UINT32_MAX у неиспользуемых. Возвращает число используемых вершин.
+size_t OptimizeVertexFetchRemap(uint32_t* indices, size_t indexCount, size_t vertexCount,
+    std::vector<uint32_t>& remap);
+
+// Сабмеш не больше чем из стольких вершин идёт с 16-битными индексами от BaseVertexLocation.
+static const uint32_t kMaxIndex16Vertices = 65536;
+
+// Индексы сабмеша со сдвигом -indexOffset в 16 бит. false (out пуст), если какой-то не влезает.
+bool NarrowIndices(const uint32_t* indices, size_t indexCount, uint32_t indexOffset,
+    std::vector<uint16_t>& out);
+
+// Порог перестройки под overdraw: ACMR кластера может вырасти не более чем в столько раз.
+static const float kOverdrawThreshold = 1.05f;
+
+// Sander, Nehab, Barczak 2007: режет cache-оптимизированный порядок на кластеры и рисует первыми
+// те, что смотрят наружу от центра меша — они чаще перекрывают остальные. Кластеры режутся там,
+// где кэш и так сбрасывается, или где ACMR накопленного куска уже не хуже threshold * ACMR кластера.
+// positions — xyz float с шагом positionStride байт.
+void OptimizeOverdraw(uint32_t* indices, size_t indexCount,
+    const float* positions, size_t vertexCount, size_t positionStride,
+    uint32_t cacheSize = kVertexCacheSize, float threshold = kOverdrawThreshold);
+
+struct OverdrawStats
+{
+    uint64_t Covered = 0;     // пикселей, закрытых хотя бы одним треугольником
+    uint64_t Shaded = 0;      // фрагментов, прошедших depth test (LESS)
+    float    Overdraw = 0.0f; // Shaded / Covered, 1 — без перерисовки
+};
+
+// Программный растеризатор: 6 ортографических видов вдоль +-X, +-Y, +-Z по AABB меша,
+// resolution x resolution, без отсечения задних граней. Сумма по всем видам.
+OverdrawStats AnalyzeOverdraw(const uint32_t* indices, size_t indexCount,
+    const float* positions, size_t vertexCount, size_t positionStride, uint32_t resolution = 256);
+
+template <typename V>
+void RemapVertices(std::vector<V>& vertices, const std::vector<uint32_t>& remap, size_t used)
+{
+    std::vector<V> reordered(used);
+    for (size_t i = 0; i < vertices.size(); ++i)
+        if (remap[i] != UINT32_MAX)
+            reordered[remap[i]] = vertices[i];
+    vertices.swap(reordered);
+}
+
+// Проходы для сабмеша с локальными индексами; неиспользуемые вершины отбрасываются.
+template <typename V>
+void OptimizeMesh(std::vector<uint32_t>& indices, std::vector<V>& vertices)
+{
+    if (indices.empty()) return;
+    OptimizeVertexCache(indices.data(), indices.size(), vertices.size());
+
+    std::vector<uint32_t> remap;
+    size_t used = OptimizeVertexFetchRemap(indices.data(), indices.size(), vertices.size(), remap);
+    RemapVertices(vertices, remap, used);
+}
+
+// То же с перестройкой под overdraw; positionOffset — offsetof позиции (float xyz) в V.
+template <typename V>
+void OptimizeMesh(std::vector<uint32_t>& indices, std::vector<V>& vertices, size_t positionOffset)
+{
+    if (indices.empty()) return;
+    OptimizeVertexCache(indices.data(), indices.size(), vertices.size());
+    OptimizeOverdraw(indices.data(), indices.size(),
+        (const float*)((const uint8_t*)vertices.data() + positionOffset), vertices.size(), sizeof(V));
+
+    std::vector<uint32_t> remap;
+    size_t used = OptimizeVertexFetchRemap(indices.data(), indices.size(), vertices.size(), remap);
+    RemapVertices(vertices, remap, used);
+}
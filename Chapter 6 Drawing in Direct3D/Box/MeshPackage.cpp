@@ -0,0 +1,252 @@
+#include "MeshPackage.h"
+#include "BinaryFile.h"
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    uint32_t AddString(std::string& strings, const std::string& s)
+    {
+        uint32_t offset = (uint32_t)strings.size();
+        strings += s;
+        return offset;
+    }
+}
+
+std::string MeshPackagePath(const std::string& objPath)
+{
+    return objPath + ".mesh";
+}
+
+bool SaveMeshPackage(const std::string& path, const ImportedMesh& mesh, uint64_t sourceHash)
+{
+    std::string strings;
+    std::vector<MeshPackageSubmesh> submeshes;
+    for (const ImportedSubmesh& s : mesh.Submeshes)
+    {
+        MeshPackageSubmesh r = {};
+        r.FirstIndex = s.FirstIndex;
+        r.IndexCount = s.IndexCount;
+        r.FirstVertex = s.FirstVertex;
+        r.VertexCount = s.VertexCount;
+        r.Material = s.Material;
+        r.NameOffset = AddString(strings, s.Name);
+        r.NameLength = (uint32_t)s.Name.size();
+        r.FirstLod = s.FirstLod;
+        r.LodCount = s.LodCount;
+        submeshes.push_back(r);
+    }
+    std::vector<MeshPackageMaterial> materials;
+    for (const std::string& tex : mesh.DiffuseTextures)
+        materials.push_back({ AddString(strings, tex), (uint32_t)tex.size() });
+
+    MeshPackageHeader h = {};
+    h.Version = kMeshPackageVersion;
+    h.SourceHash = sourceHash;
+    h.VertexStride = sizeof(MeshVertex);
+    h.VertexCount = (uint32_t)mesh.Vertices.size();
+    h.IndexCount = (uint32_t)mesh.Indices.size();
+    h.SubmeshCount = (uint32_t)submeshes.size();
+    h.MaterialCount = (uint32_t)materials.size();
+    h.LodIndexCount = (uint32_t)mesh.LodIndices.size();
+    h.LodCount = (uint32_t)mesh.Lods.size();
+    h.VerticesOffset = AlignUp(sizeof(MeshPackageHeader));
+    h.IndicesOffset = AlignUp(h.VerticesOffset + (uint64_t)h.VertexCount * sizeof(MeshVertex));
+    h.SubmeshesOffset = AlignUp(h.IndicesOffset + (uint64_t)h.IndexCount * sizeof(uint32_t));
+    h.MaterialsOffset = AlignUp(h.SubmeshesOffset + (uint64_t)h.SubmeshCount * sizeof(MeshPackageSubmesh));
+    h.StringsOffset = AlignUp(h.MaterialsOffset + (uint64_t)h.MaterialCount * sizeof(MeshPackageMaterial));
+    h.StringsSize = strings.size();
+    h.LodIndicesOffset = AlignUp(h.StringsOffset + h.StringsSize);
+    h.LodsOffset = AlignUp(h.LodIndicesOffset + (uint64_t)h.LodIndexCount * sizeof(uint32_t));
+    h.FileSize = AlignUp(h.LodsOffset + (uint64_t)h.LodCount * sizeof(MeshLod));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    out.write((const char*)&h, sizeof(h));
+    WritePadding(out, h.VerticesOffset);
+    out.write((const char*)mesh.Vertices.data(), (std::streamsize)(h.VertexCount * sizeof(MeshVertex)));
+    WritePadding(out, h.IndicesOffset);
+    out.write((const char*)mesh.Indices.data(), (std::streamsize)(h.IndexCount * sizeof(uint32_t)));
+    WritePadding(out, h.SubmeshesOffset);
+    out.write((const char*)submeshes.data(), (std::streamsize)(submeshes.size() * sizeof(MeshPackageSubmesh)));
+    WritePadding(out, h.MaterialsOffset);
+    out.write((const char*)materials.data(), (std::streamsize)(materials.size() * sizeof(MeshPackageMaterial)));
+    WritePadding(out, h.StringsOffset);
+    out.write(strings.data(), (std::streamsize)strings.size());
+    WritePadding(out, h.LodIndicesOffset);
+    out.write((const char*)mesh.LodIndices.data(), (std::streamsize)(h.LodIndexCount * sizeof(uint32_t)));
+    WritePadding(out, h.LodsOffset);
+    out.write((const char*)mesh.Lods.data(), (std::streamsize)(h.LodCount * sizeof(MeshLod)));
+    WritePadding(out, h.FileSize);
+
+    h.Magic = kMeshPackageMagic;
+    out.seekp(0);
+    out.write((const char*)&h, sizeof(h));
+    return (bool)out;
+}
+
+bool MeshPackage::Open(const std::string& path, uint64_t sourceHash)
+{
+    Close();
+    if (!mFile.Open(path) || mFile.Size() < sizeof(MeshPackageHeader))
+    {
+        Close();
+        return false;
+    }
+
+    MeshPackageHeader h;
+    std::memcpy(&h, mFile.Data(), sizeof(h));
+    bool valid = h.Magic == kMeshPackageMagic && h.Version == kMeshPackageVersion &&
+        h.SourceHash == sourceHash && h.VertexStride == sizeof(MeshVertex) && h.FileSize == mFile.Size();
+
+    // Границы и выравнивание секций: VB и IB читаются по этим указателям напрямую.
+    valid = valid && h.VerticesOffset % kSectionAlign == 0 && h.IndicesOffset % kSectionAlign == 0 &&
+        h.SubmeshesOffset % kSectionAlign == 0 && h.MaterialsOffset % kSectionAlign == 0 &&
+        h.LodIndicesOffset % kSectionAlign == 0 && h.LodsOffset % kSectionAlign == 0 &&
+        h.VerticesOffset + (uint64_t)h.VertexCount * sizeof(MeshVertex) <= h.IndicesOffset &&
+        h.IndicesOffset + (uint64_t)h.IndexCount * sizeof(uint32_t) <= h.SubmeshesOffset &&
+        h.SubmeshesOffset + (uint64_t)h.SubmeshCount * sizeof(MeshPackageSubmesh) <= h.MaterialsOffset &&
+        h.MaterialsOffset + (uint64_t)h.MaterialCount * sizeof(MeshPackageMaterial) <= h.StringsOffset &&
+        h.StringsOffset + h.StringsSize <= h.LodIndicesOffset &&
+        h.LodIndicesOffset + (uint64_t)h.LodIndexCount * sizeof(uint32_t) <= h.LodsOffset &&
+        h.LodsOffset + (uint64_t)h.LodCount * sizeof(MeshLod) <= h.FileSize;
+    if (!valid)
+    {
+        Close();
+        return false;
+    }
+
+    const uint8_t* base = mFile.Data();
+    const char*    strings = (const char*)base + h.StringsOffset;
+    auto str = [&](uint32_t offset, uint32_t length, std::string& s) {
+        if ((uint64_t)offset + length > h.StringsSize) return false;
+        s.assign(strings + offset, length);
+        return true;
+    };
+
+    const MeshPackageSubmesh* submeshes = (const MeshPackageSubmesh*)(base + h.SubmeshesOffset);
+    mSubmeshes.resize(h.SubmeshCount);
+    for (uint32_t i = 0; i < h.SubmeshCount; ++i)
+    {
+        const MeshPackageSubmesh& r = submeshes[i];
+        ImportedSubmesh& s = mSubmeshes[i];
+        s.FirstIndex = r.FirstIndex;
+        s.IndexCount = r.IndexCount;
+        s.FirstVertex = r.FirstVertex;
+        s.VertexCount = r.VertexCount;
+        s.Material = r.Material < (int32_t)h.MaterialCount ? r.Material : -1;
+        s.FirstLod = r.FirstLod;
+        s.LodCount = r.LodCount;
+        if (!str(r.NameOffset, r.NameLength, s.Name) ||
+            (uint64_t)r.FirstIndex + r.IndexCount > h.IndexCount ||
+            (uint64_t)r.FirstVertex + r.VertexCount > h.VertexCount ||
+            (uint64_t)r.FirstLod + r.LodCount > h.LodCount)
+        {
+            Close();
+            return false;
+        }
+    }
+
+    const MeshLod* lods = (const MeshLod*)(base + h.LodsOffset);
+    for (uint32_t i = 0; i < h.LodCount; ++i)
+        if ((uint64_t)lods[i].FirstIndex + lods[i].IndexCount > h.LodIndexCount)
+        {
+            Close();
+            return false;
+        }
+
+    // Индексы идут в IB и в выборку по позициям без проверок: каждый должен попадать в вершины
+    // своего submesh, и у LOD тоже. Иначе пакет считается испорченным и OBJ импортируется заново.
+    const uint32_t* indices = (const uint32_t*)(base + h.IndicesOffset);
+    const uint32_t* lodIndices = (const uint32_t*)(base + h.LodIndicesOffset);
+    for (const ImportedSubmesh& s : mSubmeshes)
+    {
+        auto inRange = [&](const uint32_t* first, uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i)
+                if (first[i] - s.FirstVertex >= s.VertexCount) return false;
+            return true;
+        };
+        bool ok = inRange(indices + s.FirstIndex, s.IndexCount);
+        for (uint32_t l = 0; ok && l < s.LodCount; ++l)
+            ok = inRange(lodIndices + lods[s.FirstLod + l].FirstIndex, lods[s.FirstLod + l].IndexCount);
+        if (!ok)
+        {
+            Close();
+            return false;
+        }
+    }
+
+    const MeshPackageMaterial* materials = (const MeshPackageMaterial*)(base + h.MaterialsOffset);
+    mDiffuseTextures.resize(h.MaterialCount);
+    for (uint32_t i = 0; i < h.MaterialCount; ++i)
+        if (!str(materials[i].DiffuseOffset, materials[i].DiffuseLength, mDiffuseTextures[i]))
+        {
+            Close();
+            return false;
+        }
+
+    mSourceHash = sourceHash;
+    mVertices = (const MeshVertex*)(base + h.VerticesOffset);
+    mVertexCount = h.VertexCount;
+    mIndices = (const uint32_t*)(base + h.IndicesOffset);
+    mIndexCount = h.IndexCount;
+    mLodIndices = (const uint32_t*)(base + h.LodIndicesOffset);
+    mLods = lods;
+    return true;
+}
+
+void MeshPackage::Attach(ImportedMesh&& mesh, uint64_t sourceHash)
+{
+    Close();
+    mOwned = std::move(mesh);
+    mSourceHash = sourceHash;
+    mVertices = mOwned.Vertices.data();
+    mVertexCount = mOwned.Vertices.size();
+    mIndices = mOwned.Indices.data();
+    mIndexCount = mOwned.Indices.size();
+    mLodIndices = mOwned.LodIndices.data();
+    mLods = mOwned.Lods.data();
+    mSubmeshes = mOwned.Submeshes;
+    mDiffuseTextures = mOwned.DiffuseTextures;
+}
+
+void MeshPackage::Close()
+{
+    mFile.Close();
+    mOwned = ImportedMesh();
+    mSourceHash = 0;
+    mVertices = nullptr;
+    mVertexCount = 0;
+    mIndices = nullptr;
+    mIndexCount = 0;
+    mLodIndices = nullptr;
+    mLods = nullptr;
+    mSubmeshes.clear();
+    mDiffuseTextures.clear();
+}
+
+MeshSource LoadOrImportMeshPackage(const std::string& objPath, MeshPackage& package,
+    double* parseMs, std::string* error, WorkerPool* workers)
+{
+    if (parseMs) *parseMs = 0.0;
+
+    uint64_t hash = 0;
+    bool hashed = HashFile64(objPath, hash);
+    std::string packagePath = MeshPackagePath(objPath);
+    if (hashed && package.Open(packagePath, hash))
+        return MeshSource::Package;
+
+    ObjModel model;
+    if (!LoadObjModel(objPath, model, error, workers))
+        return MeshSource::Failed;
+    if (parseMs) *parseMs = model.ParseMs;
+
+    ImportedMesh mesh;
+    ImportObjMesh(model, mesh);
+    if (hashed && SaveMeshPackage(packagePath, mesh, hash) && package.Open(packagePath, hash))
+        return MeshSource::Imported;
+
+    package.Attach(std::move(mesh), hash);
+    return MeshSource::Imported;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "ModelImporter.h"
+
+// Бинарный пакет модели рядом с OBJ (<obj>.mesh): результат ImportObjMesh, готовый к загрузке в GPU.
+// Файл отображается в память, VB и IB передаются в CreateDefaultBuffer как есть.
+//
+// Layout (little-endian, секции выровнены по 64 байтам):
+//   MeshPackageHeader
+//   MeshVertex Vertices[VertexCount]
+//   uint32_t Indices[IndexCount]
+//   MeshPackageSubmesh Submeshes[SubmeshCount]
+//   MeshPackageMaterial Materials[MaterialCount]
+//   char Strings[StringsSize]   — имена сабмешей и текстур, без завершающих нулей
+//   uint32_t LodIndices[LodIndexCount]
+//   MeshLod Lods[LodCount]
+
+static const uint32_t kMeshPackageMagic = 0x4B50534D;   // "MSPK"
+static const uint32_t kMeshPackageVersion = 3;          // менять при смене MeshVertex, разбора OBJ или ImportObjMesh
+
+struct MeshPackageHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t SourceHash;       // хэш исходного OBJ
+    uint32_t VertexStride;     // sizeof(MeshVertex) на момент записи
+    uint32_t VertexCount;
+    uint32_t IndexCount;
+    uint32_t SubmeshCount;
+    uint32_t MaterialCount;
+    uint32_t LodIndexCount;
+    uint32_t LodCount;
+    uint32_t Reserved;
+    uint64_t VerticesOffset;
+    uint64_t IndicesOffset;
+    uint64_t SubmeshesOffset;
+    uint64_t MaterialsOffset;
+    uint64_t StringsOffset;
+    uint64_t StringsSize;
+    uint64_t LodIndicesOffset;
+    uint64_t LodsOffset;
+    uint64_t FileSize;
+};
+
+struct MeshPackageSubmesh
+{
+    uint32_t FirstIndex;
+    uint32_t IndexCount;
+    uint32_t FirstVertex;
+    uint32_t VertexCount;
+    int32_t  Material;
+    uint32_t NameOffset;       // в Strings
+    uint32_t NameLength;
+    uint32_t FirstLod;         // в Lods
+    uint32_t LodCount;
+    uint32_t Reserved;
+};
+
+struct MeshPackageMaterial
+{
+    uint32_t DiffuseOffset;    // в Strings
+    uint32_t DiffuseLength;
+};
+
+std::string MeshPackagePath(const std::string& objPath);
+
+bool SaveMeshPackage(const std::string& path, const ImportedMesh& mesh, uint64_t sourceHash);
+
+// Готовая к загрузке геометрия: отображённый пакет или, если его не удалось записать, импорт в памяти.
+// Таблицы сабмешей и материалов маленькие и копируются; VB и IB читаются на месте.
+class MeshPackage
+{
+public:
+    // false, если файла нет, он другой версии, от другого OBJ или повреждён.
+    bool Open(const std::string& path, uint64_t sourceHash);
+    void Attach(ImportedMesh&& mesh, uint64_t sourceHash);
+    void Close();
+
+    bool              IsMapped()    const { return mFile.IsOpen(); }
+    uint64_t          SourceHash()  const { return mSourceHash; }
+    const MeshVertex* Vertices()    const { return mVertices; }
+    size_t            VertexCount() const { return mVertexCount; }
+    const uint32_t*   Indices()     const { return mIndices; }
+    size_t            IndexCount()  const { return mIndexCount; }
+    const uint32_t*   LodIndices()  const { return mLodIndices; }
+    const MeshLod*    Lods()        const { return mLods; }
+
+    const std::vector<ImportedSubmesh>& Submeshes()       const { return mSubmeshes; }
+    const std::vector<std::string>&     DiffuseTextures() const { return mDiffuseTextures; }
+
+private:
+    MappedFile                   mFile;
+    ImportedMesh                 mOwned;
+    uint64_t                     mSourceHash = 0;
+    const MeshVertex*            mVertices = nullptr;
+    size_t                       mVertexCount = 0;
+    const uint32_t*              mIndices = nullptr;
+    size_t                       mIndexCount = 0;
+    const uint32_t*              mLodIndices = nullptr;
+    const MeshLod*               mLods = nullptr;
+    std::vector<ImportedSubmesh> mSubmeshes;
+    std::vector<std::string>     mDiffuseTextures;
+};
+
+enum class MeshSource
+{
+    Package,
+    Imported,
+    Failed,
+};
+
+// Пакет по хэшу objPath; при промахе разбирает OBJ (на workers, если задан), импортирует
+// и перезаписывает пакет. parseMs — время разбора OBJ (0, если пакет подошёл).
+MeshSource LoadOrImportMeshPackage(const std::string& objPath, MeshPackage& package,
+    double* parseMs = nullptr, std::string* error = nullptr, WorkerPool* workers = nullptr);
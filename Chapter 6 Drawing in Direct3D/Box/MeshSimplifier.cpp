@@ -0,0 +1,408 @@
+#include "MeshSimplifier.h"
+#include "BinaryFile.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+    // Уровень, убравший меньше 15% треугольников предыдущего, не стоит отдельного DrawArgs.
+    const float kMinLodStep = 0.85f;
+
+    struct Vec3
+    {
+        double x, y, z;
+    };
+
+    Vec3 operator-(Vec3 a, Vec3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    double Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vec3 Cross(Vec3 a, Vec3 b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+    // Сумма квадратов расстояний до плоскостей граней, взвешенных площадью: p^T A p + 2 b.p + c.
+    // W — суммарная площадь, Q(p) / W — средний квадрат отклонения.
+    struct Quadric
+    {
+        double A00 = 0, A01 = 0, A02 = 0, A11 = 0, A12 = 0, A22 = 0;
+        double B0 = 0, B1 = 0, B2 = 0, C = 0, W = 0;
+
+        void AddPlane(Vec3 n, double d, double weight)
+        {
+            A00 += weight * n.x * n.x; A01 += weight * n.x * n.y; A02 += weight * n.x * n.z;
+            A11 += weight * n.y * n.y; A12 += weight * n.y * n.z; A22 += weight * n.z * n.z;
+            B0 += weight * n.x * d; B1 += weight * n.y * d; B2 += weight * n.z * d;
+            C += weight * d * d;
+            W += weight;
+        }
+
+        void Add(const Quadric& q)
+        {
+            A00 += q.A00; A01 += q.A01; A02 += q.A02; A11 += q.A11; A12 += q.A12; A22 += q.A22;
+            B0 += q.B0; B1 += q.B1; B2 += q.B2; C += q.C; W += q.W;
+        }
+
+        double Evaluate(Vec3 p) const
+        {
+            double r = A00 * p.x * p.x + A11 * p.y * p.y + A22 * p.z * p.z +
+                2.0 * (A01 * p.x * p.y + A02 * p.x * p.z + A12 * p.y * p.z) +
+                2.0 * (B0 * p.x + B1 * p.y + B2 * p.z) + C;
+            return std::max(r, 0.0);
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t From, To;
+        double   Cost;
+    };
+
+    // Locked — граница неподвижна (LOD стыкуется с соседями); Slide — граничная вершина может уйти
+    // в соседа вдоль границы, её отклонение штрафуют плоскости граничных рёбер
+    enum class BorderMode
+    {
+        Locked,
+        Slide,
+    };
+
+    class Simplifier
+    {
+    public:
+        Simplifier(const uint32_t* indices, size_t indexCount,
+            const float* positions, size_t vertexCount, size_t positionStride, BorderMode border = BorderMode::Locked)
+            : mIndices(indices, indices + indexCount), mPositions(positions), mStride(positionStride),
+            mVertexCount(vertexCount), mBorderMode(border), mQuadrics(vertexCount), mLocked(vertexCount, 0),
+            mTouched(vertexCount, 0)
+        {
+            ClassifyVertices();
+            ComputeQuadrics();
+        }
+
+        size_t TriangleCount() const { return mIndices.size() / 3; }
+        const std::vector<uint32_t>& Indices() const { return mIndices; }
+        double MaxCost() const { return mMaxCost; }
+        double Diagonal() const { return mDiagonal; }
+
+        // Один проход: непересекающиеся стягивания по возрастанию цены, пока не дойдём до
+        // targetTriangles или до costLimit. false, если не удалось стянуть ни одного ребра.
+        bool Pass(size_t targetTriangles, double costLimit)
+        {
+            BuildAdjacency();
+            CollectCollapses();
+
+            size_t triangles = TriangleCount();
+            size_t applied = 0;
+            std::fill(mTouched.begin(), mTouched.end(), 0);
+            for (const Collapse& c : mCollapses)
+            {
+                if (triangles <= targetTriangles || c.Cost > costLimit) break;
+                if (mTouched[c.From] || mTouched[c.To] || Flips(c.From, c.To)) continue;
+
+                for (uint32_t k = mAdjacencyOffsets[c.From]; k < mAdjacencyOffsets[c.From + 1]; ++k)
+                {
+                    uint32_t* tri = &mIndices[mAdjacency[k] * 3];
+                    bool hadTo = tri[0] == c.To || tri[1] == c.To || tri[2] == c.To;
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        mTouched[tri[i]] = 1;
+                        if (tri[i] == c.From) tri[i] = c.To;
+                    }
+                    triangles -= hadTo;
+                }
+                mQuadrics[c.To].Add(mQuadrics[c.From]);
+                if (!mBorderQuadrics.empty())
+                    mBorderQuadrics[c.To].Add(mBorderQuadrics[c.From]);
+                mMaxCost = std::max(mMaxCost, c.Cost);
+                ++applied;
+            }
+
+            // Треугольники с двумя одинаковыми вершинами — те, что лежали на стянутых рёбрах
+            size_t write = 0;
+            for (size_t t = 0; t < mIndices.size(); t += 3)
+            {
+                uint32_t a = mIndices[t], b = mIndices[t + 1], c = mIndices[t + 2];
+                if (a == b || b == c || a == c) continue;
+                mIndices[write++] = a;
+                mIndices[write++] = b;
+                mIndices[write++] = c;
+            }
+            mIndices.resize(write);
+            return applied > 0;
+        }
+
+    private:
+        Vec3 Position(uint32_t index) const
+        {
+            const float* p = (const float*)((const uint8_t*)mPositions + (size_t)index * mStride);
+            return { p[0], p[1], p[2] };
+        }
+
+        // Неподвижны: вершины шва (позиция делится с другой вершиной) и концы рёбер,
+        // у которых не ровно две грани (граница или неманифолдность) — по сварке позиций.
+        // В режиме Slide граница подвижна, кроме концов неманифолдных рёбер и вершин, где
+        // сходится не две граничных кромки; сами кромки запоминаются для ComputeQuadrics.
+        void ClassifyVertices()
+        {
+            std::unordered_map<PositionKey, uint32_t, PositionKeyHash> positionIds;
+            std::vector<uint32_t> positionId(mVertexCount), positionUses;
+            for (size_t v = 0; v < mVertexCount; ++v)
+            {
+                PositionKey key;
+                std::memcpy(key.Bits, (const uint8_t*)mPositions + v * mStride, sizeof(key.Bits));
+                auto it = positionIds.emplace(key, (uint32_t)positionUses.size());
+                if (it.second) positionUses.push_back(0);
+                positionId[v] = it.first->second;
+                positionUses[positionId[v]]++;
+            }
+
+            std::unordered_map<uint64_t, uint32_t> edgeFaces;
+            for (size_t t = 0; t < mIndices.size(); t += 3)
+                for (int e = 0; e < 3; ++e)
+                {
+                    uint32_t a = positionId[mIndices[t + e]], b = positionId[mIndices[t + (e + 1) % 3]];
+                    if (a == b) continue;
+                    edgeFaces[a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a]++;
+                }
+
+            std::vector<uint8_t> positionLocked(positionUses.size(), 0);
+            if (mBorderMode == BorderMode::Locked)
+            {
+                for (const auto& e : edgeFaces)
+                    if (e.second != 2)
+                    {
+                        positionLocked[(uint32_t)(e.first >> 32)] = 1;
+                        positionLocked[(uint32_t)e.first] = 1;
+                    }
+            }
+            else
+            {
+                std::vector<uint32_t> borderEdges(positionUses.size(), 0);
+                for (const auto& e : edgeFaces)
+                {
+                    uint32_t a = (uint32_t)(e.first >> 32), b = (uint32_t)e.first;
+                    if (e.second > 2) positionLocked[a] = positionLocked[b] = 1;
+                    if (e.second == 1) { borderEdges[a]++; borderEdges[b]++; }
+                }
+                for (size_t id = 0; id < positionUses.size(); ++id)
+                    positionLocked[id] |= borderEdges[id] != 0 && borderEdges[id] != 2;
+
+                for (size_t t = 0; t < mIndices.size(); t += 3)
+                    for (int e = 0; e < 3; ++e)
+                    {
+                        uint32_t a = positionId[mIndices[t + e]], b = positionId[mIndices[t + (e + 1) % 3]];
+                        if (a != b && edgeFaces[a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a] == 1)
+                            mBorderEdges.push_back({ (uint32_t)t, (uint32_t)e });
+                    }
+            }
+
+            Vec3 lo = { 0, 0, 0 }, hi = { 0, 0, 0 };
+            bool first = true;
+            for (size_t v = 0; v < mVertexCount; ++v)
+            {
+                uint32_t id = positionId[v];
+                mLocked[v] = positionUses[id] > 1 || positionLocked[id];
+
+                Vec3 p = Position((uint32_t)v);
+                lo = first ? p : Vec3{ std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z) };
+                hi = first ? p : Vec3{ std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z) };
+                first = false;
+            }
+            mDiagonal = std::sqrt(Dot(hi - lo, hi - lo));
+        }
+
+        void ComputeQuadrics()
+        {
+            for (size_t t = 0; t < mIndices.size(); t += 3)
+            {
+                Vec3 a = Position(mIndices[t]), b = Position(mIndices[t + 1]), c = Position(mIndices[t + 2]);
+                Vec3 n = Cross(b - a, c - a);
+                double len = std::sqrt(Dot(n, n));
+                if (!(len > 0.0)) continue;
+                n = { n.x / len, n.y / len, n.z / len };
+                double d = -Dot(n, a);
+                for (int i = 0; i < 3; ++i)
+                    mQuadrics[mIndices[t + i]].AddPlane(n, d, len * 0.5);
+            }
+
+            // Плоскость через граничное ребро поперёк грани: её квадрика — квадрат сдвига
+            // границы, без нормировки на площадь
+            mBorderQuadrics.assign(mBorderEdges.empty() ? 0 : mVertexCount, Quadric());
+            for (const auto& edge : mBorderEdges)
+            {
+                const uint32_t* tri = &mIndices[edge.first];
+                uint32_t ia = tri[edge.second], ib = tri[(edge.second + 1) % 3];
+                Vec3 a = Position(tri[0]), b = Position(tri[1]), c = Position(tri[2]);
+                Vec3 faceNormal = Cross(b - a, c - a);
+                Vec3 n = Cross(Position(ib) - Position(ia), faceNormal);
+                double len = std::sqrt(Dot(n, n));
+                if (!(len > 0.0)) continue;
+                n = { n.x / len, n.y / len, n.z / len };
+                double d = -Dot(n, Position(ia));
+                mBorderQuadrics[ia].AddPlane(n, d, 1.0);
+                mBorderQuadrics[ib].AddPlane(n, d, 1.0);
+            }
+        }
+
+        void BuildAdjacency()
+        {
+            mAdjacencyOffsets.assign(mVertexCount + 1, 0);
+            for (uint32_t v : mIndices)
+                mAdjacencyOffsets[v + 1]++;
+            for (size_t v = 0; v < mVertexCount; ++v)
+                mAdjacencyOffsets[v + 1] += mAdjacencyOffsets[v];
+
+            mAdjacency.resize(mIndices.size());
+            mFill.assign(mAdjacencyOffsets.begin(), mAdjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < mIndices.size(); ++i)
+                mAdjacency[mFill[mIndices[i]]++] = (uint32_t)(i / 3);
+        }
+
+        // Каждое ребро в обе стороны, если исходная вершина подвижна; ребро внутри двух
+        // граней встречается дважды, повторы убираются после сортировки.
+        void CollectCollapses()
+        {
+            mCollapses.clear();
+            for (size_t t = 0; t < mIndices.size(); t += 3)
+                for (int e = 0; e < 3; ++e)
+                {
+                    uint32_t a = mIndices[t + e], b = mIndices[t + (e + 1) % 3];
+                    if (!mLocked[a]) mCollapses.push_back({ a, b, Cost(a, b) });
+                    if (!mLocked[b]) mCollapses.push_back({ b, a, Cost(b, a) });
+                }
+
+            std::sort(mCollapses.begin(), mCollapses.end(), [](const Collapse& x, const Collapse& y)
+                {
+                    if (x.Cost != y.Cost) return x.Cost < y.Cost;
+                    return x.From != y.From ? x.From < y.From : x.To < y.To;
+                });
+            mCollapses.erase(std::unique(mCollapses.begin(), mCollapses.end(), [](const Collapse& x, const Collapse& y)
+                {
+                    return x.From == y.From && x.To == y.To;
+                }), mCollapses.end());
+        }
+
+        double Cost(uint32_t from, uint32_t to) const
+        {
+            Quadric q = mQuadrics[from];
+            q.Add(mQuadrics[to]);
+            double cost = q.W > 0.0 ? q.Evaluate(Position(to)) / q.W : 0.0;
+            if (!mBorderQuadrics.empty())
+            {
+                Quadric border = mBorderQuadrics[from];
+                border.Add(mBorderQuadrics[to]);
+                cost += border.Evaluate(Position(to));
+            }
+            return cost;
+        }
+
+        // Грань вокруг from, которая переживёт стягивание, не должна развернуться или выродиться
+        bool Flips(uint32_t from, uint32_t to) const
+        {
+            Vec3 target = Position(to);
+            for (uint32_t k = mAdjacencyOffsets[from]; k < mAdjacencyOffsets[from + 1]; ++k)
+            {
+                const uint32_t* tri = &mIndices[mAdjacency[k] * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to) continue;
+
+                Vec3 p[3], q[3];
+                for (int i = 0; i < 3; ++i)
+                {
+                    p[i] = Position(tri[i]);
+                    q[i] = tri[i] == from ? target : p[i];
+                }
+                Vec3 before = Cross(p[1] - p[0], p[2] - p[0]);
+                Vec3 after = Cross(q[1] - q[0], q[2] - q[0]);
+                if (!(Dot(before, after) > 0.0)) return true;
+            }
+            return false;
+        }
+
+        std::vector<uint32_t> mIndices;
+        const float*          mPositions;
+        size_t                mStride;
+        size_t                mVertexCount;
+        BorderMode            mBorderMode;
+        std::vector<Quadric>  mQuadrics;
+        std::vector<Quadric>  mBorderQuadrics;   // только в режиме Slide
+        std::vector<std::pair<uint32_t, uint32_t>> mBorderEdges;   // первый индекс грани, номер ребра
+        std::vector<uint8_t>  mLocked;
+        std::vector<uint8_t>  mTouched;
+        double                mMaxCost = 0.0;
+        double                mDiagonal = 0.0;
+
+        std::vector<uint32_t> mAdjacencyOffsets;   // треугольники вокруг вершины, CSR
+        std::vector<uint32_t> mAdjacency;
+        std::vector<uint32_t> mFill;
+        std::vector<Collapse> mCollapses;
+    };
+}
+
+uint32_t BuildLodChain(const uint32_t* indices, size_t indexCount,
+    const float* positions, size_t vertexCount, size_t positionStride,
+    std::vector<uint32_t>& lodIndices, std::vector<MeshLod>& lods)
+{
+    if (indexCount / 3 < kMinLodTriangles || vertexCount == 0) return 0;
+
+    Simplifier simplifier(indices, indexCount, positions, vertexCount, positionStride);
+    double maxError = kMaxLodRelativeError * simplifier.Diagonal();
+    double costLimit = maxError * maxError;
+
+    uint32_t added = 0;
+    size_t previous = indexCount / 3;
+    std::vector<uint32_t> level;
+    while (added + 1 < kMaxLodCount)
+    {
+        size_t target = (size_t)((double)previous * kLodReduction);
+        while (simplifier.TriangleCount() > target && simplifier.Pass(target, costLimit)) {}
+
+        size_t triangles = simplifier.TriangleCount();
+        if (triangles == 0 || (double)triangles > (double)previous * kMinLodStep) break;
+
+        level = simplifier.Indices();
+        OptimizeVertexCache(level.data(), level.size(), vertexCount);
+
+        MeshLod lod;
+        lod.FirstIndex = (uint32_t)lodIndices.size();
+        lod.IndexCount = (uint32_t)level.size();
+        lod.Error = (float)std::sqrt(simplifier.MaxCost());
+        lodIndices.insert(lodIndices.end(), level.begin(), level.end());
+        lods.push_back(lod);
+        ++added;
+        previous = triangles;
+    }
+    return added;
+}
+
+void SimplifyKeepingBorder(const uint32_t* indices, size_t indexCount,
+    const float* positions, size_t vertexCount, size_t positionStride, float maxError,
+    std::vector<uint32_t>& simplified)
+{
+    simplified.assign(indices, indices + indexCount);
+    if (indexCount == 0 || vertexCount == 0) return;
+
+    Simplifier simplifier(indices, indexCount, positions, vertexCount, positionStride, BorderMode::Slide);
+    double costLimit = (double)maxError * maxError;
+    while (simplifier.Pass(0, costLimit)) {}
+    simplified = simplifier.Indices();
+}
+
+float LodProjectionScale(float fovY, float viewportHeight)
+{
+    return viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+}
+
+uint32_t SelectLod(const float* errors, uint32_t lodCount, float distance,
+    float projectionScale, float maxPixelError)
+{
+    // Камера внутри AABB сабмеша — всегда полная детализация
+    if (!(distance > 0.0f)) return 0;
+
+    uint32_t lod = 0;
+    for (uint32_t i = 1; i < lodCount; ++i)
+    {
+        if (errors[i] * projectionScale > maxPixelError * distance) break;
+        lod = i;
+    }
+    return lod;
+}
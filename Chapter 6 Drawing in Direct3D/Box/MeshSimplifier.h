@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Цепочка LOD сабмеша: LOD0 — исходные индексы, каждый следующий примерно вдвое меньше
+// по треугольникам. Всего не больше kMaxLodCount уровней, включая LOD0.
+static const uint32_t kMaxLodCount = 4;
+static const float    kLodReduction = 0.5f;
+
+// Сабмеши мельче этого не упрощаются: выигрыш меньше цены лишнего DrawArgs.
+static const uint32_t kMinLodTriangles = 64;
+
+// Предел ошибки упрощения относительно диагонали AABB сабмеша: дальше форма уже разваливается.
+static const float kMaxLodRelativeError = 0.05f;
+
+// Уровень в общем массиве индексов LOD. Error — геометрическая ошибка относительно LOD0
+// в единицах позиций (корень из QEM, нормированной на площадь).
+struct MeshLod
+{
+    uint32_t FirstIndex = 0;
+    uint32_t IndexCount = 0;
+    float    Error = 0.0f;
+};
+
+// QEM (Garland, Heckbert 1997) стягиванием ребра в одну из его вершин: новых вершин нет,
+// LOD рисуется из того же VB, что и LOD0. Вершины на границах и швах атрибутов (у позиции
+// несколько вершин) не двигаются — LOD не рвётся по швам UV и нормалей и стыкуется с соседями.
+// Уровни вложены: LOD k+1 получается продолжением упрощения LOD k, квадрики копят историю,
+// поэтому ошибка уровня считается от исходной поверхности. Порядок треугольников уровня — под
+// post-transform кэш. indices и lodIndices — от positions (xyz float с шагом positionStride).
+// Уровни LOD1.. дописываются в lodIndices и lods; возвращает число добавленных уровней.
+uint32_t BuildLodChain(const uint32_t* indices, size_t indexCount,
+    const float* positions, size_t vertexCount, size_t positionStride,
+    std::vector<uint32_t>& lodIndices, std::vector<MeshLod>& lods);
+
+// Упрощение для окклюдеров: граница не отходит от исходной дальше maxError. Граничная вершина
+// стягивается только в соседа, не уводя кромку (на прямой границе — свободно), остальные — с
+// ошибкой QEM не больше maxError. У плоского куска покрытая область не меняется, поэтому
+// упрощённый окклюдер не закрывает того, чего не закрывал исходный. Индексы — от тех же positions.
+void SimplifyKeepingBorder(const uint32_t* indices, size_t indexCount,
+    const float* positions, size_t vertexCount, size_t positionStride, float maxError,
+    std::vector<uint32_t>& simplified);
+
+// Пикселей на единицу мировой ошибки на расстоянии 1: viewportHeight / (2 tan(fovY / 2)).
+float LodProjectionScale(float fovY, float viewportHeight);
+
+// Самый грубый уровень, ошибка которого на экране не больше maxPixelError.
+// errors[0] — LOD0 (0), дальше по возрастанию; distance — от камеры до ближайшей точки сабмеша.
+uint32_t SelectLod(const float* errors, uint32_t lodCount, float distance,
+    float projectionScale, float maxPixelError);
@@ -0,0 +1,209 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    Vec3 operator-(Vec3 a, Vec3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    Vec3 operator+(Vec3 a, Vec3 b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+    Vec3 operator*(Vec3 a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+    float Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    float Length(Vec3 a) { return std::sqrt(Dot(a, a)); }
+    Vec3 Cross(Vec3 a, Vec3 b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+    // Ниже этого косинуса между осью и нормалью грани конус не отсекает ничего полезного.
+    const float kMinConeDot = 0.1f;
+
+    class MeshletBounds
+    {
+    public:
+        MeshletBounds(const float* positions, size_t stride) : mPositions(positions), mStride(stride) {}
+
+        Vec3 Position(uint32_t index) const
+        {
+            const float* p = (const float*)((const uint8_t*)mPositions + (size_t)index * mStride);
+            return { p[0], p[1], p[2] };
+        }
+
+        // Ritter: диаметр по двум дальним точкам, затем расширение под выпавшие вершины.
+        void Sphere(const std::vector<uint32_t>& vertices, Meshlet& m) const
+        {
+            Vec3 p0 = Position(vertices[0]);
+            Vec3 a = p0, b = p0;
+            float best = -1.0f;
+            for (uint32_t v : vertices)
+            {
+                float d = Dot(Position(v) - p0, Position(v) - p0);
+                if (d > best) { best = d; a = Position(v); }
+            }
+            best = -1.0f;
+            for (uint32_t v : vertices)
+            {
+                float d = Dot(Position(v) - a, Position(v) - a);
+                if (d > best) { best = d; b = Position(v); }
+            }
+
+            Vec3 center = (a + b) * 0.5f;
+            float radius = Length(b - a) * 0.5f;
+            for (uint32_t v : vertices)
+            {
+                Vec3 p = Position(v);
+                float d = Length(p - center);
+                if (d > radius)
+                {
+                    float grown = (radius + d) * 0.5f;
+                    center = center + (p - center) * ((grown - radius) / d);
+                    radius = grown;
+                }
+            }
+            m.Center = { center.x, center.y, center.z };
+            m.Radius = radius;
+        }
+
+        void Cone(const std::vector<uint32_t>& vertices, const uint8_t* triangles, Meshlet& m) const
+        {
+            Vec3 center = { m.Center.x, m.Center.y, m.Center.z };
+            m.ConeApex = m.Center;
+            m.ConeCutoff = 1.0f;
+
+            mNormals.clear();
+            mCorners.clear();
+            Vec3 sum = { 0.0f, 0.0f, 0.0f };
+            for (uint32_t t = 0; t < m.TriangleCount; ++t)
+            {
+                Vec3 a = Position(vertices[triangles[t * 3 + 0]]);
+                Vec3 b = Position(vertices[triangles[t * 3 + 1]]);
+                Vec3 c = Position(vertices[triangles[t * 3 + 2]]);
+                Vec3 n = Cross(b - a, c - a);
+                float len = Length(n);
+                if (!(len > 0.0f)) continue;   // вырожденные грани не видны ни с какой стороны
+                n = n * (1.0f / len);
+                mNormals.push_back(n);
+                mCorners.push_back(a);
+                sum = sum + n;
+            }
+
+            float sumLen = Length(sum);
+            if (mNormals.empty() || !(sumLen > 0.0f)) return;
+            Vec3 axis = sum * (1.0f / sumLen);
+            m.ConeAxis = { axis.x, axis.y, axis.z };
+
+            float minDot = 1.0f;
+            for (const Vec3& n : mNormals)
+                minDot = std::min(minDot, Dot(axis, n));
+            if (minDot <= kMinConeDot) return;
+
+            // Вершина конуса отодвигается вдоль -axis так, чтобы все грани лежали перед ней.
+            float maxT = 0.0f;
+            for (size_t i = 0; i < mNormals.size(); ++i)
+                maxT = std::max(maxT, Dot(center - mCorners[i], mNormals[i]) / Dot(axis, mNormals[i]));
+            Vec3 apex = center - axis * maxT;
+            m.ConeApex = { apex.x, apex.y, apex.z };
+            m.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+
+    private:
+        const float* mPositions;
+        size_t       mStride;
+        mutable std::vector<Vec3> mNormals;
+        mutable std::vector<Vec3> mCorners;
+    };
+}
+
+MeshletRange AppendMeshlets(MeshletSet& set, const float* positions, size_t positionStride,
+    const uint32_t* indices, size_t indexCount, uint32_t baseVertex)
+{
+    MeshletRange range;
+    range.First = (uint32_t)set.Meshlets.size();
+
+    MeshletBounds bounds(positions, positionStride);
+    std::vector<uint32_t> vertices;   // индексы от positions, для границ
+    std::vector<uint8_t>  triangles;
+    vertices.reserve(kMeshletMaxVertices);
+    triangles.reserve(kMeshletMaxTriangles * 3);
+
+    auto flush = [&]()
+        {
+            if (triangles.empty()) return;
+            Meshlet m;
+            m.VertexOffset = (uint32_t)set.Vertices.size();
+            m.TriangleOffset = (uint32_t)set.Triangles.size();
+            m.VertexCount = (uint32_t)vertices.size();
+            m.TriangleCount = (uint32_t)(triangles.size() / 3);
+            bounds.Sphere(vertices, m);
+            bounds.Cone(vertices, triangles.data(), m);
+
+            for (uint32_t v : vertices)
+                set.Vertices.push_back(baseVertex + v);
+            set.Triangles.insert(set.Triangles.end(), triangles.begin(), triangles.end());
+            set.Meshlets.push_back(m);
+            vertices.clear();
+            triangles.clear();
+        };
+
+    auto contains = [&](uint32_t index)
+        {
+            return std::find(vertices.begin(), vertices.end(), index) != vertices.end();
+        };
+
+    for (size_t t = 0; t + 2 < indexCount; t += 3)
+    {
+        const uint32_t* tri = indices + t;
+        uint32_t added = !contains(tri[0]);
+        added += tri[1] != tri[0] && !contains(tri[1]);
+        added += tri[2] != tri[0] && tri[2] != tri[1] && !contains(tri[2]);
+        if (vertices.size() + added > kMeshletMaxVertices || triangles.size() / 3 >= kMeshletMaxTriangles)
+            flush();
+
+        for (int k = 0; k < 3; ++k)
+        {
+            auto it = std::find(vertices.begin(), vertices.end(), tri[k]);
+            if (it == vertices.end())
+            {
+                triangles.push_back((uint8_t)vertices.size());
+                vertices.push_back(tri[k]);
+            }
+            else
+            {
+                triangles.push_back((uint8_t)(it - vertices.begin()));
+            }
+        }
+    }
+    flush();
+
+    range.Count = (uint32_t)set.Meshlets.size() - range.First;
+    return range;
+}
+
+bool MeshletBackfacing(const Meshlet& meshlet, const DirectX::XMFLOAT3& eye)
+{
+    if (meshlet.ConeCutoff >= 1.0f) return false;
+    Vec3 d = { meshlet.ConeApex.x - eye.x, meshlet.ConeApex.y - eye.y, meshlet.ConeApex.z - eye.z };
+    float len = Length(d);
+    if (!(len > 0.0f)) return false;
+    Vec3 axis = { meshlet.ConeAxis.x, meshlet.ConeAxis.y, meshlet.ConeAxis.z };
+    return Dot(d, axis) >= meshlet.ConeCutoff * len;
+}
+
+MeshletStats AnalyzeMeshlets(const MeshletSet& set)
+{
+    MeshletStats stats;
+    stats.Meshlets = set.Meshlets.size();
+    for (const Meshlet& m : set.Meshlets)
+    {
+        stats.Triangles += m.TriangleCount;
+        stats.Vertices += m.VertexCount;
+        stats.OpenCones += m.ConeCutoff >= 1.0f;
+    }
+    if (stats.Meshlets > 0)
+    {
+        stats.VertexFill = (float)stats.Vertices / (float)(stats.Meshlets * kMeshletMaxVertices);
+        stats.TriangleFill = (float)stats.Triangles / (float)(stats.Meshlets * kMeshletMaxTriangles);
+    }
+    return stats;
+}
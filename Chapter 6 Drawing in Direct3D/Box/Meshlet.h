@@ -0,0 +1,61 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Лимиты мешлета, как принято для mesh shader: 64 вершины, 124 треугольника.
+static const uint32_t kMeshletMaxVertices = 64;
+static const uint32_t kMeshletMaxTriangles = 124;
+
+struct Meshlet
+{
+    uint32_t VertexOffset = 0;     // в MeshletSet::Vertices
+    uint32_t TriangleOffset = 0;   // в MeshletSet::Triangles, по 3 локальных индекса на треугольник
+    uint32_t VertexCount = 0;
+    uint32_t TriangleCount = 0;
+
+    // Сфера вокруг вершин мешлета.
+    DirectX::XMFLOAT3 Center = { 0.0f, 0.0f, 0.0f };
+    float             Radius = 0.0f;
+
+    // Конус нормалей граней: мешлет целиком смотрит от камеры, если
+    // dot(normalize(ConeApex - eye), ConeAxis) >= ConeCutoff. ConeCutoff = 1 — конус не отсекает.
+    DirectX::XMFLOAT3 ConeApex = { 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT3 ConeAxis = { 0.0f, 0.0f, 0.0f };
+    float             ConeCutoff = 1.0f;
+};
+
+struct MeshletRange
+{
+    uint32_t First = 0;
+    uint32_t Count = 0;
+};
+
+struct MeshletSet
+{
+    std::vector<Meshlet>  Meshlets;
+    std::vector<uint32_t> Vertices;    // номера вершин общего VB
+    std::vector<uint8_t>  Triangles;   // локальные индексы в пределах мешлета
+};
+
+// Режет сабмеш на мешлеты в порядке индексов: после OptimizeMesh соседние треугольники уже
+// делят вершины, поэтому жадный проход даёт плотные мешлеты и детерминированный результат.
+// positions — xyz float с шагом positionStride, индексы — от positions; в Vertices
+// пишется baseVertex + index. Фронтальная сторона — против часовой стрелки (как в OBJ).
+MeshletRange AppendMeshlets(MeshletSet& set, const float* positions, size_t positionStride,
+    const uint32_t* indices, size_t indexCount, uint32_t baseVertex);
+
+bool MeshletBackfacing(const Meshlet& meshlet, const DirectX::XMFLOAT3& eye);
+
+struct MeshletStats
+{
+    size_t Meshlets = 0;
+    size_t Triangles = 0;
+    size_t Vertices = 0;          // сумма по мешлетам, с повторами на границах
+    float  VertexFill = 0.0f;     // средняя заполненность относительно kMeshletMaxVertices
+    float  TriangleFill = 0.0f;   // относительно kMeshletMaxTriangles
+    size_t OpenCones = 0;         // мешлеты, конус которых ничего не отсекает
+};
+
+MeshletStats AnalyzeMeshlets(const MeshletSet& set);
@@ -0,0 +1,369 @@
+#include "ModelImporter.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+size_t ObjModel::IndexCount() const
+{
+    size_t count = 0;
+    for (const auto& shape : Shapes)
+        count += shape.mesh.indices.size();
+    return count;
+}
+
+bool LoadObjModel(const std::string& path, ObjModel& model, std::string* error, WorkerPool* workers)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::string mtlDir;
+    size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos)
+        mtlDir = path.substr(0, slash);
+
+    std::string warn, err;
+    model.Path = path;
+    bool ok = workers ?
+        ParseObjParallel(path, mtlDir, *workers, model.Attrib, model.Shapes, model.Materials, &err) :
+        tinyobj::LoadObj(&model.Attrib, &model.Shapes, &model.Materials, &warn, &err,
+            path.c_str(), mtlDir.c_str(), true);
+
+    model.ParseMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    if (error) *error = err;
+    return ok;
+}
+
+void WeldObjIndices(const std::vector<tinyobj::index_t>& corners,
+    std::vector<uint32_t>& indices, std::vector<tinyobj::index_t>& vertices)
+{
+    indices.resize(corners.size());
+    vertices.clear();
+    if (corners.empty()) return;
+
+    // Открытая адресация с линейным пробированием, заполнение <= 50%.
+    size_t capacity = 16;
+    while (capacity < corners.size() * 2)
+        capacity *= 2;
+    const size_t mask = capacity - 1;
+    std::vector<uint32_t> slots(capacity, UINT32_MAX);   // индекс в vertices
+
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+        const tinyobj::index_t& c = corners[i];
+        uint64_t h = (uint32_t)c.vertex_index * 0x9E3779B97F4A7C15ull;
+        h ^= (uint32_t)c.normal_index * 0xC2B2AE3D27D4EB4Full + (h >> 29);
+        h ^= (uint32_t)c.texcoord_index * 0x165667B19E3779F9ull + (h >> 32);
+
+        size_t slot = (size_t)h & mask;
+        for (;;)
+        {
+            uint32_t v = slots[slot];
+            if (v == UINT32_MAX)
+            {
+                v = (uint32_t)vertices.size();
+                slots[slot] = v;
+                vertices.push_back(c);
+                indices[i] = v;
+                break;
+            }
+            const tinyobj::index_t& e = vertices[v];
+            if (e.vertex_index == c.vertex_index && e.normal_index == c.normal_index &&
+                e.texcoord_index == c.texcoord_index)
+            {
+                indices[i] = v;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+}
+
+namespace
+{
+    // Один shape: сварка, сборка MeshVertex и OptimizeMesh. Индексы в indices локальные.
+    // Таблицы атрибутов в раскладке attrib_t (3 float на позицию и нормаль, 2 на uv).
+    void BuildShapeVertices(const std::vector<tinyobj::index_t>& corners,
+        const std::vector<tinyobj::real_t>& positions, const std::vector<tinyobj::real_t>& normals,
+        const std::vector<tinyobj::real_t>& texcoords, std::vector<tinyobj::index_t>& welded,
+        std::vector<uint32_t>& indices, std::vector<MeshVertex>& vertices)
+    {
+        WeldObjIndices(corners, indices, welded);
+        vertices.clear();
+        for (const auto& index : welded)
+        {
+            MeshVertex v = {};
+            v.Pos = {
+                positions[3 * index.vertex_index + 0],
+                positions[3 * index.vertex_index + 1],
+                positions[3 * index.vertex_index + 2]
+            };
+            if (index.normal_index >= 0)
+                v.Normal = {
+                    normals[3 * index.normal_index + 0],
+                    normals[3 * index.normal_index + 1],
+                    normals[3 * index.normal_index + 2]
+                };
+            else
+                v.Normal = { 0.0f, 1.0f, 0.0f };
+            if (index.texcoord_index >= 0)
+                v.TexC = {
+                    texcoords[2 * index.texcoord_index + 0],
+                    1.0f - texcoords[2 * index.texcoord_index + 1]
+                };
+            vertices.push_back(v);
+        }
+        OptimizeMesh(indices, vertices, offsetof(MeshVertex, Pos));
+    }
+}
+
+void ImportObjMesh(const ObjModel& model, ImportedMesh& mesh)
+{
+    const tinyobj::attrib_t& attrib = model.Attrib;
+
+    mesh = ImportedMesh();
+    mesh.Vertices.reserve(model.IndexCount() / 2);
+    mesh.Indices.reserve(model.IndexCount());
+    for (const auto& mat : model.Materials)
+        mesh.DiffuseTextures.push_back(mat.diffuse_texname);
+
+    std::vector<uint32_t>          weldedIndices;
+    std::vector<tinyobj::index_t>  weldedVertices;
+    std::vector<MeshVertex>        shapeVertices;
+
+    for (const auto& shape : model.Shapes)
+    {
+        ImportedSubmesh submesh;
+        submesh.Name = shape.name;
+        if (!shape.mesh.material_ids.empty() && shape.mesh.material_ids[0] >= 0 &&
+            shape.mesh.material_ids[0] < (int)model.Materials.size())
+            submesh.Material = shape.mesh.material_ids[0];
+
+        BuildShapeVertices(shape.mesh.indices, attrib.vertices, attrib.normals, attrib.texcoords,
+            weldedVertices, weldedIndices, shapeVertices);
+
+        submesh.FirstIndex = (uint32_t)mesh.Indices.size();
+        submesh.IndexCount = (uint32_t)weldedIndices.size();
+        submesh.FirstVertex = (uint32_t)mesh.Vertices.size();
+        submesh.VertexCount = (uint32_t)shapeVertices.size();
+        for (uint32_t i : weldedIndices)
+            mesh.Indices.push_back(submesh.FirstVertex + i);
+
+        size_t firstLodIndex = mesh.LodIndices.size();
+        submesh.FirstLod = (uint32_t)mesh.Lods.size();
+        submesh.LodCount = BuildLodChain(weldedIndices.data(), weldedIndices.size(), &shapeVertices.data()->Pos.x,
+            shapeVertices.size(), sizeof(MeshVertex), mesh.LodIndices, mesh.Lods);
+        for (size_t i = firstLodIndex; i < mesh.LodIndices.size(); ++i)
+            mesh.LodIndices[i] += submesh.FirstVertex;
+        mesh.Vertices.insert(mesh.Vertices.end(), shapeVertices.begin(), shapeVertices.end());
+        mesh.Submeshes.push_back(submesh);
+    }
+}
+
+namespace
+{
+    // Состояние LoadObjWithCallback: таблицы атрибутов файла и углы текущего shape.
+    // Границы shape и материал сабмеша — как у tinyobj::LoadObj и ImportObjMesh.
+    struct ObjStreamState
+    {
+        const ObjSubmeshCallback* OnSubmesh = nullptr;
+        const ObjMaterialsCallback* OnMaterials = nullptr;
+
+        std::vector<tinyobj::real_t>  Positions, Normals, Texcoords;
+        std::vector<tinyobj::index_t> Corners;      // треугольники текущего shape
+        std::vector<tinyobj::index_t> Face;
+        std::string                   Name;
+        int                           Material = -1;
+        int                           ShapeMaterial = -1;   // материал первой грани shape
+        size_t                        MaterialCount = 0;
+        bool                          BadIndex = false;
+
+        std::vector<tinyobj::index_t> Welded;
+        std::vector<uint32_t>         Indices;
+        std::vector<MeshVertex>       Vertices;
+        ObjStreamStats                Stats;
+
+        void Flush()
+        {
+            if (Corners.empty()) return;
+
+            BuildShapeVertices(Corners, Positions, Normals, Texcoords, Welded, Indices, Vertices);
+
+            ImportedSubmesh submesh;
+            submesh.Name = Name;
+            if (ShapeMaterial >= 0 && (size_t)ShapeMaterial < MaterialCount)
+                submesh.Material = ShapeMaterial;
+            submesh.FirstIndex = (uint32_t)Stats.Indices;
+            submesh.IndexCount = (uint32_t)Indices.size();
+            submesh.FirstVertex = (uint32_t)Stats.Vertices;
+            submesh.VertexCount = (uint32_t)Vertices.size();
+            (*OnSubmesh)(submesh, Vertices, Indices);
+
+            size_t bytes = Corners.capacity() * sizeof(tinyobj::index_t) +
+                Welded.capacity() * sizeof(tinyobj::index_t) + Indices.capacity() * sizeof(uint32_t) +
+                Vertices.capacity() * sizeof(MeshVertex);
+            Stats.PeakSubmeshBytes = std::max(Stats.PeakSubmeshBytes, bytes);
+            Stats.Submeshes++;
+            Stats.Vertices += Vertices.size();
+            Stats.Indices += Indices.size();
+            Corners.clear();
+        }
+
+        // Индекс OBJ в абсолютный с 0: отрицательный — от текущего конца таблицы, 0 — нет атрибута.
+        static int Resolve(int index, size_t count)
+        {
+            return index > 0 ? index - 1 : index < 0 ? (int)count + index : -1;
+        }
+    };
+
+    void StreamVertex(void* user, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z, tinyobj::real_t)
+    {
+        auto& s = *(ObjStreamState*)user;
+        s.Positions.insert(s.Positions.end(), { x, y, z });
+    }
+
+    void StreamNormal(void* user, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z)
+    {
+        auto& s = *(ObjStreamState*)user;
+        s.Normals.insert(s.Normals.end(), { x, y, z });
+    }
+
+    void StreamTexcoord(void* user, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t)
+    {
+        auto& s = *(ObjStreamState*)user;
+        s.Texcoords.insert(s.Texcoords.end(), { x, y });
+    }
+
+    void StreamFace(void* user, tinyobj::index_t* indices, int count)
+    {
+        auto& s = *(ObjStreamState*)user;
+        const size_t vCount = s.Positions.size() / 3;
+        s.Face.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            tinyobj::index_t& c = s.Face[i];
+            c.vertex_index = ObjStreamState::Resolve(indices[i].vertex_index, vCount);
+            c.normal_index = ObjStreamState::Resolve(indices[i].normal_index, s.Normals.size() / 3);
+            c.texcoord_index = ObjStreamState::Resolve(indices[i].texcoord_index, s.Texcoords.size() / 2);
+            // LoadObj отвергает нулевой индекс позиции; ссылки вперёд здесь не дочитать
+            if (c.vertex_index < 0 || (size_t)c.vertex_index >= vCount)
+            {
+                s.BadIndex = true;
+                return;
+            }
+        }
+
+        if (s.Corners.empty())
+            s.ShapeMaterial = s.Material;
+        TriangulateObjFace(s.Face.data(), s.Face.size(), s.Positions, s.Corners);
+    }
+
+    void StreamUseMaterial(void* user, const char*, int materialId)
+    {
+        ((ObjStreamState*)user)->Material = materialId;
+    }
+
+    void StreamMaterials(void* user, const tinyobj::material_t* materials, int count)
+    {
+        auto& s = *(ObjStreamState*)user;
+        s.MaterialCount = (size_t)count;
+        std::vector<std::string> textures;
+        for (int i = 0; i < count; ++i)
+            textures.push_back(materials[i].diffuse_texname);
+        if (*s.OnMaterials) (*s.OnMaterials)(textures);
+    }
+
+    void StreamGroup(void* user, const char** names, int count)
+    {
+        auto& s = *(ObjStreamState*)user;
+        s.Flush();
+        s.Name.clear();
+        for (int i = 0; i < count; ++i)
+            s.Name += (i > 0 ? " " : "") + std::string(names[i]);
+    }
+
+    void StreamObject(void* user, const char* name)
+    {
+        auto& s = *(ObjStreamState*)user;
+        s.Flush();
+        s.Name = name;
+    }
+}
+
+bool StreamObjMesh(const std::string& path, const ObjMaterialsCallback& onMaterials,
+    const ObjSubmeshCallback& onSubmesh, std::string* error, ObjStreamStats* stats)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::ifstream file(path);
+    if (!file)
+    {
+        if (error) *error = "Cannot open file [" + path + "]";
+        return false;
+    }
+
+    std::string mtlDir;
+    size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos)
+        mtlDir = path.substr(0, slash + 1);
+    tinyobj::MaterialFileReader materialReader(mtlDir);
+
+    ObjStreamState state;
+    state.OnSubmesh = &onSubmesh;
+    state.OnMaterials = &onMaterials;
+
+    tinyobj::callback_t callbacks;
+    callbacks.vertex_cb = StreamVertex;
+    callbacks.normal_cb = StreamNormal;
+    callbacks.texcoord_cb = StreamTexcoord;
+    callbacks.index_cb = StreamFace;
+    callbacks.usemtl_cb = StreamUseMaterial;
+    callbacks.mtllib_cb = StreamMaterials;
+    callbacks.group_cb = StreamGroup;
+    callbacks.object_cb = StreamObject;
+
+    std::string warn, err;
+    bool ok = tinyobj::LoadObjWithCallback(file, callbacks, &state, &materialReader, &warn, &err);
+    if (ok && state.BadIndex)
+    {
+        err += "Invalid or forward vertex index in a face.\n";
+        ok = false;
+    }
+    if (ok) state.Flush();
+
+    state.Stats.AttributeBytes = (state.Positions.capacity() + state.Normals.capacity() +
+        state.Texcoords.capacity()) * sizeof(tinyobj::real_t);
+    state.Stats.ParseMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    if (stats) *stats = state.Stats;
+    if (error) *error = err;
+    return ok;
+}
+
+void ExtractCoarsestLod(const MeshVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+    const uint32_t* lodIndices, const MeshLod* lods, uint32_t lodCount,
+    std::vector<DirectX::XMFLOAT3>& positions, std::vector<uint32_t>& proxyIndices)
+{
+    if (lodCount > 0)
+    {
+        indices = lodIndices + lods[lodCount - 1].FirstIndex;
+        indexCount = lods[lodCount - 1].IndexCount;
+    }
+
+    positions.clear();
+    proxyIndices.resize(indexCount);
+    std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t& id = remap[indices[i]];
+        if (id == UINT32_MAX)
+        {
+            id = (uint32_t)positions.size();
+            positions.push_back(vertices[indices[i]].Pos);
+        }
+        proxyIndices[i] = id;
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "MeshSimplifier.h"
+#include "tiny_obj_loader.h"
+
+// Один разбор OBJ (с триангуляцией), общий для текстур, геометрии и производных кэшей.
+struct ObjModel
+{
+    std::string                      Path;
+    tinyobj::attrib_t                Attrib;
+    std::vector<tinyobj::shape_t>    Shapes;
+    std::vector<tinyobj::material_t> Materials;
+    double                           ParseMs = 0.0;
+
+    size_t IndexCount() const;
+};
+
+class WorkerPool;
+
+// .mtl ищется рядом с .obj, как в tinyobj::ObjReader.
+// С workers файл разбирается ParseObjParallel, результат тот же, что у tinyobj::LoadObj.
+bool LoadObjModel(const std::string& path, ObjModel& model, std::string* error = nullptr,
+    WorkerPool* workers = nullptr);
+
+// Сварка вершин: одинаковые тройки (position, normal, texcoord) индексов OBJ становятся одной вершиной.
+// indices — локальные индексы (с 0) для каждого входного угла,
+// vertices — уникальные тройки в порядке первого появления.
+void WeldObjIndices(const std::vector<tinyobj::index_t>& corners,
+    std::vector<uint32_t>& indices, std::vector<tinyobj::index_t>& vertices);
+
+// Вершина геометрии сцены в том виде, в каком она лежит в VB (см. BuildGeometryPassPSO).
+struct MeshVertex
+{
+    DirectX::XMFLOAT3 Pos;
+    DirectX::XMFLOAT3 Normal;
+    DirectX::XMFLOAT2 TexC;
+};
+
+// Один shape OBJ. Индексы абсолютные (BaseVertexLocation = 0), вершины сабмеша лежат подряд.
+struct ImportedSubmesh
+{
+    std::string Name;
+    int32_t     Material = -1;     // индекс в DiffuseTextures, -1 — без материала
+    uint32_t    FirstIndex = 0;
+    uint32_t    IndexCount = 0;
+    uint32_t    FirstVertex = 0;
+    uint32_t    VertexCount = 0;
+    uint32_t    FirstLod = 0;      // LOD1.. в ImportedMesh::Lods; LOD0 — FirstIndex/IndexCount
+    uint32_t    LodCount = 0;
+};
+
+struct ImportedMesh
+{
+    std::vector<MeshVertex>      Vertices;
+    std::vector<uint32_t>        Indices;
+    std::vector<ImportedSubmesh> Submeshes;
+    std::vector<std::string>     DiffuseTextures;   // по материалам OBJ, пустая строка — без текстуры
+    std::vector<uint32_t>        LodIndices;        // абсолютные, как Indices
+    std::vector<MeshLod>         Lods;              // FirstIndex — в LodIndices
+};
+
+// Полная обработка модели перед загрузкой в GPU: сварка вершин по shape, сборка MeshVertex
+// (v текстурных координат переворачивается), OptimizeMesh с перестройкой под overdraw,
+// цепочка LOD (BuildLodChain) поверх тех же вершин.
+void ImportObjMesh(const ObjModel& model, ImportedMesh& mesh);
+
+struct ObjStreamStats
+{
+    size_t Submeshes = 0;
+    size_t Vertices = 0;
+    size_t Indices = 0;
+    size_t AttributeBytes = 0;     // таблицы v/vn/vt файла
+    size_t PeakSubmeshBytes = 0;   // самый большой shape: углы, сварка, вершины и индексы
+    double ParseMs = 0.0;          // весь проход, вместе с обработкой сабмешей
+};
+
+// vertices и indices (локальные, с 0) действительны только на время вызова.
+// FirstVertex/FirstIndex — как если бы все сабмеши лежали подряд, как в ImportObjMesh.
+using ObjSubmeshCallback = std::function<void(const ImportedSubmesh& submesh,
+    const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices)>;
+using ObjMaterialsCallback = std::function<void(const std::vector<std::string>& diffuseTextures)>;
+
+// Потоковый импорт для OBJ, которые не помещаются в память целиком (фотограмметрия).
+// Разбор идёт через tinyobj::LoadObjWithCallback; в памяти — только таблицы атрибутов
+// (индексы OBJ ссылаются на любую прежнюю вершину) и текущий shape. Закрытый shape
+// обрабатывается как в ImportObjMesh и сразу отдаётся в onSubmesh, его память переиспользуется.
+// Пустые shape пропускаются. onMaterials вызывается на каждой mtllib, до граней после неё.
+bool StreamObjMesh(const std::string& path, const ObjMaterialsCallback& onMaterials,
+    const ObjSubmeshCallback& onSubmesh, std::string* error = nullptr, ObjStreamStats* stats = nullptr);
+
+// Потоковый импорт не держит весь файл, поэтому пикинг и окклюдеры строятся по прокси: от каждого
+// сабмеша — самый грубый уровень LOD, пока в сумме не наберётся kStreamPickTriangles треугольников.
+// Дальше сабмеши в прокси не попадают, и его память ограничена этим бюджетом, а не размером файла.
+static const size_t kStreamPickTriangles = 2u << 20;
+
+// Самый грубый уровень сабмеша (LOD0, если цепочки нет) только на тех вершинах, что он использует:
+// positions — их позиции, proxyIndices — от positions. lodIndices — от vertices, как у BuildLodChain.
+void ExtractCoarsestLod(const MeshVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+    const uint32_t* lodIndices, const MeshLod* lods, uint32_t lodCount,
+    std::vector<DirectX::XMFLOAT3>& positions, std::vector<uint32_t>& proxyIndices);
@@ -0,0 +1,734 @@
+// Единственная единица трансляции с реализацией tinyobj: параллельный разбор использует
+// её внутренние функции (parseReal, fixIndex, exportGroupsToShape), чтобы совпадать с ней бит в бит.
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "ObjParser.h"
+#include "MappedFile.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+
+namespace
+{
+    using namespace tinyobj;
+
+    const size_t kMinChunkBytes = 1 << 20;
+    const size_t kChunksPerThread = 4;
+
+    // Индексы угла как в строке файла (atoi): 0 у отсутствующих vt/vn, отрицательные — относительные.
+    struct RawCorner
+    {
+        int V, VT, VN;
+    };
+
+    struct RawFace
+    {
+        uint32_t FirstCorner;
+        uint32_t CornerCount;
+        uint32_t LocalV, LocalVN, LocalVT;   // сколько v/vn/vt было в куске до этой строки
+        uint32_t Smoothing;
+        bool     SmoothingKnown;             // false — группа сглаживания пришла из предыдущих кусков
+    };
+
+    // usemtl, mtllib, g, o: обрабатываются при сборке в исходном порядке.
+    struct StateLine
+    {
+        size_t      FaceIndex;   // число граней куска до этой строки
+        std::string Line;        // от первого непробельного символа, без перевода строки
+    };
+
+    struct Chunk
+    {
+        const char* Begin = nullptr;
+        const char* End = nullptr;
+
+        std::vector<real_t>    V, VertexWeights, VC, VN, VT;
+        std::vector<RawCorner> Corners;
+        std::vector<RawFace>   Faces;
+        std::vector<StateLine> States;
+        bool     HasSmoothing = false;       // последняя группа сглаживания куска — LastSmoothing
+        uint32_t LastSmoothing = 0;
+        bool     Unsupported = false;
+    };
+
+    void ParseRawTriple(const char** token, RawCorner& c)
+    {
+        c.V = atoi(*token);
+        c.VT = 0;
+        c.VN = 0;
+        (*token) += strcspn(*token, "/ \t\r");
+        if ((*token)[0] != '/') return;
+        (*token)++;
+
+        if ((*token)[0] == '/')
+        {
+            (*token)++;
+            c.VN = atoi(*token);
+            (*token) += strcspn(*token, "/ \t\r");
+            return;
+        }
+
+        c.VT = atoi(*token);
+        (*token) += strcspn(*token, "/ \t\r");
+        if ((*token)[0] != '/') return;
+        (*token)++;
+        c.VN = atoi(*token);
+        (*token) += strcspn(*token, "/ \t\r");
+    }
+
+    // Тот же порядок проверок, что в цикле tinyobj::LoadObj; строка завершена нулём.
+    void ParseLine(const char* line, Chunk& c)
+    {
+        const char* token = line + strspn(line, " \t");
+        if (token[0] == '\0' || token[0] == '#') return;
+
+        if (token[0] == 'v' && IS_SPACE(token[1]))
+        {
+            token += 2;
+            real_t x, y, z, r, g, b;
+            parseVertexWithColor(&x, &y, &z, &r, &g, &b, &token);
+            c.V.push_back(x);
+            c.V.push_back(y);
+            c.V.push_back(z);
+            c.VertexWeights.push_back(r);
+            c.VC.push_back(r);   // LoadObj по умолчанию с default_vcols_fallback: цвет есть у всех v
+            c.VC.push_back(g);
+            c.VC.push_back(b);
+            return;
+        }
+        if (token[0] == 'v' && token[1] == 'n' && IS_SPACE(token[2]))
+        {
+            token += 3;
+            real_t x, y, z;
+            parseReal3(&x, &y, &z, &token);
+            c.VN.push_back(x);
+            c.VN.push_back(y);
+            c.VN.push_back(z);
+            return;
+        }
+        if (token[0] == 'v' && token[1] == 't' && IS_SPACE(token[2]))
+        {
+            token += 3;
+            real_t x, y;
+            parseReal2(&x, &y, &token);
+            c.VT.push_back(x);
+            c.VT.push_back(y);
+            return;
+        }
+        if ((token[0] == 'v' && token[1] == 'w' && IS_SPACE(token[2])) ||
+            ((token[0] == 'l' || token[0] == 'p') && IS_SPACE(token[1])))
+        {
+            c.Unsupported = true;
+            return;
+        }
+        if (token[0] == 'f' && IS_SPACE(token[1]))
+        {
+            token += 2;
+            token += strspn(token, " \t");
+
+            RawFace face;
+            face.FirstCorner = (uint32_t)c.Corners.size();
+            face.LocalV = (uint32_t)(c.V.size() / 3);
+            face.LocalVN = (uint32_t)(c.VN.size() / 3);
+            face.LocalVT = (uint32_t)(c.VT.size() / 2);
+            face.Smoothing = c.LastSmoothing;
+            face.SmoothingKnown = c.HasSmoothing;
+            while (!IS_NEW_LINE(token[0]) && token[0] != '#')
+            {
+                RawCorner corner;
+                ParseRawTriple(&token, corner);
+                c.Corners.push_back(corner);
+                token += strspn(token, " \t\r");
+            }
+            face.CornerCount = (uint32_t)c.Corners.size() - face.FirstCorner;
+            c.Faces.push_back(face);
+            return;
+        }
+        if (0 == strncmp(token, "usemtl", 6) ||
+            (0 == strncmp(token, "mtllib", 6) && IS_SPACE(token[6])) ||
+            ((token[0] == 'g' || token[0] == 'o') && IS_SPACE(token[1])))
+        {
+            c.States.push_back({ c.Faces.size(), token });
+            return;
+        }
+        if (token[0] == 't' && IS_SPACE(token[1]))
+        {
+            c.Unsupported = true;
+            return;
+        }
+        if (token[0] == 's' && IS_SPACE(token[1]))
+        {
+            token += 2;
+            token += strspn(token, " \t");
+            if (token[0] == '\0') return;
+            if (token[0] == '\r' || token[1] == '\n') return;
+
+            if (strlen(token) >= 3 && token[0] == 'o' && token[1] == 'f' && token[2] == 'f')
+            {
+                c.LastSmoothing = 0;
+            }
+            else
+            {
+                int id = parseInt(&token);
+                c.LastSmoothing = id < 0 ? 0 : (unsigned int)id;
+            }
+            c.HasSmoothing = true;
+        }
+    }
+
+    // Быстрый путь: строка — string_view в отображённом файле, без копии и завершающего нуля.
+    // Грамматика та же, что у ParseLine; числа читает std::from_chars с точным округлением,
+    // поэтому вещественные значения могут отличаться от tryParseDouble в последнем разряде.
+    class LineCursor
+    {
+    public:
+        explicit LineCursor(std::string_view line) : mPos(line.data()), mEnd(line.data() + line.size()) {}
+
+        // Символ со смещением i; за концом строки — '\0', как у строки tinyobj.
+        char Peek(size_t i = 0) const { return (size_t)(mEnd - mPos) > i ? mPos[i] : '\0'; }
+        bool AtEnd() const { return mPos == mEnd; }
+        void Skip(size_t n) { mPos += std::min(n, (size_t)(mEnd - mPos)); }
+        void SkipSpace()
+        {
+            while (mPos < mEnd && (*mPos == ' ' || *mPos == '\t'))
+                ++mPos;
+        }
+
+        // parseReal: токен до пробела; при ошибке значение не меняется и возвращается false.
+        bool Real(real_t& out)
+        {
+            SkipSpace();
+            const char* end = mPos;
+            while (end < mEnd && *end != ' ' && *end != '\t')
+                ++end;
+
+            // tryParseDouble не знает inf/nan и принимает ведущий '+'
+            const char* first = mPos;
+            if (first < end && (*first == '+' || *first == '-')) ++first;
+            bool ok = first < end && (IS_DIGIT(*first) || *first == '.');
+            if (ok && *mPos == '+') ++mPos;
+
+            // Пустая экспонента ("1e") у tryParseDouble — ошибка, from_chars остановился бы перед 'e'
+            double value = 0.0;
+            if (ok)
+            {
+                std::from_chars_result r = std::from_chars(mPos, end, value);
+                ok = r.ec == std::errc() && (r.ptr == end || (*r.ptr != 'e' && *r.ptr != 'E'));
+            }
+            if (ok) out = (real_t)value;
+            mPos = end;
+            return ok;
+        }
+
+        real_t RealOr(real_t defaultValue)
+        {
+            real_t value = defaultValue;
+            Real(value);
+            return value;
+        }
+
+        // atoi: необязательный знак и цифры; без цифр — 0.
+        int Int()
+        {
+            bool negative = false;
+            if (mPos < mEnd && (*mPos == '+' || *mPos == '-')) negative = *mPos++ == '-';
+            int value = 0;
+            mPos = std::from_chars(mPos, mEnd, value).ptr;
+            return negative ? -value : value;
+        }
+
+        // strcspn по "/ \t\r"
+        void SkipIndexTail()
+        {
+            while (mPos < mEnd && *mPos != '/' && *mPos != ' ' && *mPos != '\t')
+                ++mPos;
+        }
+
+        std::string_view Rest() const { return std::string_view(mPos, (size_t)(mEnd - mPos)); }
+
+    private:
+        const char* mPos;
+        const char* mEnd;
+    };
+
+    void ParseCorner(LineCursor& cur, RawCorner& c)
+    {
+        c.V = cur.Int();
+        c.VT = 0;
+        c.VN = 0;
+        cur.SkipIndexTail();
+        if (cur.Peek() != '/') return;
+        cur.Skip(1);
+
+        if (cur.Peek() == '/')
+        {
+            cur.Skip(1);
+            c.VN = cur.Int();
+            cur.SkipIndexTail();
+            return;
+        }
+
+        c.VT = cur.Int();
+        cur.SkipIndexTail();
+        if (cur.Peek() != '/') return;
+        cur.Skip(1);
+        c.VN = cur.Int();
+        cur.SkipIndexTail();
+    }
+
+    void ParseLineFast(std::string_view line, Chunk& c)
+    {
+        LineCursor cur(line);
+        cur.SkipSpace();
+        const char t0 = cur.Peek(), t1 = cur.Peek(1), t2 = cur.Peek(2);
+        if (t0 == '\0' || t0 == '#') return;
+
+        if (t0 == 'v' && IS_SPACE(t1))
+        {
+            cur.Skip(2);
+            real_t x = cur.RealOr(0.0f), y = cur.RealOr(0.0f), z = cur.RealOr(0.0f);
+            // parseVertexWithColor: w или r g b; неполный цвет считается отсутствующим
+            real_t r = 1.0f, g = 1.0f, b = 1.0f;
+            if (cur.Real(r) && cur.Real(g) && !cur.Real(b))
+                r = g = 1.0f;
+            c.V.push_back(x);
+            c.V.push_back(y);
+            c.V.push_back(z);
+            c.VertexWeights.push_back(r);
+            c.VC.push_back(r);
+            c.VC.push_back(g);
+            c.VC.push_back(b);
+            return;
+        }
+        if (t0 == 'v' && t1 == 'n' && IS_SPACE(t2))
+        {
+            cur.Skip(3);
+            c.VN.push_back(cur.RealOr(0.0f));
+            c.VN.push_back(cur.RealOr(0.0f));
+            c.VN.push_back(cur.RealOr(0.0f));
+            return;
+        }
+        if (t0 == 'v' && t1 == 't' && IS_SPACE(t2))
+        {
+            cur.Skip(3);
+            c.VT.push_back(cur.RealOr(0.0f));
+            c.VT.push_back(cur.RealOr(0.0f));
+            return;
+        }
+        if ((t0 == 'v' && t1 == 'w' && IS_SPACE(t2)) || ((t0 == 'l' || t0 == 'p') && IS_SPACE(t1)))
+        {
+            c.Unsupported = true;
+            return;
+        }
+        if (t0 == 'f' && IS_SPACE(t1))
+        {
+            cur.Skip(2);
+            cur.SkipSpace();
+
+            RawFace face;
+            face.FirstCorner = (uint32_t)c.Corners.size();
+            face.LocalV = (uint32_t)(c.V.size() / 3);
+            face.LocalVN = (uint32_t)(c.VN.size() / 3);
+            face.LocalVT = (uint32_t)(c.VT.size() / 2);
+            face.Smoothing = c.LastSmoothing;
+            face.SmoothingKnown = c.HasSmoothing;
+            while (cur.Peek() != '\0' && cur.Peek() != '#')
+            {
+                RawCorner corner;
+                ParseCorner(cur, corner);
+                c.Corners.push_back(corner);
+                cur.SkipSpace();
+            }
+            face.CornerCount = (uint32_t)c.Corners.size() - face.FirstCorner;
+            c.Faces.push_back(face);
+            return;
+        }
+
+        // Редкие строки смены состояния разбираются общим кодом при сборке
+        std::string_view rest = cur.Rest();
+        if (rest.compare(0, 6, "usemtl") == 0 || (rest.compare(0, 6, "mtllib") == 0 && IS_SPACE(cur.Peek(6))) ||
+            ((t0 == 'g' || t0 == 'o') && IS_SPACE(t1)))
+        {
+            c.States.push_back({ c.Faces.size(), std::string(rest) });
+            return;
+        }
+        if (t0 == 't' && IS_SPACE(t1))
+        {
+            c.Unsupported = true;
+            return;
+        }
+        if (t0 == 's' && IS_SPACE(t1))
+        {
+            cur.Skip(2);
+            cur.SkipSpace();
+            if (cur.AtEnd()) return;
+
+            if (cur.Rest().compare(0, 3, "off") == 0)
+            {
+                c.LastSmoothing = 0;
+            }
+            else
+            {
+                int id = cur.Int();
+                c.LastSmoothing = id < 0 ? 0 : (unsigned int)id;
+            }
+            c.HasSmoothing = true;
+        }
+    }
+
+    // Строки как у safeGetline: конец — \n, \r\n или одиночный \r.
+    void ParseChunk(Chunk& c, bool firstChunk, ObjTokenizer tokenizer)
+    {
+        std::string line;
+        const char* p = c.Begin;
+        bool firstLine = firstChunk;
+        while (p < c.End)
+        {
+            const char* e = p;
+            while (e < c.End && *e != '\n' && *e != '\r')
+                ++e;
+            std::string_view view(p, (size_t)(e - p));
+            p = e;
+            if (p < c.End && *p == '\r') ++p;
+            if (p < c.End && *p == '\n' && (p == e || *e == '\r')) ++p;
+
+            // BOM снимается только с первой строки файла, даже если она пустая
+            bool bom = firstLine;
+            firstLine = false;
+            if (view.empty()) continue;
+            if (bom && view.size() >= 3 && view.compare(0, 3, "\xEF\xBB\xBF") == 0) view.remove_prefix(3);
+
+            if (tokenizer == ObjTokenizer::FromChars)
+            {
+                ParseLineFast(view, c);
+            }
+            else
+            {
+                line.assign(view.data(), view.size());
+                ParseLine(line.c_str(), c);
+            }
+            if (c.Unsupported) return;
+        }
+    }
+
+    // Сборка shape по правилам tinyobj::LoadObj; треугольники копируются напрямую,
+    // прочие многоугольники идут через exportGroupsToShape по одной грани.
+    class ShapeBuilder
+    {
+    public:
+        ShapeBuilder(const std::string& mtlBaseDir, std::vector<shape_t>& shapes,
+            std::vector<material_t>& materials, const std::vector<real_t>& v)
+            : mReader(mtlBaseDir), mShapes(shapes), mMaterials(materials), mV(v)
+        {
+            mScratch.faceGroup.resize(1);
+        }
+
+        void Face(const face_t& face)
+        {
+            const std::vector<vertex_index_t>& vi = face.vertex_indices;
+            mGroupHasFaces = true;
+            mShape.name = mName;
+            if (vi.size() == 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                    mShape.mesh.indices.push_back({ vi[k].v_idx, vi[k].vn_idx, vi[k].vt_idx });
+                mShape.mesh.num_face_vertices.push_back(3);
+                mShape.mesh.material_ids.push_back(mMaterial);
+                mShape.mesh.smoothing_group_ids.push_back(face.smoothing_group_id);
+                return;
+            }
+            if (vi.size() < 3) return;
+
+            std::string warn;
+            mScratch.faceGroup[0] = face;
+            exportGroupsToShape(&mShape, mScratch, mTags, mMaterial, mName, true, mV, &warn);
+        }
+
+        void State(const char* token, std::string* error)
+        {
+            if (0 == strncmp(token, "usemtl", 6))
+            {
+                token += 6;
+                std::string name = parseString(&token);
+                auto it = mMaterialMap.find(name);
+                int id = it != mMaterialMap.end() ? it->second : -1;
+                if (id != mMaterial)
+                {
+                    mGroupHasFaces = false;
+                    mMaterial = id;
+                }
+                return;
+            }
+
+            if (0 == strncmp(token, "mtllib", 6) && IS_SPACE(token[6]))
+            {
+                token += 7;
+                std::vector<std::string> filenames;
+                SplitString(std::string(token), ' ', '\\', filenames);
+                for (const std::string& f : filenames)
+                {
+                    if (mMaterialFiles.count(f) > 0) continue;
+                    std::string warn, err;
+                    bool ok = mReader(f.c_str(), &mMaterials, &mMaterialMap, &warn, &err);
+                    if (error) *error += err;
+                    if (ok)
+                    {
+                        mMaterialFiles.insert(f);
+                        break;
+                    }
+                }
+                return;
+            }
+
+            if (token[0] == 'g')
+            {
+                Flush();
+                std::vector<std::string> names;
+                while (!IS_NEW_LINE(token[0]) && token[0] != '#')
+                {
+                    names.push_back(parseString(&token));
+                    token += strspn(token, " \t\r");
+                }
+                mName.clear();
+                for (size_t i = 1; i < names.size(); ++i)
+                    mName += (i > 1 ? " " : "") + names[i];
+                return;
+            }
+
+            // 'o'
+            Flush();
+            mName = token + 2;
+        }
+
+        void Finish()
+        {
+            if (mGroupHasFaces || !mShape.mesh.indices.empty())
+                mShapes.push_back(std::move(mShape));
+            mShape = shape_t();
+        }
+
+    private:
+        void Flush()
+        {
+            if (!mShape.mesh.indices.empty())
+                mShapes.push_back(std::move(mShape));
+            mShape = shape_t();
+            mGroupHasFaces = false;
+        }
+
+        MaterialFileReader         mReader;
+        std::vector<shape_t>&      mShapes;
+        std::vector<material_t>&   mMaterials;
+        const std::vector<real_t>& mV;
+        std::map<std::string, int> mMaterialMap;
+        std::set<std::string>      mMaterialFiles;
+        std::vector<tag_t>         mTags;
+        PrimGroup                  mScratch;
+        shape_t                    mShape;
+        std::string                mName;
+        int                        mMaterial = -1;
+        bool                       mGroupHasFaces = false;
+    };
+
+    double MsSince(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+bool ParseObjParallel(const std::string& path, const std::string& mtlBaseDir, WorkerPool& workers,
+    tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes,
+    std::vector<tinyobj::material_t>& materials, std::string* error, ObjParseStats* stats,
+    ObjTokenizer tokenizer)
+{
+    ObjParseStats localStats;
+    ObjParseStats& st = stats ? *stats : localStats;
+    st = ObjParseStats();
+
+    auto fallback = [&]() {
+        st.Fallback = true;
+        auto start = std::chrono::high_resolution_clock::now();
+        std::string warn, err;
+        bool ok = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err,
+            path.c_str(), mtlBaseDir.c_str(), true);
+        st.BuildMs = MsSince(start);
+        if (error) *error = err;
+        return ok;
+    };
+
+    MappedFile file;
+    if (!file.Open(path)) return fallback();
+    st.Bytes = file.Size();
+
+    // Куски режутся сразу после конца строки, пара \r\n не делится.
+    const char* data = (const char*)file.Data();
+    const char* end = data + file.Size();
+    size_t target = std::max<size_t>(1, std::min<size_t>(
+        file.Size() / kMinChunkBytes, (workers.ThreadCount() + 1) * kChunksPerThread));
+    std::vector<Chunk> chunks;
+    const char* begin = data;
+    for (size_t i = 1; i <= target && begin < end; ++i)
+    {
+        const char* split = i == target ? end : data + file.Size() / target * i;
+        if (split <= begin) split = begin + 1;
+        while (split < end && split[-1] != '\n' && !(split[-1] == '\r' && split[0] != '\n'))
+            ++split;
+        if (split == begin) continue;
+        chunks.emplace_back();
+        chunks.back().Begin = begin;
+        chunks.back().End = split;
+        begin = split;
+    }
+    st.Chunks = chunks.size();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    workers.ParallelFor(chunks.size(), 1, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i)
+            ParseChunk(chunks[i], i == 0, tokenizer);
+    });
+    st.ParseMs = MsSince(start);
+    for (const Chunk& c : chunks)
+        if (c.Unsupported) return fallback();
+
+    // Prefix sums по числу атрибутов: смещение каждого куска в общих массивах.
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<size_t> vOffset(chunks.size() + 1, 0), vnOffset(chunks.size() + 1, 0), vtOffset(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        vOffset[i + 1] = vOffset[i] + chunks[i].V.size() / 3;
+        vnOffset[i + 1] = vnOffset[i] + chunks[i].VN.size() / 3;
+        vtOffset[i + 1] = vtOffset[i] + chunks[i].VT.size() / 2;
+    }
+
+    attrib = attrib_t();
+    attrib.vertices.resize(vOffset.back() * 3);
+    attrib.vertex_weights.resize(vOffset.back());
+    attrib.colors.resize(vOffset.back() * 3);
+    attrib.normals.resize(vnOffset.back() * 3);
+    attrib.texcoords.resize(vtOffset.back() * 2);
+    workers.ParallelFor(chunks.size(), 1, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i)
+        {
+            const Chunk& c = chunks[i];
+            std::copy(c.V.begin(), c.V.end(), attrib.vertices.begin() + vOffset[i] * 3);
+            std::copy(c.VertexWeights.begin(), c.VertexWeights.end(), attrib.vertex_weights.begin() + vOffset[i]);
+            std::copy(c.VC.begin(), c.VC.end(), attrib.colors.begin() + vOffset[i] * 3);
+            std::copy(c.VN.begin(), c.VN.end(), attrib.normals.begin() + vnOffset[i] * 3);
+            std::copy(c.VT.begin(), c.VT.end(), attrib.texcoords.begin() + vtOffset[i] * 2);
+        }
+    });
+    st.MergeMs = MsSince(start);
+
+    // Последовательная сборка: индексы переводятся в абсолютные по смещениям кусков.
+    start = std::chrono::high_resolution_clock::now();
+    shapes.clear();
+    materials.clear();
+    // Каталог .mtl дополняется разделителем, как в tinyobj::LoadObj
+    std::string baseDir = mtlBaseDir;
+#ifdef _WIN32
+    const char dirsep = '\\';
+#else
+    const char dirsep = '/';
+#endif
+    if (!baseDir.empty() && baseDir.back() != dirsep) baseDir += dirsep;
+
+    std::string err;
+    ShapeBuilder builder(baseDir, shapes, materials, attrib.vertices);
+
+    warning_context context = { nullptr, 0 };
+    face_t face;
+    uint32_t smoothing = 0;
+    for (size_t ci = 0; ci < chunks.size(); ++ci)
+    {
+        const Chunk& c = chunks[ci];
+        size_t state = 0;
+        for (size_t fi = 0; fi <= c.Faces.size(); ++fi)
+        {
+            for (; state < c.States.size() && c.States[state].FaceIndex == fi; ++state)
+                builder.State(c.States[state].Line.c_str(), &err);
+            if (fi == c.Faces.size()) break;
+
+            const RawFace& raw = c.Faces[fi];
+            const int vCount = (int)(vOffset[ci] + raw.LocalV);
+            const int vnCount = (int)(vnOffset[ci] + raw.LocalVN);
+            const int vtCount = (int)(vtOffset[ci] + raw.LocalVT);
+
+            face.smoothing_group_id = raw.SmoothingKnown ? raw.Smoothing : smoothing;
+            face.vertex_indices.resize(raw.CornerCount);
+            for (uint32_t k = 0; k < raw.CornerCount; ++k)
+            {
+                const RawCorner& rc = c.Corners[raw.FirstCorner + k];
+                vertex_index_t& vi = face.vertex_indices[k];
+                // Ошибки индексов и ссылки на ещё не объявленные вершины — на tinyobj целиком.
+                if (!fixIndex(rc.V, vCount, &vi.v_idx, false, context) ||
+                    !fixIndex(rc.VN, vnCount, &vi.vn_idx, true, context) ||
+                    !fixIndex(rc.VT, vtCount, &vi.vt_idx, true, context) ||
+                    vi.v_idx >= vCount)
+                {
+                    shapes.clear();
+                    materials.clear();
+                    return fallback();
+                }
+            }
+            builder.Face(face);
+        }
+        if (c.HasSmoothing) smoothing = c.LastSmoothing;
+    }
+    builder.Finish();
+    st.BuildMs = MsSince(start);
+
+    if (error) *error = err;
+    return true;
+}
+
+ObjTokenStats TokenizeObj(const char* data, size_t size, ObjTokenizer tokenizer, std::vector<tinyobj::real_t>* reals)
+{
+    Chunk c;
+    c.Begin = data;
+    c.End = data + size;
+    ParseChunk(c, true, tokenizer);
+
+    ObjTokenStats stats;
+    stats.Reals = c.V.size() + c.VN.size() + c.VT.size();
+    stats.Faces = c.Faces.size();
+    stats.Corners = c.Corners.size();
+    stats.IndexHash = HashBytes64(c.Corners.data(), c.Corners.size() * sizeof(RawCorner));
+    stats.Unsupported = c.Unsupported;
+    if (reals)
+    {
+        reals->insert(reals->end(), c.V.begin(), c.V.end());
+        reals->insert(reals->end(), c.VN.begin(), c.VN.end());
+        reals->insert(reals->end(), c.VT.begin(), c.VT.end());
+    }
+    return stats;
+}
+
+void TriangulateObjFace(const tinyobj::index_t* corners, size_t count,
+    const std::vector<tinyobj::real_t>& positions, std::vector<tinyobj::index_t>& triangles)
+{
+    if (count < 3) return;
+    if (count == 3)
+    {
+        triangles.insert(triangles.end(), corners, corners + 3);
+        return;
+    }
+
+    PrimGroup group;
+    group.faceGroup.resize(1);
+    face_t& face = group.faceGroup[0];
+    face.vertex_indices.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        face.vertex_indices[i].v_idx = corners[i].vertex_index;
+        face.vertex_indices[i].vn_idx = corners[i].normal_index;
+        face.vertex_indices[i].vt_idx = corners[i].texcoord_index;
+    }
+
+    shape_t shape;
+    std::vector<tag_t> tags;
+    std::string warn;
+    exportGroupsToShape(&shape, group, tags, -1, std::string(), true, positions, &warn);
+    triangles.insert(triangles.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
+}
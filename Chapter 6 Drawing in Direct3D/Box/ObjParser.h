@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "tiny_obj_loader.h"
+
+class WorkerPool;
+
+enum class ObjTokenizer
+{
+    TinyObj,     // строка копируется и читается parseReal/atoi tinyobj: результат бит в бит как у LoadObj
+    FromChars,   // string_view по отображённому файлу и std::from_chars, без выделений памяти на строку
+};
+
+struct ObjParseStats
+{
+    size_t Bytes = 0;
+    size_t Chunks = 0;
+    bool   Fallback = false;   // файл разобран tinyobj::LoadObj целиком
+    double ParseMs = 0.0;      // разбор кусков на пуле
+    double MergeMs = 0.0;      // prefix sums и склейка атрибутов
+    double BuildMs = 0.0;      // последовательная сборка shape и материалов
+};
+
+// Многопоточный разбор OBJ. Файл отображается в память и режется на куски по границам строк;
+// v/vn/vt/f и смена состояния разбираются в кусках параллельно, атрибуты склеиваются по prefix sums,
+// затем shape собираются одним проходом по кускам в исходном порядке.
+//
+// С ObjTokenizer::TinyObj результат совпадает с tinyobj::LoadObj(..., triangulate = true): числа и индексы
+// разбираются теми же функциями tinyobj, многоугольники триангулируются её же exportGroupsToShape.
+// С FromChars индексы и shape те же, а вещественные числа округлены точно и могут отличаться
+// от tinyobj в последнем разряде. Редкие конструкции (l, p, t, vw, индексы вперёд или вне диапазона,
+// ошибки разбора) отдаются tinyobj::LoadObj целиком. mtlBaseDir — как у tinyobj::LoadObj.
+bool ParseObjParallel(const std::string& path, const std::string& mtlBaseDir, WorkerPool& workers,
+    tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes,
+    std::vector<tinyobj::material_t>& materials, std::string* error = nullptr,
+    ObjParseStats* stats = nullptr, ObjTokenizer tokenizer = ObjTokenizer::FromChars);
+
+struct ObjTokenStats
+{
+    size_t   Reals = 0;         // значений v/vn/vt
+    size_t   Faces = 0;
+    size_t   Corners = 0;
+    uint64_t IndexHash = 0;     // по сырым индексам углов, для сравнения токенизаторов
+    bool     Unsupported = false;
+};
+
+// Только токенизация буфера в вызывающем потоке, без сборки shape (для бенчмарков).
+// reals, если задан, получает значения v, затем vn, затем vt.
+ObjTokenStats TokenizeObj(const char* data, size_t size, ObjTokenizer tokenizer,
+    std::vector<tinyobj::real_t>* reals = nullptr);
+
+// Триангуляция одной грани так же, как в tinyobj::LoadObj: квад — по короткой диагонали,
+// многоугольник — ear clipping по positions. corners — абсолютные индексы с 0;
+// треугольники дописываются в triangles. Грани меньше чем из трёх углов пропускаются.
+void TriangulateObjFace(const tinyobj::index_t* corners, size_t count,
+    const std::vector<tinyobj::real_t>& positions, std::vector<tinyobj::index_t>& triangles);
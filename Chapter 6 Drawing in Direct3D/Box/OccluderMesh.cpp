@@ -0,0 +1,337 @@
+#include "OccluderMesh.h"
+#include "BinaryFile.h"
+#include "MappedFile.h"
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+using namespace DirectX;
+
+namespace
+{
+    struct Vec3
+    {
+        double x, y, z;
+    };
+
+    Vec3 operator-(Vec3 a, Vec3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    double Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vec3 Cross(Vec3 a, Vec3 b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    double Length(Vec3 a) { return std::sqrt(Dot(a, a)); }
+    Vec3 ToVec(const XMFLOAT3& p) { return { p.x, p.y, p.z }; }
+
+    struct EdgeFaces
+    {
+        uint32_t Face[2] = { UINT32_MAX, UINT32_MAX };
+        uint32_t Count = 0;
+    };
+
+    uint64_t EdgeKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+    }
+
+    // Упрощённый кусок: собственные вершины, индексы от них
+    struct Patch
+    {
+        size_t                Order = 0;   // порядок появления — порядок в итоговом меше
+        std::vector<XMFLOAT3> Positions;
+        std::vector<uint32_t> Indices;
+        size_t                SourceTriangles = 0;
+        double                Area = 0.0;
+    };
+
+    class SubmeshPatches
+    {
+    public:
+        SubmeshPatches(const ImportedMesh& mesh, const ImportedSubmesh& s)
+        {
+            // Сварка по позиции: швы UV и нормалей окклюдеру не нужны
+            std::unordered_map<PositionKey, uint32_t, PositionKeyHash> ids;
+            std::vector<uint32_t> welded(s.VertexCount);
+            for (uint32_t v = 0; v < s.VertexCount; ++v)
+            {
+                PositionKey key;
+                std::memcpy(key.Bits, &mesh.Vertices[s.FirstVertex + v].Pos, sizeof(key.Bits));
+                auto it = ids.emplace(key, (uint32_t)mPositions.size());
+                if (it.second) mPositions.push_back(mesh.Vertices[s.FirstVertex + v].Pos);
+                welded[v] = it.first->second;
+            }
+
+            for (uint32_t i = 0; i < s.IndexCount; i += 3)
+            {
+                uint32_t t[3];
+                for (int k = 0; k < 3; ++k)
+                    t[k] = welded[mesh.Indices[s.FirstIndex + i + k] - s.FirstVertex];
+                if (t[0] == t[1] || t[1] == t[2] || t[0] == t[2]) continue;
+                Vec3 a = ToVec(mPositions[t[0]]);
+                Vec3 n = Cross(ToVec(mPositions[t[1]]) - a, ToVec(mPositions[t[2]]) - a);
+                double len = Length(n);
+                if (!(len > 0.0)) continue;
+                mTris.insert(mTris.end(), t, t + 3);
+                mNormals.push_back({ n.x / len, n.y / len, n.z / len });
+                mAreas.push_back(0.5 * len);
+            }
+
+            for (uint32_t f = 0; f < TriangleCount(); ++f)
+                for (int e = 0; e < 3; ++e)
+                {
+                    EdgeFaces& edge = mEdges[EdgeKey(mTris[3 * f + e], mTris[3 * f + (e + 1) % 3])];
+                    if (edge.Count < 2) edge.Face[edge.Count] = f;
+                    edge.Count++;
+                }
+        }
+
+        uint32_t TriangleCount() const { return (uint32_t)mAreas.size(); }
+
+        double Area() const
+        {
+            double area = 0.0;
+            for (double a : mAreas) area += a;
+            return area;
+        }
+
+        // Куски растут от первого свободного треугольника через манифолдные рёбра
+        template <typename OnPatch>
+        void Segment(double planeTolerance, OnPatch onPatch) const
+        {
+            std::vector<uint32_t> patchOf(TriangleCount(), UINT32_MAX);
+            std::vector<uint32_t> faces, queue;
+            uint32_t patchId = 0;
+            for (uint32_t seed = 0; seed < TriangleCount(); ++seed)
+            {
+                if (patchOf[seed] != UINT32_MAX) continue;
+                const Vec3 n = mNormals[seed];
+                const double d = -Dot(n, ToVec(mPositions[mTris[3 * seed]]));
+
+                faces.clear();
+                queue.assign(1, seed);
+                patchOf[seed] = patchId;
+                while (!queue.empty())
+                {
+                    uint32_t f = queue.back();
+                    queue.pop_back();
+                    faces.push_back(f);
+                    for (int e = 0; e < 3; ++e)
+                    {
+                        const EdgeFaces& edge = mEdges.at(EdgeKey(mTris[3 * f + e], mTris[3 * f + (e + 1) % 3]));
+                        if (edge.Count != 2) continue;
+                        uint32_t g = edge.Face[0] == f ? edge.Face[1] : edge.Face[0];
+                        if (patchOf[g] != UINT32_MAX || Dot(mNormals[g], n) < kOccluderPlanarCos) continue;
+                        bool onPlane = true;
+                        for (int k = 0; k < 3; ++k)
+                            onPlane = onPlane && std::fabs(Dot(n, ToVec(mPositions[mTris[3 * g + k]])) + d) <= planeTolerance;
+                        if (!onPlane) continue;
+                        patchOf[g] = patchId;
+                        queue.push_back(g);
+                    }
+                }
+
+                // Периметр — рёбра, за которыми нет грани этого же куска
+                std::sort(faces.begin(), faces.end());
+                double area = 0.0, perimeter = 0.0;
+                for (uint32_t f : faces)
+                {
+                    area += mAreas[f];
+                    for (int e = 0; e < 3; ++e)
+                    {
+                        uint32_t a = mTris[3 * f + e], b = mTris[3 * f + (e + 1) % 3];
+                        const EdgeFaces& edge = mEdges.at(EdgeKey(a, b));
+                        bool inner = edge.Count == 2 && patchOf[edge.Face[0]] == patchId && patchOf[edge.Face[1]] == patchId;
+                        if (!inner) perimeter += Length(ToVec(mPositions[a]) - ToVec(mPositions[b]));
+                    }
+                }
+                onPatch(faces, area, perimeter);
+                ++patchId;
+            }
+        }
+
+        // Треугольники куска с собственными вершинами, упрощённые без сдвига границы
+        void Simplify(const std::vector<uint32_t>& faces, float maxError, Patch& patch) const
+        {
+            std::vector<uint32_t> remap(mPositions.size(), UINT32_MAX), indices;
+            std::vector<XMFLOAT3> positions;
+            for (uint32_t f : faces)
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t v = mTris[3 * f + k];
+                    if (remap[v] == UINT32_MAX)
+                    {
+                        remap[v] = (uint32_t)positions.size();
+                        positions.push_back(mPositions[v]);
+                    }
+                    indices.push_back(remap[v]);
+                }
+
+            std::vector<uint32_t> simplified;
+            SimplifyKeepingBorder(indices.data(), indices.size(), &positions.data()->x, positions.size(),
+                sizeof(XMFLOAT3), maxError, simplified);
+
+            std::fill(remap.begin(), remap.begin() + positions.size(), UINT32_MAX);
+            patch.Positions.clear();
+            patch.Indices.clear();
+            for (uint32_t v : simplified)
+            {
+                if (remap[v] == UINT32_MAX)
+                {
+                    remap[v] = (uint32_t)patch.Positions.size();
+                    patch.Positions.push_back(positions[v]);
+                }
+                patch.Indices.push_back(remap[v]);
+            }
+            patch.SourceTriangles = faces.size();
+        }
+
+    private:
+        std::vector<XMFLOAT3> mPositions;   // сваренные
+        std::vector<uint32_t> mTris;
+        std::vector<Vec3>     mNormals;
+        std::vector<double>   mAreas;
+        std::unordered_map<uint64_t, EdgeFaces> mEdges;
+    };
+}
+
+std::vector<uint8_t> MaskedMaterials(const std::vector<tinyobj::material_t>& materials)
+{
+    std::vector<uint8_t> masked(materials.size(), 0);
+    for (size_t m = 0; m < materials.size(); ++m)
+        masked[m] = !materials[m].alpha_texname.empty() || materials[m].dissolve < 1.0f;
+    return masked;
+}
+
+void BuildOccluderMesh(const ImportedMesh& mesh, const std::vector<uint8_t>& masked, size_t maxTriangles,
+    OccluderSet& out, OccluderBuildStats* stats)
+{
+    OccluderBuildStats st;
+    out.Positions.clear();
+    out.Indices.clear();
+    if (mesh.Vertices.empty())
+    {
+        if (stats) *stats = st;
+        return;
+    }
+
+    Vec3 lo = ToVec(mesh.Vertices[0].Pos), hi = lo;
+    for (const MeshVertex& v : mesh.Vertices)
+    {
+        lo = { std::min(lo.x, (double)v.Pos.x), std::min(lo.y, (double)v.Pos.y), std::min(lo.z, (double)v.Pos.z) };
+        hi = { std::max(hi.x, (double)v.Pos.x), std::max(hi.y, (double)v.Pos.y), std::max(hi.z, (double)v.Pos.z) };
+    }
+    const double diagonal = Length(hi - lo);
+    const double planeTolerance = kOccluderPlaneTolerance * diagonal;
+    const double minArea = kOccluderMinAreaFraction * diagonal * diagonal;
+
+    std::vector<Patch> candidates;
+    for (const ImportedSubmesh& s : mesh.Submeshes)
+    {
+        SubmeshPatches patches(mesh, s);
+        st.SceneArea += patches.Area();
+        if (s.Material >= 0 && (size_t)s.Material < masked.size() && masked[s.Material])
+        {
+            ++st.MaskedSubmeshes;
+            continue;
+        }
+
+        patches.Segment(planeTolerance, [&](const std::vector<uint32_t>& faces, double area, double perimeter)
+            {
+                ++st.Patches;
+                if (area < minArea || perimeter > kOccluderMaxRaggedness * std::sqrt(area)) return;
+                Patch patch;
+                patch.Order = candidates.size();
+                patch.Area = area;
+                patches.Simplify(faces, (float)planeTolerance, patch);
+                if (!patch.Indices.empty()) candidates.push_back(std::move(patch));
+            });
+    }
+    st.Candidates = candidates.size();
+
+    // Сначала куски, закрывающие больше всего на треугольник
+    std::vector<const Patch*> order;
+    for (const Patch& p : candidates) order.push_back(&p);
+    std::sort(order.begin(), order.end(), [](const Patch* a, const Patch* b)
+        {
+            double ea = a->Area * b->Indices.size(), eb = b->Area * a->Indices.size();
+            return ea != eb ? ea > eb : a->Order < b->Order;
+        });
+    std::vector<const Patch*> selected;
+    size_t triangles = 0;
+    for (const Patch* p : order)
+    {
+        if (triangles + p->Indices.size() / 3 > maxTriangles) continue;
+        triangles += p->Indices.size() / 3;
+        selected.push_back(p);
+    }
+    std::sort(selected.begin(), selected.end(), [](const Patch* a, const Patch* b) { return a->Order < b->Order; });
+
+    for (const Patch* p : selected)
+    {
+        uint32_t base = (uint32_t)out.Positions.size();
+        out.Positions.insert(out.Positions.end(), p->Positions.begin(), p->Positions.end());
+        for (uint32_t i : p->Indices) out.Indices.push_back(base + i);
+        st.SourceTriangles += p->SourceTriangles;
+        st.SelectedArea += p->Area;
+    }
+    st.Selected = selected.size();
+    st.Triangles = out.Indices.size() / 3;
+    if (stats) *stats = st;
+}
+
+std::string OccluderMeshPath(const std::string& objPath)
+{
+    return objPath + ".occ";
+}
+
+bool SaveOccluderMesh(const std::string& path, const OccluderSet& occluders, uint64_t sourceHash)
+{
+    OccluderFileHeader h = {};
+    h.Version = kOccluderFileVersion;
+    h.SourceHash = sourceHash;
+    h.VertexCount = (uint32_t)occluders.Positions.size();
+    h.IndexCount = (uint32_t)occluders.Indices.size();
+    h.PositionsOffset = AlignUp(sizeof(OccluderFileHeader));
+    h.IndicesOffset = AlignUp(h.PositionsOffset + (uint64_t)h.VertexCount * sizeof(XMFLOAT3));
+    h.FileSize = AlignUp(h.IndicesOffset + (uint64_t)h.IndexCount * sizeof(uint32_t));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    out.write((const char*)&h, sizeof(h));
+    WritePadding(out, h.PositionsOffset);
+    out.write((const char*)occluders.Positions.data(), (std::streamsize)(h.VertexCount * sizeof(XMFLOAT3)));
+    WritePadding(out, h.IndicesOffset);
+    out.write((const char*)occluders.Indices.data(), (std::streamsize)(h.IndexCount * sizeof(uint32_t)));
+    WritePadding(out, h.FileSize);
+
+    h.Magic = kOccluderFileMagic;
+    out.seekp(0);
+    out.write((const char*)&h, sizeof(h));
+    return (bool)out;
+}
+
+bool LoadOccluderMesh(const std::string& path, uint64_t sourceHash, OccluderSet& occluders)
+{
+    MappedFile file;
+    if (!file.Open(path) || file.Size() < sizeof(OccluderFileHeader)) return false;
+
+    OccluderFileHeader h;
+    std::memcpy(&h, file.Data(), sizeof(h));
+    if (h.Magic != kOccluderFileMagic || h.Version != kOccluderFileVersion ||
+        h.SourceHash != sourceHash || h.FileSize != file.Size() || h.IndexCount % 3 != 0)
+        return false;
+    bool inside = h.PositionsOffset >= sizeof(OccluderFileHeader) &&
+        h.PositionsOffset + (uint64_t)h.VertexCount * sizeof(XMFLOAT3) <= h.IndicesOffset &&
+        h.IndicesOffset + (uint64_t)h.IndexCount * sizeof(uint32_t) <= h.FileSize;
+    if (!inside) return false;
+
+    const XMFLOAT3* positions = (const XMFLOAT3*)(file.Data() + h.PositionsOffset);
+    const uint32_t* indices = (const uint32_t*)(file.Data() + h.IndicesOffset);
+    for (uint32_t i = 0; i < h.IndexCount; ++i)
+        if (indices[i] >= h.VertexCount) return false;
+
+    occluders.Positions.assign(positions, positions + h.VertexCount);
+    occluders.Indices.assign(indices, indices + h.IndexCount);
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ModelImporter.h"
+#include "OcclusionBuffer.h"
+
+// Офлайн-окклюдер модели (<obj>.occ): крупные плоские куски непрозрачных сабмешей (стены, пол,
+// грани колонн), упрощённые без сдвига границы. Вместо SelectOccluders, если файл есть.
+//
+// Layout (little-endian, секции выровнены по 64 байтам):
+//   OccluderFileHeader
+//   XMFLOAT3 Positions[VertexCount]
+//   uint32_t Indices[IndexCount]
+
+static const uint32_t kOccluderFileMagic = 0x4D43434F;   // "OCCM"
+static const uint32_t kOccluderFileVersion = 1;          // менять при смене отбора или упрощения
+
+// Отбор куска: связные по рёбрам треугольники, нормаль в пределах kOccluderPlanarCos от нормали
+// затравки и вершины не дальше kOccluderPlaneTolerance * диагональ сцены от её плоскости
+static const float kOccluderPlanarCos = 0.996f;          // ~5°
+static const float kOccluderPlaneTolerance = 1e-3f;      // он же предел ошибки упрощения
+static const float kOccluderMinAreaFraction = 2.5e-4f;   // площадь куска от квадрата диагонали сцены
+// Периметр / sqrt(площади): у квадрата 4, у полосы 10:1 — 7; решётки и бахрома не закрывают
+static const float kOccluderMaxRaggedness = 24.0f;
+
+struct OccluderFileHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t SourceHash;       // хэш исходного OBJ
+    uint32_t VertexCount;
+    uint32_t IndexCount;
+    uint64_t PositionsOffset;
+    uint64_t IndicesOffset;
+    uint64_t FileSize;
+};
+
+struct OccluderBuildStats
+{
+    size_t Patches = 0;            // плоские куски всех непрозрачных сабмешей
+    size_t Candidates = 0;         // прошли по площади и рваности
+    size_t Selected = 0;           // влезли в бюджет
+    size_t SourceTriangles = 0;    // в выбранных кусках до упрощения
+    size_t Triangles = 0;
+    size_t MaskedSubmeshes = 0;    // пропущены: материал с вырезанием
+    double SceneArea = 0.0;        // вся поверхность модели
+    double SelectedArea = 0.0;
+};
+
+// masked[m] — материал m с вырезанием (map_d или dissolve < 1): такие сабмеши не окклюдеры.
+std::vector<uint8_t> MaskedMaterials(const std::vector<tinyobj::material_t>& materials);
+
+// Куски выбираются по убыванию площади на треугольник после упрощения, пока влезают в maxTriangles;
+// в out они идут в порядке сабмешей. Позиции — в пространстве модели.
+void BuildOccluderMesh(const ImportedMesh& mesh, const std::vector<uint8_t>& masked, size_t maxTriangles,
+    OccluderSet& out, OccluderBuildStats* stats = nullptr);
+
+std::string OccluderMeshPath(const std::string& objPath);
+
+bool SaveOccluderMesh(const std::string& path, const OccluderSet& occluders, uint64_t sourceHash);
+
+// false, если файла нет, он другой версии, от другого OBJ или повреждён.
+bool LoadOccluderMesh(const std::string& path, uint64_t sourceHash, OccluderSet& occluders);
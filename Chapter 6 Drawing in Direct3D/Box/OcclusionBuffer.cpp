@@ -0,0 +1,368 @@
+#include "OcclusionBuffer.h"
+#include "SimdDispatch.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <immintrin.h>
+
+using namespace DirectX;
+
+namespace
+{
+    const int kTilesX = kOcclusionWidth / kOcclusionTileSize;
+    const int kTilesY = kOcclusionHeight / kOcclusionTileSize;
+
+    // Рёбра E(p) = A * px + B * py + C >= 0 внутри, глубина Zx * px + Zy * py + Z0 (уже со сдвигом
+    // к дальнему углу пикселя), не дальше ZMax. Пиксели — по центрам в [MinX, MaxX] x [MinY, MaxY]
+    struct TriangleSetup
+    {
+        float A[3], B[3], C[3];
+        float Zx, Zy, Z0, ZMax;
+        int   MinX, MaxX, MinY, MaxY;
+    };
+
+    bool SetupTriangle(const ScreenTriangle& t, TriangleSetup& s)
+    {
+        float x[3] = { t.X[0], t.X[1], t.X[2] }, y[3] = { t.Y[0], t.Y[1], t.Y[2] }, z[3] = { t.Z[0], t.Z[1], t.Z[2] };
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (!(area != 0.0f)) return false;
+        // Окклюдер закрывает с обеих сторон: обход приводится к одному
+        if (area < 0.0f)
+        {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+            std::swap(z[1], z[2]);
+            area = -area;
+        }
+
+        float minX = std::min(std::min(x[0], x[1]), x[2]), maxX = std::max(std::max(x[0], x[1]), x[2]);
+        float minY = std::min(std::min(y[0], y[1]), y[2]), maxY = std::max(std::max(y[0], y[1]), y[2]);
+        s.MinX = std::max(0, (int)std::ceil(minX - 0.5f));
+        s.MaxX = std::min(kOcclusionWidth - 1, (int)std::floor(maxX - 0.5f));
+        s.MinY = std::max(0, (int)std::ceil(minY - 0.5f));
+        s.MaxY = std::min(kOcclusionHeight - 1, (int)std::floor(maxY - 0.5f));
+        if (s.MinX > s.MaxX || s.MinY > s.MaxY) return false;
+
+        for (int e = 0; e < 3; ++e)
+        {
+            int a = e, b = (e + 1) % 3;
+            s.A[e] = y[a] - y[b];
+            s.B[e] = x[b] - x[a];
+            s.C[e] = x[a] * y[b] - y[a] * x[b];
+        }
+
+        float dzdx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+        float dzdy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+        s.Zx = dzdx;
+        s.Zy = dzdy;
+        s.Z0 = z[0] - dzdx * x[0] - dzdy * y[0] + 0.5f * (std::fabs(dzdx) + std::fabs(dzdy));
+        s.ZMax = std::max(std::max(z[0], z[1]), z[2]);
+        return true;
+    }
+
+    // Расстояния до плоскостей отсечения: w + x, w - x, w + y, w - y, z (near в D3D)
+    const int kClipPlanes = 5;
+
+    float PlaneDistance(const XMFLOAT4& v, int plane)
+    {
+        switch (plane)
+        {
+        case 0:  return v.w + v.x;
+        case 1:  return v.w - v.x;
+        case 2:  return v.w + v.y;
+        case 3:  return v.w - v.y;
+        default: return v.z;
+        }
+    }
+
+    int Outcode(const XMFLOAT4& v)
+    {
+        int code = 0;
+        for (int p = 0; p < kClipPlanes; ++p)
+            code |= (PlaneDistance(v, p) < 0.0f) << p;
+        return code;
+    }
+
+    // Sutherland–Hodgman: треугольник режется пятью плоскостями, в полигоне не больше 3 + 5 вершин
+    int ClipPolygon(XMFLOAT4* poly, int count, int outcodes)
+    {
+        XMFLOAT4 scratch[8];
+        for (int p = 0; p < kClipPlanes && count > 0; ++p)
+        {
+            if (!(outcodes & (1 << p))) continue;
+            int n = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                const XMFLOAT4& a = poly[i];
+                const XMFLOAT4& b = poly[(i + 1) % count];
+                float da = PlaneDistance(a, p), db = PlaneDistance(b, p);
+                if (da >= 0.0f) scratch[n++] = a;
+                if ((da >= 0.0f) != (db >= 0.0f))
+                {
+                    float t = da / (da - db);
+                    scratch[n++] = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t,
+                        a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t };
+                }
+            }
+            std::copy(scratch, scratch + n, poly);
+            count = n;
+        }
+        return count;
+    }
+
+    void ToScreen(const XMFLOAT4& v, float& x, float& y, float& z)
+    {
+        float invW = 1.0f / v.w;
+        x = (v.x * invW * 0.5f + 0.5f) * kOcclusionWidth;
+        y = (0.5f - v.y * invW * 0.5f) * kOcclusionHeight;
+        z = v.z * invW;
+    }
+}
+
+void SelectOccluders(const PositionsSoA& positions, const uint32_t* indices, size_t triCount,
+    size_t maxTriangles, OccluderSet& out)
+{
+    struct Candidate
+    {
+        float    Area;
+        uint32_t Triangle;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t t = 0; t < triCount; ++t)
+    {
+        XMFLOAT3 pa = positions.Get(indices[3 * t]), pb = positions.Get(indices[3 * t + 1]), pc = positions.Get(indices[3 * t + 2]);
+        XMVECTOR a = XMLoadFloat3(&pa);
+        XMVECTOR n = XMVector3Cross(XMLoadFloat3(&pb) - a, XMLoadFloat3(&pc) - a);
+        float area = 0.5f * XMVectorGetX(XMVector3Length(n));
+        if (area > 0.0f) candidates.push_back({ area, (uint32_t)t });
+    }
+
+    auto larger = [](const Candidate& l, const Candidate& r)
+    {
+        return l.Area != r.Area ? l.Area > r.Area : l.Triangle < r.Triangle;
+    };
+    if (candidates.size() > maxTriangles)
+    {
+        std::nth_element(candidates.begin(), candidates.begin() + maxTriangles, candidates.end(), larger);
+        candidates.resize(maxTriangles);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+        [](const Candidate& l, const Candidate& r) { return l.Triangle < r.Triangle; });
+
+    out.Positions.clear();
+    out.Indices.clear();
+    std::vector<uint32_t> remap(positions.Count, UINT32_MAX);
+    for (const Candidate& c : candidates)
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t v = indices[3 * c.Triangle + k];
+            if (remap[v] == UINT32_MAX)
+            {
+                remap[v] = (uint32_t)out.Positions.size();
+                out.Positions.push_back(positions.Get(v));
+            }
+            out.Indices.push_back(remap[v]);
+        }
+}
+
+void RasterizeTriangleScalar(const ScreenTriangle& tri, float* depth)
+{
+    TriangleSetup s;
+    if (!SetupTriangle(tri, s)) return;
+
+    for (int y = s.MinY; y <= s.MaxY; ++y)
+    {
+        const float py = (float)y + 0.5f;
+        const float r0 = s.B[0] * py + s.C[0], r1 = s.B[1] * py + s.C[1], r2 = s.B[2] * py + s.C[2];
+        const float rz = s.Zy * py + s.Z0;
+        float* row = depth + y * kOcclusionWidth;
+        for (int x = s.MinX; x <= s.MaxX; ++x)
+        {
+            const float px = (float)x + 0.5f;
+            if (s.A[0] * px + r0 < 0.0f || s.A[1] * px + r1 < 0.0f || s.A[2] * px + r2 < 0.0f) continue;
+            float z = std::min(s.Zx * px + rz, s.ZMax);
+            row[x] = z < row[x] ? z : row[x];
+        }
+    }
+}
+
+void RasterizeTriangleSSE(const ScreenTriangle& tri, float* depth)
+{
+    TriangleSetup s;
+    if (!SetupTriangle(tri, s)) return;
+
+    const __m128 a0 = _mm_set1_ps(s.A[0]), a1 = _mm_set1_ps(s.A[1]), a2 = _mm_set1_ps(s.A[2]);
+    const __m128 zx = _mm_set1_ps(s.Zx), zmax = _mm_set1_ps(s.ZMax);
+    const __m128 half = _mm_set1_ps(0.5f), zero = _mm_setzero_ps();
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i minX = _mm_set1_epi32(s.MinX - 1), maxX = _mm_set1_epi32(s.MaxX + 1);
+
+    for (int y = s.MinY; y <= s.MaxY; ++y)
+    {
+        const float py = (float)y + 0.5f;
+        const __m128 r0 = _mm_set1_ps(s.B[0] * py + s.C[0]), r1 = _mm_set1_ps(s.B[1] * py + s.C[1]),
+            r2 = _mm_set1_ps(s.B[2] * py + s.C[2]), rz = _mm_set1_ps(s.Zy * py + s.Z0);
+        float* row = depth + y * kOcclusionWidth;
+        for (int x = s.MinX & ~3; x <= s.MaxX; x += 4)
+        {
+            __m128i xi = _mm_add_epi32(_mm_set1_epi32(x), lanes);
+            __m128 inside = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(xi, minX), _mm_cmplt_epi32(xi, maxX)));
+            __m128 px = _mm_add_ps(_mm_cvtepi32_ps(xi), half);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), r0), zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), r1), zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), r2), zero));
+            if (_mm_movemask_ps(inside) == 0) continue;
+
+            __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(zx, px), rz), zmax);
+            __m128 old = _mm_loadu_ps(row + x);
+            __m128 nearer = _mm_min_ps(z, old);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+        }
+    }
+}
+
+AVX2_TARGET
+void RasterizeTriangleAVX2(const ScreenTriangle& tri, float* depth)
+{
+    TriangleSetup s;
+    if (!SetupTriangle(tri, s)) return;
+
+    const __m256 a0 = _mm256_set1_ps(s.A[0]), a1 = _mm256_set1_ps(s.A[1]), a2 = _mm256_set1_ps(s.A[2]);
+    const __m256 zx = _mm256_set1_ps(s.Zx), zmax = _mm256_set1_ps(s.ZMax);
+    const __m256 half = _mm256_set1_ps(0.5f), zero = _mm256_setzero_ps();
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i minX = _mm256_set1_epi32(s.MinX - 1), maxX = _mm256_set1_epi32(s.MaxX + 1);
+
+    for (int y = s.MinY; y <= s.MaxY; ++y)
+    {
+        const float py = (float)y + 0.5f;
+        const __m256 r0 = _mm256_set1_ps(s.B[0] * py + s.C[0]), r1 = _mm256_set1_ps(s.B[1] * py + s.C[1]),
+            r2 = _mm256_set1_ps(s.B[2] * py + s.C[2]), rz = _mm256_set1_ps(s.Zy * py + s.Z0);
+        float* row = depth + y * kOcclusionWidth;
+        for (int x = s.MinX & ~7; x <= s.MaxX; x += 8)
+        {
+            __m256i xi = _mm256_add_epi32(_mm256_set1_epi32(x), lanes);
+            __m256 inside = _mm256_castsi256_ps(_mm256_and_si256(_mm256_cmpgt_epi32(xi, minX), _mm256_cmpgt_epi32(maxX, xi)));
+            __m256 px = _mm256_add_ps(_mm256_cvtepi32_ps(xi), half);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a0, px), r0), zero, _CMP_GE_OQ));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a1, px), r1), zero, _CMP_GE_OQ));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a2, px), r2), zero, _CMP_GE_OQ));
+            if (_mm256_movemask_ps(inside) == 0) continue;
+
+            __m256 z = _mm256_min_ps(_mm256_add_ps(_mm256_mul_ps(zx, px), rz), zmax);
+            __m256 old = _mm256_loadu_ps(row + x);
+            _mm256_storeu_ps(row + x, _mm256_blendv_ps(old, _mm256_min_ps(z, old), inside));
+        }
+    }
+
+    _mm256_zeroupper();
+}
+
+void RasterizeTriangle(const ScreenTriangle& tri, float* depth)
+{
+    static const RasterizeTriangleFn kernel = CpuSupportsAVX2() ? RasterizeTriangleAVX2 : RasterizeTriangleSSE;
+    kernel(tri, depth);
+}
+
+OcclusionBuffer::OcclusionBuffer()
+    : mDepth(kOcclusionWidth * kOcclusionHeight, 1.0f),
+      mTileMax(kTilesX * kTilesY, 1.0f)
+{
+    XMStoreFloat4x4(&mWorldViewProj, XMMatrixIdentity());
+}
+
+void OcclusionBuffer::Begin(FXMMATRIX worldViewProj)
+{
+    XMStoreFloat4x4(&mWorldViewProj, worldViewProj);
+    std::fill(mDepth.begin(), mDepth.end(), 1.0f);
+    std::fill(mTileMax.begin(), mTileMax.end(), 1.0f);
+    mRasterized = 0;
+}
+
+void OcclusionBuffer::RenderOccluders(const OccluderSet& occluders, RasterizeTriangleFn rasterize)
+{
+    XMMATRIX m = XMLoadFloat4x4(&mWorldViewProj);
+    mClip.resize(occluders.Positions.size());
+    for (size_t i = 0; i < occluders.Positions.size(); ++i)
+        XMStoreFloat4(&mClip[i], XMVector3Transform(XMLoadFloat3(&occluders.Positions[i]), m));
+
+    for (size_t t = 0; t + 2 < occluders.Indices.size(); t += 3)
+    {
+        XMFLOAT4 poly[8] = { mClip[occluders.Indices[t]], mClip[occluders.Indices[t + 1]], mClip[occluders.Indices[t + 2]] };
+        int c0 = Outcode(poly[0]), c1 = Outcode(poly[1]), c2 = Outcode(poly[2]);
+        if (c0 & c1 & c2) continue;
+        int count = (c0 | c1 | c2) ? ClipPolygon(poly, 3, c0 | c1 | c2) : 3;
+
+        ScreenTriangle tri;
+        ToScreen(poly[0], tri.X[0], tri.Y[0], tri.Z[0]);
+        for (int v = 2; v < count; ++v)
+        {
+            ToScreen(poly[v - 1], tri.X[1], tri.Y[1], tri.Z[1]);
+            ToScreen(poly[v], tri.X[2], tri.Y[2], tri.Z[2]);
+            rasterize(tri, mDepth.data());
+        }
+        ++mRasterized;
+    }
+}
+
+void OcclusionBuffer::Finish()
+{
+    for (int ty = 0; ty < kTilesY; ++ty)
+        for (int tx = 0; tx < kTilesX; ++tx)
+        {
+            float farthest = 0.0f;
+            for (int y = ty * kOcclusionTileSize; y < (ty + 1) * kOcclusionTileSize; ++y)
+            {
+                const float* row = mDepth.data() + y * kOcclusionWidth + tx * kOcclusionTileSize;
+                for (int x = 0; x < kOcclusionTileSize; ++x)
+                    farthest = std::max(farthest, row[x]);
+            }
+            mTileMax[ty * kTilesX + tx] = farthest;
+        }
+}
+
+bool OcclusionBuffer::IsOccluded(const XMFLOAT3& center, const XMFLOAT3& extents) const
+{
+    XMMATRIX m = XMLoadFloat4x4(&mWorldViewProj);
+    float minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        XMVECTOR p = XMVectorSet(
+            center.x + (corner & 1 ? extents.x : -extents.x),
+            center.y + (corner & 2 ? extents.y : -extents.y),
+            center.z + (corner & 4 ? extents.z : -extents.z), 1.0f);
+        XMFLOAT4 clip;
+        XMStoreFloat4(&clip, XMVector3Transform(p, m));
+        // Угол перед near: проекция бокса не ограничена, считаем видимым
+        if (clip.z < 0.0f || !(clip.w > 0.0f)) return false;
+
+        float x, y, z;
+        ToScreen(clip, x, y, z);
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        minZ = std::min(minZ, z);
+    }
+    if (maxX < 0.0f || maxY < 0.0f || minX >= (float)kOcclusionWidth || minY >= (float)kOcclusionHeight) return false;
+
+    // Все пиксели, которых касается прямоугольник проекции
+    int x0 = (int)std::max(minX, 0.0f), y0 = (int)std::max(minY, 0.0f);
+    int x1 = maxX >= (float)kOcclusionWidth ? kOcclusionWidth - 1 : (int)maxX;
+    int y1 = maxY >= (float)kOcclusionHeight ? kOcclusionHeight - 1 : (int)maxY;
+
+    for (int ty = y0 / kOcclusionTileSize; ty <= y1 / kOcclusionTileSize; ++ty)
+        for (int tx = x0 / kOcclusionTileSize; tx <= x1 / kOcclusionTileSize; ++tx)
+        {
+            if (mTileMax[ty * kTilesX + tx] < minZ) continue;
+            int ya = std::max(y0, ty * kOcclusionTileSize), yb = std::min(y1, (ty + 1) * kOcclusionTileSize - 1);
+            int xa = std::max(x0, tx * kOcclusionTileSize), xb = std::min(x1, (tx + 1) * kOcclusionTileSize - 1);
+            for (int y = ya; y <= yb; ++y)
+            {
+                const float* row = mDepth.data() + y * kOcclusionWidth;
+                for (int x = xa; x <= xb; ++x)
+                    if (row[x] >= minZ) return false;
+            }
+        }
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "WorldVertexCache.h"
+
+// Программный occlusion culling: крупные окклюдеры растеризуются на CPU в грубый буфер глубины,
+// боксы проверяются против него до записи draw-вызовов. Глубина как в D3D: 0 — near, 1 — far.
+static const int kOcclusionWidth = 256;
+static const int kOcclusionHeight = 128;
+static const int kOcclusionTileSize = 8;   // максимум глубины по тайлам 8x8 — быстрый отказ в IsOccluded
+
+// Бюджет окклюдеров на кадр: 256x128 не различает мелочь, а растеризация линейна по треугольникам
+static const size_t kMaxOccluderTriangles = 4096;
+
+// Окклюдеры в пространстве модели, вершины общие.
+struct OccluderSet
+{
+    std::vector<DirectX::XMFLOAT3> Positions;
+    std::vector<uint32_t>          Indices;
+};
+
+// Самые крупные по площади треугольники сцены, не больше maxTriangles; порядок — как в indices.
+// Вырожденные пропускаются, при равной площади раньше идёт меньший индекс — результат детерминирован.
+void SelectOccluders(const PositionsSoA& positions, const uint32_t* indices, size_t triCount,
+    size_t maxTriangles, OccluderSet& out);
+
+// Треугольник после отсечения: x, y — в пикселях буфера, z — глубина NDC.
+struct ScreenTriangle
+{
+    float X[3], Y[3], Z[3];
+};
+
+// Пиксель покрыт, если его центр внутри треугольника (рёбра включительно, обе стороны).
+// Записывается глубина, не меньшая глубины плоскости треугольника в любой точке пикселя,
+// поэтому буфер не ближе настоящих окклюдеров. depth — kOcclusionWidth * kOcclusionHeight.
+// Варианты и выбор — см. SimdDispatch.h.
+typedef void (*RasterizeTriangleFn)(const ScreenTriangle& tri, float* depth);
+
+void RasterizeTriangleScalar(const ScreenTriangle& tri, float* depth);
+void RasterizeTriangleSSE(const ScreenTriangle& tri, float* depth);
+// 8 пикселей строки за итерацию.
+void RasterizeTriangleAVX2(const ScreenTriangle& tri, float* depth);
+
+void RasterizeTriangle(const ScreenTriangle& tri, float* depth);
+
+class OcclusionBuffer
+{
+public:
+    OcclusionBuffer();
+
+    // Очищает буфер. Окклюдеры и проверяемые боксы задаются в одном пространстве:
+    // для World * View * Proj — в пространстве модели, как Bounds сабмешей.
+    void Begin(DirectX::FXMMATRIX worldViewProj);
+
+    // Треугольники режутся по near и краям экрана в clip-пространстве.
+    void RenderOccluders(const OccluderSet& occluders, RasterizeTriangleFn rasterize = RasterizeTriangle);
+
+    // Собирает максимумы по тайлам; после него буфер готов к IsOccluded.
+    void Finish();
+
+    // true — бокс целиком за окклюдерами. Бокс, пересекающий near или целиком вне экрана,
+    // не считается закрытым: это забота frustum culling.
+    bool IsOccluded(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents) const;
+
+    const float* Depth() const { return mDepth.data(); }
+    size_t       RasterizedTriangles() const { return mRasterized; }
+
+private:
+    DirectX::XMFLOAT4X4 mWorldViewProj;
+    std::vector<float>  mDepth;
+    std::vector<float>  mTileMax;
+    std::vector<DirectX::XMFLOAT4> mClip;   // вершины окклюдеров в clip-пространстве
+    size_t              mRasterized = 0;
+};
@@ -0,0 +1,35 @@
+#include "ParallelRaycast.h"
+
+using namespace DirectX;
+
+bool RaycastLinearParallel(WorkerPool& pool, const TrianglesSoA& tris,
+    const XMFLOAT3& orig, const XMFLOAT3& dir,
+    float tMin, float tMax, RayHit& hit, size_t chunkTris)
+{
+    if (tris.Count == 0) return false;
+    if (chunkTris == 0) chunkTris = tris.Count;
+
+    const size_t chunks = (tris.Count + chunkTris - 1) / chunkTris;
+    std::vector<RayHit> partial(chunks);
+
+    pool.ParallelFor(chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c)
+        {
+            size_t first = c * chunkTris;
+            size_t count = first + chunkTris < tris.Count ? chunkTris : tris.Count - first;
+            float  t = tMax;
+            partial[c].TriangleId = IntersectTriangles(tris, first, count, orig, dir, tMin, t);
+            partial[c].T = t;
+        }
+    });
+
+    RayHit best;
+    best.T = tMax;
+    for (const auto& p : partial)
+        if (p.IsHit() && p.T < best.T)
+            best = p;
+
+    if (!best.IsHit()) return false;
+    hit = best;
+    return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "RayTriangle.h"
+#include "WorkerPool.h"
+
+// Перебор всех треугольников потока кусками по chunkTris на пуле потоков.
+// Каждый кусок даёт свой ближайший t, затем минимумы сворачиваются в порядке кусков,
+// так что результат (t и индекс) совпадает с последовательным IntersectTriangles.
+bool RaycastLinearParallel(WorkerPool& pool, const TrianglesSoA& tris,
+    const DirectX::XMFLOAT3& orig, const DirectX::XMFLOAT3& dir,
+    float tMin, float tMax, RayHit& hit, size_t chunkTris = 16384);
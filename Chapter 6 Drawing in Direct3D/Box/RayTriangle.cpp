@@ -0,0 +1,241 @@
+#include "RayTriangle.h"
+#include "SimdDispatch.h"
+#include <immintrin.h>
+
+using namespace DirectX;
+
+namespace
+{
+    const float kDetEpsilon = 1e-7f;
+}
+
+void TriangleStream::Build(const PositionsSoA& positions, const uint32_t* indices, size_t triCount,
+    const uint32_t* order)
+{
+    mCount = triCount;
+    for (auto& d : mData)
+        d.assign(triCount + 8, 0.0f);
+
+    const float* px = positions.X;
+    const float* py = positions.Y;
+    const float* pz = positions.Z;
+    for (size_t i = 0; i < triCount; ++i)
+    {
+        size_t   src = order ? order[i] : i;
+        uint32_t i0 = indices[3 * src + 0];
+        uint32_t i1 = indices[3 * src + 1];
+        uint32_t i2 = indices[3 * src + 2];
+
+        mData[0][i] = px[i0];
+        mData[1][i] = py[i0];
+        mData[2][i] = pz[i0];
+        mData[3][i] = px[i1] - px[i0];
+        mData[4][i] = py[i1] - py[i0];
+        mData[5][i] = pz[i1] - pz[i0];
+        mData[6][i] = px[i2] - px[i0];
+        mData[7][i] = py[i2] - py[i0];
+        mData[8][i] = pz[i2] - pz[i0];
+    }
+}
+
+void TriangleStream::Clear()
+{
+    for (auto& d : mData)
+        d.clear();
+    mCount = 0;
+}
+
+TrianglesSoA TriangleStream::View() const
+{
+    TrianglesSoA v;
+    for (int k = 0; k < 3; ++k)
+    {
+        v.V0[k] = mData[k].data();
+        v.E1[k] = mData[3 + k].data();
+        v.E2[k] = mData[6 + k].data();
+    }
+    v.Count = mCount;
+    return v;
+}
+
+uint32_t IntersectTrianglesScalar(const TrianglesSoA& tris, size_t first, size_t count,
+    const XMFLOAT3& orig, const XMFLOAT3& dir, float tMin, float& tClosest)
+{
+    const float dx = dir.x, dy = dir.y, dz = dir.z;
+    float    closest = tClosest;
+    uint32_t best = UINT32_MAX;
+
+    for (size_t i = first; i < first + count; ++i)
+    {
+        float e1x = tris.E1[0][i], e1y = tris.E1[1][i], e1z = tris.E1[2][i];
+        float e2x = tris.E2[0][i], e2y = tris.E2[1][i], e2z = tris.E2[2][i];
+
+        float hx = dy * e2z - dz * e2y;
+        float hy = dz * e2x - dx * e2z;
+        float hz = dx * e2y - dy * e2x;
+        float a = e1x * hx + e1y * hy + e1z * hz;
+        float f = 1.0f / a;
+
+        float sx = orig.x - tris.V0[0][i];
+        float sy = orig.y - tris.V0[1][i];
+        float sz = orig.z - tris.V0[2][i];
+        float u = f * (sx * hx + sy * hy + sz * hz);
+
+        float qx = sy * e1z - sz * e1y;
+        float qy = sz * e1x - sx * e1z;
+        float qz = sx * e1y - sy * e1x;
+        float v = f * (dx * qx + dy * qy + dz * qz);
+        float t = f * (e2x * qx + e2y * qy + e2z * qz);
+
+        bool hit = (a <= -kDetEpsilon || a >= kDetEpsilon) &&
+            u >= 0.0f && u <= 1.0f && v >= 0.0f && u + v <= 1.0f &&
+            t > tMin && t < closest;
+        if (hit)
+        {
+            closest = t;
+            best = (uint32_t)i;
+        }
+    }
+
+    tClosest = closest;
+    return best;
+}
+
+uint32_t IntersectTrianglesSSE(const TrianglesSoA& tris, size_t first, size_t count,
+    const XMFLOAT3& orig, const XMFLOAT3& dir, float tMin, float& tClosest)
+{
+    const __m128 dx = _mm_set1_ps(dir.x), dy = _mm_set1_ps(dir.y), dz = _mm_set1_ps(dir.z);
+    const __m128 ox = _mm_set1_ps(orig.x), oy = _mm_set1_ps(orig.y), oz = _mm_set1_ps(orig.z);
+    const __m128 posEps = _mm_set1_ps(kDetEpsilon), negEps = _mm_set1_ps(-kDetEpsilon);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    const __m128 tMinV = _mm_set1_ps(tMin);
+    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+    float    closest = tClosest;
+    uint32_t best = UINT32_MAX;
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        const size_t b = first + i;
+        __m128 e1x = _mm_loadu_ps(tris.E1[0] + b), e1y = _mm_loadu_ps(tris.E1[1] + b), e1z = _mm_loadu_ps(tris.E1[2] + b);
+        __m128 e2x = _mm_loadu_ps(tris.E2[0] + b), e2y = _mm_loadu_ps(tris.E2[1] + b), e2z = _mm_loadu_ps(tris.E2[2] + b);
+
+        __m128 hx = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        __m128 hy = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        __m128 hz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, hx), _mm_mul_ps(e1y, hy)), _mm_mul_ps(e1z, hz));
+        __m128 f = _mm_div_ps(one, a);
+
+        __m128 sx = _mm_sub_ps(ox, _mm_loadu_ps(tris.V0[0] + b));
+        __m128 sy = _mm_sub_ps(oy, _mm_loadu_ps(tris.V0[1] + b));
+        __m128 sz = _mm_sub_ps(oz, _mm_loadu_ps(tris.V0[2] + b));
+        __m128 u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, hx), _mm_mul_ps(sy, hy)), _mm_mul_ps(sz, hz)));
+
+        __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        __m128 v = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+        __m128 t = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)));
+
+        __m128 mask = _mm_or_ps(_mm_cmple_ps(a, negEps), _mm_cmpge_ps(a, posEps));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(u, one));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), one));
+        mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, tMinV));
+        mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(closest)));
+        mask = _mm_and_ps(mask, _mm_cmplt_ps(lane, _mm_set1_ps((float)(count - i))));
+
+        int bits = _mm_movemask_ps(mask);
+        if (bits == 0) continue;
+
+        // Попадания редки: минимум выбираем скалярно, в порядке линий, как эталон.
+        alignas(16) float ts[4];
+        _mm_store_ps(ts, t);
+        for (int l = 0; l < 4; ++l)
+        {
+            if ((bits & (1 << l)) && ts[l] < closest)
+            {
+                closest = ts[l];
+                best = (uint32_t)(b + l);
+            }
+        }
+    }
+
+    tClosest = closest;
+    return best;
+}
+
+AVX2_TARGET
+uint32_t IntersectTrianglesAVX2(const TrianglesSoA& tris, size_t first, size_t count,
+    const XMFLOAT3& orig, const XMFLOAT3& dir, float tMin, float& tClosest)
+{
+    const __m256 dx = _mm256_set1_ps(dir.x), dy = _mm256_set1_ps(dir.y), dz = _mm256_set1_ps(dir.z);
+    const __m256 ox = _mm256_set1_ps(orig.x), oy = _mm256_set1_ps(orig.y), oz = _mm256_set1_ps(orig.z);
+    const __m256 posEps = _mm256_set1_ps(kDetEpsilon), negEps = _mm256_set1_ps(-kDetEpsilon);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    const __m256 tMinV = _mm256_set1_ps(tMin);
+    const __m256 lane = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+
+    float    closest = tClosest;
+    uint32_t best = UINT32_MAX;
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        const size_t b = first + i;
+        __m256 e1x = _mm256_loadu_ps(tris.E1[0] + b), e1y = _mm256_loadu_ps(tris.E1[1] + b), e1z = _mm256_loadu_ps(tris.E1[2] + b);
+        __m256 e2x = _mm256_loadu_ps(tris.E2[0] + b), e2y = _mm256_loadu_ps(tris.E2[1] + b), e2z = _mm256_loadu_ps(tris.E2[2] + b);
+
+        __m256 hx = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+        __m256 hy = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+        __m256 hz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+        __m256 a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, hx), _mm256_mul_ps(e1y, hy)), _mm256_mul_ps(e1z, hz));
+        __m256 f = _mm256_div_ps(one, a);
+
+        __m256 sx = _mm256_sub_ps(ox, _mm256_loadu_ps(tris.V0[0] + b));
+        __m256 sy = _mm256_sub_ps(oy, _mm256_loadu_ps(tris.V0[1] + b));
+        __m256 sz = _mm256_sub_ps(oz, _mm256_loadu_ps(tris.V0[2] + b));
+        __m256 u = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, hx), _mm256_mul_ps(sy, hy)), _mm256_mul_ps(sz, hz)));
+
+        __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+        __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+        __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+        __m256 v = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)));
+        __m256 t = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)));
+
+        __m256 mask = _mm256_or_ps(_mm256_cmp_ps(a, negEps, _CMP_LE_OQ), _mm256_cmp_ps(a, posEps, _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(u, one, _CMP_LE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(t, tMinV, _CMP_GT_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(t, _mm256_set1_ps(closest), _CMP_LT_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(lane, _mm256_set1_ps((float)(count - i)), _CMP_LT_OQ));
+
+        int bits = _mm256_movemask_ps(mask);
+        if (bits == 0) continue;
+
+        alignas(32) float ts[8];
+        _mm256_store_ps(ts, t);
+        for (int l = 0; l < 8; ++l)
+        {
+            if ((bits & (1 << l)) && ts[l] < closest)
+            {
+                closest = ts[l];
+                best = (uint32_t)(b + l);
+            }
+        }
+    }
+
+    _mm256_zeroupper();
+    tClosest = closest;
+    return best;
+}
+
+uint32_t IntersectTriangles(const TrianglesSoA& tris, size_t first, size_t count,
+    const XMFLOAT3& orig, const XMFLOAT3& dir, float tMin, float& tClosest)
+{
+    static const IntersectTrianglesFn kernel =
+        CpuSupportsAVX2() ? IntersectTrianglesAVX2 : IntersectTrianglesSSE;
+    return kernel(tris, first, count, orig, dir, tMin, tClosest);
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <cfloat>
+#include <vector>
+#include "SimdDispatch.h"
+#include "WorldVertexCache.h"
+
+struct RayHit
+{
+    float    T = FLT_MAX;
+    uint32_t TriangleId = UINT32_MAX;   // индекс треугольника в исходном index buffer (index / 3)
+
+    bool IsHit() const { return TriangleId != UINT32_MAX; }
+};
+
+// Möller–Trumbore, один луч против одного треугольника.
+// t возвращается в единицах длины dir.
+inline bool RayTriangleIntersect(
+    DirectX::FXMVECTOR orig, DirectX::FXMVECTOR dir,
+    DirectX::FXMVECTOR v0, DirectX::GXMVECTOR v1, DirectX::HXMVECTOR v2,
+    float& t)
+{
+    using namespace DirectX;
+
+    const float EPS = 1e-7f;
+    XMVECTOR edge1 = v1 - v0;
+    XMVECTOR edge2 = v2 - v0;
+    XMVECTOR h = XMVector3Cross(dir, edge2);
+    float    a = XMVectorGetX(XMVector3Dot(edge1, h));
+    if (a > -EPS && a < EPS) return false;
+    float    f = 1.0f / a;
+    XMVECTOR s = orig - v0;
+    float    u = f * XMVectorGetX(XMVector3Dot(s, h));
+    if (u < 0.0f || u > 1.0f) return false;
+    XMVECTOR q = XMVector3Cross(s, edge1);
+    float    v = f * XMVectorGetX(XMVector3Dot(dir, q));
+    if (v < 0.0f || u + v > 1.0f) return false;
+    t = f * XMVectorGetX(XMVector3Dot(edge2, q));
+    return t > 0.001f;
+}
+
+// Треугольники в SoA: вершина v0 и рёбра e1 = v1 - v0, e2 = v2 - v0, по компонентам [0]=x [1]=y [2]=z.
+// За Count лежит минимум 8 нулевых (вырожденных) треугольников, так что
+// 8-wide загрузка с любого индекса < Count не выходит за буфер.
+struct TrianglesSoA
+{
+    const float* V0[3] = {};
+    const float* E1[3] = {};
+    const float* E2[3] = {};
+    size_t       Count = 0;
+};
+
+class TriangleStream
+{
+public:
+    // order[i] — исходный треугольник для i-й позиции потока; nullptr — порядок index buffer.
+    void Build(const PositionsSoA& positions, const uint32_t* indices, size_t triCount,
+        const uint32_t* order = nullptr);
+    void Clear();
+
+    TrianglesSoA View() const;
+    size_t       Count() const { return mCount; }
+
+private:
+    std::vector<float> mData[9];   // V0xyz, E1xyz, E2xyz
+    size_t             mCount = 0;
+};
+
+// Ближайшее пересечение луча с треугольниками [first, first + count), t в (tMin, tClosest).
+// Возвращает индекс треугольника в потоке или UINT32_MAX; при попадании tClosest уменьшается.
+// Варианты и выбор — см. SimdDispatch.h; результат побитово одинаков, rcp тоже не используется.
+typedef uint32_t (*IntersectTrianglesFn)(const TrianglesSoA& tris, size_t first, size_t count,
+    const DirectX::XMFLOAT3& orig, const DirectX::XMFLOAT3& dir, float tMin, float& tClosest);
+
+uint32_t IntersectTrianglesScalar(const TrianglesSoA& tris, size_t first, size_t count,
+    const DirectX::XMFLOAT3& orig, const DirectX::XMFLOAT3& dir, float tMin, float& tClosest);
+uint32_t IntersectTrianglesSSE(const TrianglesSoA& tris, size_t first, size_t count,
+    const DirectX::XMFLOAT3& orig, const DirectX::XMFLOAT3& dir, float tMin, float& tClosest);
+uint32_t IntersectTrianglesAVX2(const TrianglesSoA& tris, size_t first, size_t count,
+    const DirectX::XMFLOAT3& orig, const DirectX::XMFLOAT3& dir, float tMin, float& tClosest);
+
+uint32_t IntersectTriangles(const TrianglesSoA& tris, size_t first, size_t count,
+    const DirectX::XMFLOAT3& orig, const DirectX::XMFLOAT3& dir, float tMin, float& tClosest);
@@ -0,0 +1,128 @@
+#include "RaycastBatch.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+uint32_t SubmeshTable::Add(uint32_t firstTriangle, uint32_t triangleCount)
+{
+    mFirst.push_back(firstTriangle);
+    mEnd.push_back(firstTriangle + triangleCount);
+    return (uint32_t)mFirst.size() - 1;
+}
+
+void SubmeshTable::Clear()
+{
+    mFirst.clear();
+    mEnd.clear();
+}
+
+uint32_t SubmeshTable::Find(uint32_t triangle) const
+{
+    auto it = std::upper_bound(mFirst.begin(), mFirst.end(), triangle);
+    if (it == mFirst.begin()) return UINT32_MAX;
+    size_t i = (size_t)(it - mFirst.begin()) - 1;
+    return triangle < mEnd[i] ? (uint32_t)i : UINT32_MAX;
+}
+
+namespace
+{
+    // 10 бит на ось -> 30 бит
+    uint32_t SpreadBits10(uint32_t v)
+    {
+        v &= 0x3ff;
+        v = (v | (v << 16)) & 0x030000ff;
+        v = (v | (v << 8)) & 0x0300f00f;
+        v = (v | (v << 4)) & 0x030c30c3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    uint32_t Morton3(float x, float y, float z)
+    {
+        auto q = [](float f) {
+            f = f < 0.0f ? 0.0f : (f > 1.0f ? 1.0f : f);
+            return (uint32_t)(f * 1023.0f);
+        };
+        return SpreadBits10(q(x)) | (SpreadBits10(q(y)) << 1) | (SpreadBits10(q(z)) << 2);
+    }
+}
+
+void RaycastBatch::SortRays(const RayQuery* rays, size_t count)
+{
+    XMFLOAT3 mn = { FLT_MAX, FLT_MAX, FLT_MAX };
+    XMFLOAT3 mx = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t i = 0; i < count; ++i)
+    {
+        const XMFLOAT3& o = rays[i].Origin;
+        mn = { o.x < mn.x ? o.x : mn.x, o.y < mn.y ? o.y : mn.y, o.z < mn.z ? o.z : mn.z };
+        mx = { o.x > mx.x ? o.x : mx.x, o.y > mx.y ? o.y : mx.y, o.z > mx.z ? o.z : mx.z };
+    }
+    XMFLOAT3 inv = {
+        mx.x > mn.x ? 1.0f / (mx.x - mn.x) : 0.0f,
+        mx.y > mn.y ? 1.0f / (mx.y - mn.y) : 0.0f,
+        mx.z > mn.z ? 1.0f / (mx.z - mn.z) : 0.0f };
+
+    // Старшие биты — октант направления (лучи одного октанта обходят детей в одном порядке),
+    // дальше Мортон начала (10 бит на ось) и грубый Мортон направления (7 бит на ось).
+    mKeys.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const RayQuery& r = rays[i];
+        float len = sqrtf(r.Dir.x * r.Dir.x + r.Dir.y * r.Dir.y + r.Dir.z * r.Dir.z);
+        float s = len > 0.0f ? 0.5f / len : 0.0f;
+
+        uint32_t octant = (r.Dir.x < 0.0f ? 1u : 0u) | (r.Dir.y < 0.0f ? 2u : 0u) | (r.Dir.z < 0.0f ? 4u : 0u);
+        uint32_t originCode = Morton3((r.Origin.x - mn.x) * inv.x, (r.Origin.y - mn.y) * inv.y, (r.Origin.z - mn.z) * inv.z);
+        uint32_t dirCode = Morton3(r.Dir.x * s + 0.5f, r.Dir.y * s + 0.5f, r.Dir.z * s + 0.5f) >> 9;
+
+        uint64_t key = ((uint64_t)octant << 61) | ((uint64_t)originCode << 21) | dirCode;
+        mKeys[i] = key;
+    }
+
+    mOrder.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        mOrder[i] = (uint32_t)i;
+    std::sort(mOrder.begin(), mOrder.end(), [this](uint32_t a, uint32_t b) {
+        return mKeys[a] != mKeys[b] ? mKeys[a] < mKeys[b] : a < b;
+    });
+}
+
+void RaycastBatch::Trace(const BVH& bvh, const SubmeshTable* submeshes,
+    const RayQuery* rays, size_t count, RayQueryHit* hits, WorkerPool* pool)
+{
+    if (count == 0) return;
+
+    if (mSortRays)
+    {
+        SortRays(rays, count);
+    }
+    else
+    {
+        mOrder.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            mOrder[i] = (uint32_t)i;
+    }
+
+    auto traceRange = [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k)
+        {
+            uint32_t i = mOrder[k];
+            const RayQuery& r = rays[i];
+            RayHit hit;
+            RayQueryHit& out = hits[i];
+            out = RayQueryHit();
+            if (!bvh.IntersectClosest(XMLoadFloat3(&r.Origin), XMLoadFloat3(&r.Dir), r.TMin, r.TMax, hit))
+                continue;
+            out.T = hit.T;
+            out.TriangleId = hit.TriangleId;
+            if (submeshes)
+                out.SubmeshId = submeshes->Find(hit.TriangleId);
+        }
+    };
+
+    if (pool && count > kRaysPerTask)
+        pool->ParallelFor(count, kRaysPerTask, traceRange);
+    else
+        traceRange(0, count);
+}
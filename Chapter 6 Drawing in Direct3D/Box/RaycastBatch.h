@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BVH.h"
+#include "WorkerPool.h"
+
+struct RayQuery
+{
+    DirectX::XMFLOAT3 Origin;
+    float             TMin = 0.001f;
+    DirectX::XMFLOAT3 Dir;
+    float             TMax = FLT_MAX;
+};
+
+struct RayQueryHit
+{
+    float    T = FLT_MAX;
+    uint32_t TriangleId = UINT32_MAX;
+    uint32_t SubmeshId = UINT32_MAX;
+
+    bool IsHit() const { return TriangleId != UINT32_MAX; }
+};
+
+// Треугольные диапазоны сабмешей в общем index buffer, id = порядок добавления.
+// Диапазоны добавляются по возрастанию firstTriangle (как их пишет BuildModelGeometry).
+class SubmeshTable
+{
+public:
+    uint32_t Add(uint32_t firstTriangle, uint32_t triangleCount);
+    void     Clear();
+
+    // UINT32_MAX, если треугольник не попал ни в один диапазон.
+    uint32_t Find(uint32_t triangle) const;
+    size_t   Count() const { return mFirst.size(); }
+
+private:
+    std::vector<uint32_t> mFirst;
+    std::vector<uint32_t> mEnd;
+};
+
+// Пачка лучей за один вызов. Лучи сортируются по октанту направления и коду Мортона
+// начала/направления, так что соседние лучи идут по одним узлам BVH и попадают в кэш;
+// отсортированный порядок режется на куски и раздаётся пулу. Результат в исходном порядке
+// и совпадает с поштучным BVH::IntersectClosest.
+class RaycastBatch
+{
+public:
+    void SetSortRays(bool sort) { mSortRays = sort; }
+
+    void Trace(const BVH& bvh, const SubmeshTable* submeshes,
+        const RayQuery* rays, size_t count, RayQueryHit* hits,
+        WorkerPool* pool = nullptr);
+
+private:
+    void SortRays(const RayQuery* rays, size_t count);
+
+    std::vector<uint64_t> mKeys;    // ключ сортировки по индексу луча
+    std::vector<uint32_t> mOrder;   // отсортированный порядок обхода
+    bool                  mSortRays = true;
+
+    static const size_t kRaysPerTask = 64;
+};
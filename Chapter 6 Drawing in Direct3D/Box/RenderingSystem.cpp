@@ -20,9 +20,11 @@ void RenderingSystem::Init(
     ID3D12DescriptorHeap* rtvHeap,
     ID3D12DescriptorHeap* srvHeap,
     UINT gbufferRtvOffset,
-    UINT gbufferSrvOffset)
+    UINT gbufferSrvOffset,
+    VertexFormat vertexFormat)
 {
     mBackBufferFormat = backBufferFormat;
+    mVertexFormat = vertexFormat;
     mDepthStencilFormat = depthStencilFormat;
     mSrvHeap = srvHeap;
     mGbufferSrvOffset = gbufferSrvOffset;
@@ -31,6 +33,7 @@ void RenderingSystem::Init(
 
     mGeomCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(GeometryPassConstants));
     mGeomCB = std::make_unique<UploadBuffer<GeometryPassConstants>>(device, kMaxGeometryCBs, true);
+    mGeomInstances = std::make_unique<UploadBuffer<GeometryInstance>>(device, kMaxGeometryInstances, false);
     mLightCB = std::make_unique<UploadBuffer<LightingPassConstants>>(device, 1, true);
 
     BuildRootSignatures(device);
@@ -122,6 +125,33 @@ void RenderingSystem::SetGeometryPassConstants(
     cmdList->SetGraphicsRootConstantBufferView(0, addr);
 }
 
+UINT RenderingSystem::SetGeometryInstances(
+    ID3D12GraphicsCommandList* cmdList,
+    const GeometryInstance* instances,
+    UINT count)
+{
+    if (count > kMaxGeometryInstances)
+        count = kMaxGeometryInstances;
+
+    for (UINT i = 0; i < count; ++i)
+        mGeomInstances->CopyData((int)i, instances[i]);
+    cmdList->SetPipelineState(mGeometryInstancedPSO.Get());
+    cmdList->SetGraphicsRootShaderResourceView(3, mGeomInstances->Resource()->GetGPUVirtualAddress());
+    return count;
+}
+
+void RenderingSystem::SetPositionBounds(
+    ID3D12GraphicsCommandList* cmdList,
+    const BoundingBox& bounds)
+{
+    // cbSubmesh: float4 gPosCenter, float4 gPosExtents
+    const float constants[8] = {
+        bounds.Center.x, bounds.Center.y, bounds.Center.z, 0.0f,
+        bounds.Extents.x, bounds.Extents.y, bounds.Extents.z, 0.0f
+    };
+    cmdList->SetGraphicsRoot32BitConstants(2, _countof(constants), constants, 0);
+}
+
 void RenderingSystem::DoLightingPass(
     ID3D12GraphicsCommandList* cmdList,
     D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle,
@@ -169,12 +199,16 @@ void RenderingSystem::BuildRootSignatures(ID3D12Device* device)
         CD3DX12_DESCRIPTOR_RANGE texTable;
         texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
 
-        CD3DX12_ROOT_PARAMETER params[2];
+        // Слот 2: AABB сабмеша для распаковки сжатых позиций (b1), см. SetPositionBounds
+        // Слот 3: экземпляры для PSO с инстансингом (t1), см. SetGeometryInstances
+        CD3DX12_ROOT_PARAMETER params[4];
         params[0].InitAsConstantBufferView(0);
         params[1].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL);
+        params[2].InitAsConstants(8, 1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+        params[3].InitAsShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 
         auto sampler = CD3DX12_STATIC_SAMPLER_DESC(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR);
-        CD3DX12_ROOT_SIGNATURE_DESC desc(2, params, 1, &sampler,
+        CD3DX12_ROOT_SIGNATURE_DESC desc(4, params, 1, &sampler,
             D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
         ComPtr<ID3DBlob> serial, err;
@@ -209,14 +243,29 @@ void RenderingSystem::BuildRootSignatures(ID3D12Device* device)
 
 void RenderingSystem::BuildGeometryPassPSO(ID3D12Device* device, DXGI_FORMAT depthFmt)
 {
-    mGeomVS = d3dUtil::CompileShader(L"Shaders\\gbuffer.hlsl", nullptr, "VS", "vs_5_1");
-    mGeomPS = d3dUtil::CompileShader(L"Shaders\\gbuffer.hlsl", nullptr, "PS", "ps_5_1");
+    const bool compressed = mVertexFormat == VertexFormat::Compressed;
+    const D3D_SHADER_MACRO compressedDefines[] = { { "COMPRESSED_VERTICES", "1" }, { nullptr, nullptr } };
+    const D3D_SHADER_MACRO* defines = compressed ? compressedDefines : nullptr;
+    const D3D_SHADER_MACRO instancedDefines[] = { { "INSTANCED", "1" }, { nullptr, nullptr } };
+    const D3D_SHADER_MACRO compressedInstancedDefines[] = {
+        { "COMPRESSED_VERTICES", "1" }, { "INSTANCED", "1" }, { nullptr, nullptr } };
+    mGeomVS = d3dUtil::CompileShader(L"Shaders\\gbuffer.hlsl", defines, "VS", "vs_5_1");
+    mGeomInstancedVS = d3dUtil::CompileShader(L"Shaders\\gbuffer.hlsl",
+        compressed ? compressedInstancedDefines : instancedDefines, "VS", "vs_5_1");
+    mGeomPS = d3dUtil::CompileShader(L"Shaders\\gbuffer.hlsl", defines, "PS", "ps_5_1");
 
     std::vector<D3D12_INPUT_ELEMENT_DESC> inputLayout = {
         { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
         { "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
         { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
     };
+    // PackedVertex: UNORM16 позиция в AABB сабмеша, октаэдрическая нормаль, half UV — 16 байт
+    if (compressed)
+        inputLayout = {
+            { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0,  0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "NORMAL",   0, DXGI_FORMAT_R16G16_SNORM,       0,  8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT,       0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        };
 
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputLayout.data(), (UINT)inputLayout.size() };
@@ -238,6 +287,9 @@ void RenderingSystem::BuildGeometryPassPSO(ID3D12Device* device, DXGI_FORMAT dep
     psoDesc.DSVFormat = depthFmt;
 
     ThrowIfFailed(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mGeometryPSO)));
+
+    psoDesc.VS = { mGeomInstancedVS->GetBufferPointer(), mGeomInstancedVS->GetBufferSize() };
+    ThrowIfFailed(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mGeometryInstancedPSO)));
 }
 
 void RenderingSystem::BuildLightingPassPSO(ID3D12Device* device,
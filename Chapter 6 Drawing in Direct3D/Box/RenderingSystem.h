@@ -3,6 +3,7 @@
 #include "Common/d3dx12.h"
 #include "Common/UploadBuffer.h"
 #include "GBuffer.h"
+#include "VertexCompression.h"
 #include <vector>
 
 
@@ -34,6 +35,13 @@ struct GeometryPassConstants
     DirectX::XMFLOAT3    pad = {};
 };
 
+// Экземпляр для инстансинга (gbuffer.hlsl, INSTANCED): матрицы транспонированы, как в GeometryPassConstants
+struct GeometryInstance
+{
+    DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
+    DirectX::XMFLOAT4X4 WorldInvTranspose = MathHelper::Identity4x4();
+};
+
 
 static const int kMaxLights = 64;
 
@@ -70,7 +78,8 @@ public:
         ID3D12DescriptorHeap* rtvHeap,
         ID3D12DescriptorHeap* srvHeap,
         UINT gbufferRtvOffset,
-        UINT gbufferSrvOffset
+        UINT gbufferSrvOffset,
+        VertexFormat vertexFormat = VertexFormat::Full
     );
 
     void OnResize(
@@ -110,9 +119,24 @@ public:
         const GeometryPassConstants& constants,
         UINT cbIndex);
 
+    // Загружает экземпляры в structured buffer (t1) и ставит PSO с инстансингом до следующего
+    // BeginGeometryPass. Мировые матрицы берутся из экземпляров, gWorldViewProj в cbPerObject —
+    // это ViewProj. Буфер один — вызывать не чаще раза за кадр. Возвращает число загруженных,
+    // не больше kMaxGeometryInstances.
+    UINT SetGeometryInstances(
+        ID3D12GraphicsCommandList* cmdList,
+        const GeometryInstance* instances,
+        UINT count);
+
+    // Для VertexFormat::Compressed: AABB сабмеша, внутри которого квантованы позиции (root constants b1).
+    void SetPositionBounds(
+        ID3D12GraphicsCommandList* cmdList,
+        const DirectX::BoundingBox& bounds);
+
     ID3D12RootSignature* GetGeometryRootSignature() const { return mGeometryRootSig.Get(); }
     ID3D12PipelineState* GetGeometryPSO()           const { return mGeometryPSO.Get(); }
     ID3D12Resource* GetGeometryCBResource()    const { return mGeomCB->Resource(); }
+    UINT            GetMaxGeometryCBs()        const { return kMaxGeometryCBs; }
 
     void DoLightingPass(ID3D12GraphicsCommandList* cmdList,
         D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle,
@@ -138,15 +162,19 @@ private:
     Microsoft::WRL::ComPtr<ID3D12RootSignature> mGeometryRootSig;
     Microsoft::WRL::ComPtr<ID3D12RootSignature> mLightingRootSig;
     Microsoft::WRL::ComPtr<ID3D12PipelineState> mGeometryPSO;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> mGeometryInstancedPSO;
     Microsoft::WRL::ComPtr<ID3D12PipelineState> mLightingPSO;
 
     Microsoft::WRL::ComPtr<ID3DBlob> mGeomVS, mGeomPS;
+    Microsoft::WRL::ComPtr<ID3DBlob> mGeomInstancedVS;
     Microsoft::WRL::ComPtr<ID3DBlob> mLightVS, mLightPS;
 
     std::unique_ptr<UploadBuffer<GeometryPassConstants>>  mGeomCB;
     std::unique_ptr<UploadBuffer<LightingPassConstants>>  mLightCB;
     UINT mGeomCBByteSize = 0;
     static const UINT kMaxGeometryCBs = 512;
+    std::unique_ptr<UploadBuffer<GeometryInstance>>       mGeomInstances;
+    static const UINT kMaxGeometryInstances = 1024;
 
     std::vector<LightData> mLights;
 
@@ -159,4 +187,5 @@ private:
 
     DXGI_FORMAT mBackBufferFormat = DXGI_FORMAT_UNKNOWN;
     DXGI_FORMAT mDepthStencilFormat = DXGI_FORMAT_UNKNOWN;
+    VertexFormat mVertexFormat = VertexFormat::Full;
 };
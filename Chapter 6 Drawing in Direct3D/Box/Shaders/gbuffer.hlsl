@@ -17,12 +17,47 @@ cbuffer cbPerObject : register(b0)
     float3    pad;
 };
 
+#ifdef INSTANCED
+// GeometryInstance (RenderingSystem.h):   , gWorldViewProj  ViewProj
+struct InstanceData
+{
+    float4x4 World;
+    float4x4 WorldInvTranspose;
+};
+StructuredBuffer<InstanceData> gInstances : register(t1);
+#endif
+
+#ifdef COMPRESSED_VERTICES
+// PackedVertex (VertexCompression.h):   UNORM16  AABB ,
+//      SNORM16, UV  half (   float)
+cbuffer cbSubmesh : register(b1)
+{
+    float4 gPosCenter;
+    float4 gPosExtents;
+};
+
+struct VertexIn
+{
+    float4 PosN    : POSITION;
+    float2 NormalO : NORMAL;
+    float2 TexC    : TEXCOORD;
+};
+
+float3 OctDecode(float2 e)
+{
+    float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += (n.xy >= 0.0f) ? -t : t;
+    return normalize(n);
+}
+#else
 struct VertexIn
 {
     float3 PosL    : POSITION;
     float3 NormalL : NORMAL;
     float2 TexC    : TEXCOORD;
 };
+#endif
 
 struct VertexOut
 {
@@ -32,12 +67,26 @@ struct VertexOut
     float2 TexC    : TEXCOORD;
 };
 
-VertexOut VS(VertexIn vin)
+VertexOut VS(VertexIn vin, uint instanceID : SV_InstanceID)
 {
     VertexOut vout;
-    vout.PosH    = mul(float4(vin.PosL, 1.0f), gWorldViewProj);
-    vout.PosW    = mul(float4(vin.PosL, 1.0f), gWorld).xyz;
-    vout.NormalW = mul(vin.NormalL, (float3x3)gWorldInvTranspose);
+#ifdef COMPRESSED_VERTICES
+    float3 posL    = gPosCenter.xyz + (vin.PosN.xyz * 2.0f - 1.0f) * gPosExtents.xyz;
+    float3 normalL = OctDecode(vin.NormalO);
+#else
+    float3 posL    = vin.PosL;
+    float3 normalL = vin.NormalL;
+#endif
+#ifdef INSTANCED
+    InstanceData inst = gInstances[instanceID];
+    vout.PosW    = mul(float4(posL, 1.0f), inst.World).xyz;
+    vout.PosH    = mul(float4(vout.PosW, 1.0f), gWorldViewProj);
+    vout.NormalW = mul(normalL, (float3x3)inst.WorldInvTranspose);
+#else
+    vout.PosH    = mul(float4(posL, 1.0f), gWorldViewProj);
+    vout.PosW    = mul(float4(posL, 1.0f), gWorld).xyz;
+    vout.NormalW = mul(normalL, (float3x3)gWorldInvTranspose);
+#endif
     vout.TexC    = vin.TexC;
     return vout;
 }
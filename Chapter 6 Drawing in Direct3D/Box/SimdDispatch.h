@@ -0,0 +1,16 @@
+#pragma once
+
+// Ядра с вариантами Scalar / SSE / AVX2 (IntersectTriangles, CullAabbs, RasterizeTriangle):
+// диспетчер без суффикса при первом вызове выбирает лучший вариант для текущего CPU — AVX2,
+// иначе SSE. Варианты одного ядра считают в одном порядке и без FMA, поэтому результаты совпадают.
+
+// MSVC разрешает AVX-интринсики без /arch:AVX2, GCC/Clang — только в функциях с target.
+// BMI1 и POPCNT есть у всех CPU с AVX2, отдельной проверки для них нет.
+#if defined(__GNUC__) || defined(__clang__)
+#define AVX2_TARGET __attribute__((target("avx2,bmi,popcnt")))
+#else
+#define AVX2_TARGET
+#endif
+
+// AVX2 поддержан CPU, а ОС сохраняет YMM-регистры.
+bool CpuSupportsAVX2();
@@ -0,0 +1,129 @@
+#include "Tools.h"
+#include "BVHCache.h"
+#include "MappedFile.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+    // Копия кэша с испорченным заголовком или узлом должна отвергаться, а не попадать в обход
+    bool CorruptedRejected(const std::string& cachePath, uint64_t hash, size_t indexCount)
+    {
+        std::ifstream in(cachePath, std::ios::binary);
+        std::vector<char> original((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        BVHCacheHeader h;
+        std::memcpy(&h, original.data(), sizeof(h));
+
+        size_t leaf = 0;
+        for (uint32_t i = 0; i < h.NodeCount; ++i)
+        {
+            BVHNode node;
+            std::memcpy(&node, original.data() + h.NodesOffset + i * sizeof(BVHNode), sizeof(node));
+            if (node.IsLeaf()) { leaf = i; break; }
+        }
+
+        const std::string corruptPath = cachePath + ".corrupt";
+        bool rejected = true;
+        for (int variant = 0; variant < 4; ++variant)
+        {
+            std::vector<char> bytes = original;
+            BVHCacheHeader* header = (BVHCacheHeader*)bytes.data();
+            BVHNode* nodes = (BVHNode*)(bytes.data() + h.NodesOffset);
+            uint32_t* triIds = (uint32_t*)(bytes.data() + h.TriIdsOffset);
+            switch (variant)
+            {
+            case 0: header->Depth = kBVHMaxDepth + 1; break;
+            case 1: if (!nodes[0].IsLeaf()) nodes[0].LeftFirst = h.NodeCount; else nodes[0].TriCount = h.TriCount + 1; break;
+            case 2: nodes[leaf].TriCount = h.TriCount; nodes[leaf].LeftFirst = 1; break;
+            case 3: triIds[0] = (uint32_t)(indexCount / 3); break;
+            }
+            std::ofstream(corruptPath, std::ios::binary | std::ios::trunc).write(bytes.data(), (std::streamsize)bytes.size());
+            BVH bvh;
+            rejected = rejected && !LoadBVHCache(corruptPath, hash, indexCount, bvh);
+        }
+        std::remove(corruptPath.c_str());
+        return rejected;
+    }
+}
+
+int RunBVHCache(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    size_t rayCount = argc > 1 ? (size_t)std::atoi(argv[1]) : 20000;
+
+    std::vector<XMFLOAT3> verts;
+    std::vector<uint32_t> indices;
+    if (!LoadObjTriangleSoup(path, verts, indices)) return 1;
+
+    WorldVertexCache cache;
+    cache.AddRange(verts.data(), verts.size(), sizeof(XMFLOAT3));
+    const PositionsSoA positions = cache.WorldPositions();
+
+    uint64_t hash = 0;
+    ScopedTimer hashTimer;
+    if (!HashFile64(path, hash)) return 1;
+    double hashMs = hashTimer.ElapsedMs();
+
+    BVH built;
+    ScopedTimer buildTimer;
+    built.Build(positions, indices.data(), indices.size());
+    double buildMs = buildTimer.ElapsedMs();
+
+    std::string cachePath = BVHCachePath(path);
+    ScopedTimer saveTimer;
+    if (!SaveBVHCache(cachePath, built, hash, indices.size()))
+    {
+        std::fprintf(stderr, "failed to write %s\n", cachePath.c_str());
+        return 1;
+    }
+    double saveMs = saveTimer.ElapsedMs();
+
+    BVH mapped;
+    ScopedTimer loadTimer;
+    if (!LoadBVHCache(cachePath, hash, indices.size(), mapped))
+    {
+        std::fprintf(stderr, "failed to load %s\n", cachePath.c_str());
+        return 1;
+    }
+    double loadMs = loadTimer.ElapsedMs();
+
+    // Чужой хэш и чужой размер index buffer должны отвергаться
+    BVH rejected;
+    bool staleRejected = !LoadBVHCache(cachePath, hash ^ 1, indices.size(), rejected) &&
+        !LoadBVHCache(cachePath, hash, indices.size() + 3, rejected);
+    bool corruptRejected = CorruptedRejected(cachePath, hash, indices.size());
+
+    MappedFile file;
+    file.Open(cachePath);
+    std::printf("%s: %zu triangles, hash %016llx (%.1f ms)\n", path.c_str(), indices.size() / 3,
+        (unsigned long long)hash, hashMs);
+    std::printf("build %.1f ms, save %.1f ms, mapped load %.3f ms, %s %.2f MB, %zu nodes\n",
+        buildMs, saveMs, loadMs, cachePath.c_str(), file.Size() / (1024.0 * 1024.0), mapped.NodeCount());
+
+    // Обход по отображённому файлу должен совпадать с обходом по собранному дереву
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> sym(-1.0f, 1.0f);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < rayCount; ++i)
+    {
+        const XMFLOAT3& o = verts[rng() % verts.size()];
+        XMVECTOR orig = XMVectorSet(o.x + sym(rng), o.y + sym(rng), o.z + sym(rng), 1.0f);
+        XMVECTOR dir = XMVector3Normalize(XMVectorSet(sym(rng), sym(rng), sym(rng), 0.0f));
+
+        RayHit a, b;
+        bool ha = built.IntersectClosest(orig, dir, 0.001f, FLT_MAX, a);
+        bool hb = mapped.IntersectClosest(orig, dir, 0.001f, FLT_MAX, b);
+        if (ha != hb || a.TriangleId != b.TriangleId || std::memcmp(&a.T, &b.T, sizeof(float)) != 0)
+            ++mismatches;
+    }
+    std::printf("stale keys rejected: %s, corrupted nodes rejected: %s, mismatches %zu/%zu\n",
+        staleRejected ? "yes" : "NO", corruptRejected ? "yes" : "NO", mismatches, rayCount);
+    return mismatches == 0 && staleRejected && corruptRejected ? 0 : 2;
+}
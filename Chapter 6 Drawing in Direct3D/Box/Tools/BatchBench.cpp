@@ -0,0 +1,143 @@
+#include "Tools.h"
+#include "RaycastBatch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+    const size_t kRaysPerVolley = 250;
+
+    // Скриптовые залпы: камера на орбите, лучи конусом вокруг направления в центр.
+    std::vector<RayQuery> MakeVolleys(size_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> theta(0.0f, 2.0f * XM_PI);
+        std::uniform_real_distribution<float> phi(0.1f, XM_PI - 0.1f);
+        std::uniform_real_distribution<float> radius(1.0f, 150.0f);
+        std::uniform_real_distribution<float> spread(-0.15f, 0.15f);
+
+        std::vector<RayQuery> rays(count);
+        XMVECTOR eye = XMVectorZero(), dir = XMVectorZero(), right = XMVectorZero(), up = XMVectorZero();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i % kRaysPerVolley == 0)
+            {
+                float t = theta(rng), p = phi(rng), rad = radius(rng);
+                eye = XMVectorSet(rad * sinf(p) * cosf(t), rad * cosf(p), rad * sinf(p) * sinf(t), 1.0f);
+                dir = XMVector3Normalize(XMVectorNegate(eye));
+                right = XMVector3Normalize(XMVector3Cross(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), dir));
+                up = XMVector3Cross(dir, right);
+            }
+            XMVECTOR d = XMVector3Normalize(dir + right * spread(rng) + up * spread(rng));
+            XMStoreFloat3(&rays[i].Origin, eye + dir * 0.12f);
+            XMStoreFloat3(&rays[i].Dir, d);
+        }
+        return rays;
+    }
+
+    bool SameHit(const RayQueryHit& a, const RayQueryHit& b)
+    {
+        return a.TriangleId == b.TriangleId && a.SubmeshId == b.SubmeshId &&
+            std::memcmp(&a.T, &b.T, sizeof(float)) == 0;
+    }
+}
+
+int RunBatchBench(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    size_t raysPerFrame = argc > 1 ? (size_t)std::atoi(argv[1]) : 10000;
+    size_t frames = argc > 2 ? (size_t)std::atoi(argv[2]) : 30;
+
+    std::vector<XMFLOAT3> verts;
+    std::vector<uint32_t> indices, shapeFirst;
+    if (!LoadObjTriangleSoup(path, verts, indices, &shapeFirst)) return 1;
+
+    WorldVertexCache cache;
+    cache.AddRange(verts.data(), verts.size(), sizeof(XMFLOAT3));
+    BVH bvh;
+    bvh.Build(cache.WorldPositions(), indices.data(), indices.size());
+
+    SubmeshTable submeshes;
+    for (size_t i = 0; i < shapeFirst.size(); ++i)
+    {
+        uint32_t end = i + 1 < shapeFirst.size() ? shapeFirst[i + 1] : (uint32_t)indices.size();
+        submeshes.Add(shapeFirst[i] / 3, (end - shapeFirst[i]) / 3);
+    }
+
+    WorkerPool pool;
+    std::printf("%s: %zu triangles, %zu submeshes, %zu rays/frame x %zu frames, %u workers + caller\n",
+        path.c_str(), indices.size() / 3, submeshes.Count(), raysPerFrame, frames, pool.ThreadCount());
+
+    std::mt19937 rng(2024);
+    std::vector<std::vector<RayQuery>> frameRays(frames);
+    for (auto& f : frameRays)
+        f = MakeVolleys(raysPerFrame, rng);
+
+    // Эталон: поштучные запросы в исходном порядке.
+    std::vector<std::vector<RayQueryHit>> reference(frames);
+    ScopedTimer refTimer;
+    size_t hits = 0;
+    for (size_t f = 0; f < frames; ++f)
+    {
+        reference[f].resize(raysPerFrame);
+        for (size_t i = 0; i < raysPerFrame; ++i)
+        {
+            const RayQuery& r = frameRays[f][i];
+            RayHit hit;
+            if (!bvh.IntersectClosest(XMLoadFloat3(&r.Origin), XMLoadFloat3(&r.Dir), r.TMin, r.TMax, hit))
+                continue;
+            reference[f][i].T = hit.T;
+            reference[f][i].TriangleId = hit.TriangleId;
+            reference[f][i].SubmeshId = submeshes.Find(hit.TriangleId);
+            ++hits;
+        }
+    }
+    double refMs = refTimer.ElapsedMs() / frames;
+
+    struct Variant
+    {
+        const char* Name;
+        bool        Sort;
+        WorkerPool* Pool;
+    };
+    const Variant variants[] = {
+        { "batch unsorted",        false, nullptr },
+        { "batch sorted",          true,  nullptr },
+        { "batch unsorted pooled", false, &pool },
+        { "batch sorted pooled",   true,  &pool },
+    };
+
+    std::printf("%-24s %9s %9s %8s %10s\n", "variant", "ms/frame", "Mrays/s", "speedup", "mismatches");
+    std::printf("%-24s %9.3f %9.2f %8.2f %10s  (%zu hits)\n", "per-ray reference", refMs,
+        raysPerFrame / (refMs * 1e3), 1.0, "-", hits);
+
+    size_t totalMismatches = 0;
+    std::vector<RayQueryHit> out(raysPerFrame);
+    for (const auto& v : variants)
+    {
+        RaycastBatch batch;
+        batch.SetSortRays(v.Sort);
+
+        size_t mismatches = 0;
+        double ms = 0.0;
+        for (size_t f = 0; f < frames; ++f)
+        {
+            ScopedTimer timer;
+            batch.Trace(bvh, &submeshes, frameRays[f].data(), raysPerFrame, out.data(), v.Pool);
+            ms += timer.ElapsedMs();
+
+            for (size_t i = 0; i < raysPerFrame; ++i)
+                if (!SameHit(out[i], reference[f][i]))
+                    ++mismatches;
+        }
+        ms /= frames;
+        totalMismatches += mismatches;
+        std::printf("%-24s %9.3f %9.2f %8.2f %10zu\n", v.Name, ms,
+            raysPerFrame / (ms * 1e3), refMs / ms, mismatches);
+    }
+
+    return totalMismatches == 0 ? 0 : 2;
+}
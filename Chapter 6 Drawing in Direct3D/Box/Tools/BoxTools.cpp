@@ -0,0 +1,87 @@
+#include "Tools.h"
+#include "ModelImporter.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace DirectX;
+
+struct ToolCommand
+{
+    const char* Name;
+    int (*Run)(int argc, char** argv);
+    const char* Help;
+};
+
+static const ToolCommand kCommands[] = {
+    { "raycast-bench",   RunRaycastBench,  "[obj] [rays]  BVH vs linear closest-hit on the triangle soup" },
+    { "kernel-bench",    RunKernelBench,   "[obj] [rays]  scalar/SSE/AVX2 ray-triangle kernels: bit-exact check, Mtri/s" },
+    { "parallel-bench",  RunParallelBench, "[obj] [rays] [chunk]  linear closest-hit on a worker pool: thread-count sweep" },
+    { "batch-bench",     RunBatchBench,    "[obj] [rays/frame] [frames]  RaycastBatch throughput: sorted/unsorted, pooled" },
+    { "bvh-cache",       RunBVHCache,      "[obj] [rays]  write <obj>.bvh, map it back and compare traversal with a fresh build" },
+    { "wide-bench",      RunWideBench,     "[obj] [rays]  quantized 4-wide BVH vs binary: memory footprint and rays/s" },
+    { "mesh-stats",      RunMeshStats,     "[obj...]  welding, cache/overdraw/fetch reordering: VB size, ACMR/ATVR/overdraw per stage (default: Sponza and star)" },
+    { "mesh-pack",       RunMeshPack,      "[obj] [out]  import the OBJ and write the binary mesh package (default: <obj>.mesh)" },
+    { "mesh-load-bench", RunMeshLoadBench, "[obj] [iterations]  OBJ parse+import vs mapped package: load time and identical blobs" },
+    { "obj-parse-bench", RunObjParseBench, "[obj] [iterations]  chunked parallel OBJ parser vs tinyobj: MB/s per thread count, identical output" },
+    { "obj-token-bench", RunObjTokenBench, "[obj...]  single-thread OBJ tokenizing, tinyobj vs from_chars: MB/s on synthetic and real files" },
+    { "obj-stream",      RunObjStream,     "[obj]  streaming import vs full import: resident memory, identical submeshes" },
+    { "vertex-compress", RunVertexCompress, "[obj...]  16-byte packed vertices: half/octahedral/UNORM16 error bounds and VB size" },
+    { "meshlet-stats",   RunMeshletStats,  "[obj] [poses]  64/124 meshlets with spheres and normal cones: fill, determinism, culling per camera pose" },
+    { "lod-stats",       RunLodStats,      "[obj]  QEM LOD chains: triangles per level, error check, screen-space selection by distance" },
+    { "cull-bench",      RunCullBench,     "[boxes] [iterations]  SoA AABB frustum culling on a synthetic scene (default 1M boxes): scalar/SSE/AVX2/parallel" },
+    { "occlusion-bench", RunOcclusionBench, "[obj] [path]  256x128 software occlusion: replay a camera path (default camera_path.txt), kernels, false occlusion check" },
+    { "occluder-build",  RunOccluderBuild, "[obj] [out] [path]  offline planar occluder mesh (default: <obj>.occ): triangles vs surface and screen coverage per budget" },
+};
+
+bool LoadObjTriangleSoup(const std::string& path,
+    std::vector<XMFLOAT3>& positions,
+    std::vector<uint32_t>& indices,
+    std::vector<uint32_t>* shapeFirstIndex)
+{
+    ObjModel    model;
+    std::string error;
+    if (!LoadObjModel(path, model, &error))
+    {
+        std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+
+    const auto& attrib = model.Attrib;
+    for (const auto& shape : model.Shapes)
+    {
+        if (shapeFirstIndex)
+            shapeFirstIndex->push_back((uint32_t)indices.size());
+        for (const auto& index : shape.mesh.indices)
+        {
+            positions.push_back({
+                attrib.vertices[3 * index.vertex_index + 0],
+                attrib.vertices[3 * index.vertex_index + 1],
+                attrib.vertices[3 * index.vertex_index + 2] });
+            indices.push_back((uint32_t)(positions.size() - 1));
+        }
+    }
+    return true;
+}
+
+static void PrintUsage()
+{
+    std::printf("usage: BoxTools <command> [args]\n");
+    for (const auto& c : kCommands)
+        std::printf("  %-16s %s\n", c.Name, c.Help);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    for (const auto& c : kCommands)
+        if (std::strcmp(argv[1], c.Name) == 0)
+            return c.Run(argc - 2, argv + 2);
+
+    PrintUsage();
+    return 1;
+}
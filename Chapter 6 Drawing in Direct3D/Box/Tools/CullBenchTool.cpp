@@ -0,0 +1,133 @@
+#include "Tools.h"
+#include "FrustumCull.h"
+#include "RayTriangle.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+    // Синтетическая сцена: боксы 1..8 единиц равномерно в кубе 2000^3
+    void MakeScene(size_t count, AabbStream& boxes)
+    {
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> pos(-1000.0f, 1000.0f), ext(0.5f, 4.0f);
+        boxes.Resize(count);
+        for (size_t i = 0; i < count; ++i)
+            boxes.Set(i, { pos(rng), pos(rng), pos(rng) }, { ext(rng), ext(rng), ext(rng) });
+    }
+
+    // Камеры по кругу, fovY 45°, 16:9, near 1, far 1000 — видна небольшая доля сцены
+    std::vector<FrustumPlanes> MakeViews(int count)
+    {
+        std::vector<FrustumPlanes> views;
+        XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 1.0f, 1000.0f);
+        for (int i = 0; i < count; ++i)
+        {
+            float a = 2.0f * XM_PI * (float)i / (float)count;
+            XMVECTOR eye = XMVectorSet(std::cos(a) * 200.0f, 50.0f * std::sin(3.0f * a), std::sin(a) * 200.0f, 1.0f);
+            XMVECTOR at = XMVectorSet(std::cos(a + 1.0f) * 600.0f, 0.0f, std::sin(a + 1.0f) * 600.0f, 1.0f);
+            XMMATRIX view = XMMatrixLookAtLH(eye, at, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+            views.push_back(ExtractFrustumPlanes(view * proj));
+        }
+        return views;
+    }
+
+    // Эталон в double: видимые боксы с запасом больше eps не должны отсекаться, и наоборот
+    size_t CountMisclassified(const AabbSoA& boxes, const FrustumPlanes& f, const std::vector<uint32_t>& visible)
+    {
+        const double eps = 1e-3;
+        size_t wrong = 0, next = 0;
+        for (size_t i = 0; i < boxes.Count; ++i)
+        {
+            double margin = 1e300;
+            for (const XMFLOAT4& p : f.Planes)
+            {
+                double dist = (double)p.x * boxes.Center[0][i] + (double)p.y * boxes.Center[1][i] +
+                    (double)p.z * boxes.Center[2][i] + p.w;
+                double radius = std::fabs((double)p.x) * boxes.Extents[0][i] +
+                    std::fabs((double)p.y) * boxes.Extents[1][i] + std::fabs((double)p.z) * boxes.Extents[2][i];
+                margin = std::min(margin, dist + radius);
+            }
+            bool reported = next < visible.size() && visible[next] == i;
+            next += reported;
+            if (std::fabs(margin) > eps && reported != (margin >= 0.0)) ++wrong;
+        }
+        return wrong;
+    }
+
+    struct Variant
+    {
+        const char* Name;
+        CullAabbsFn Kernel;   // nullptr — CullAabbsParallel
+    };
+}
+
+int RunCullBench(int argc, char** argv)
+{
+    size_t boxCount = argc > 0 ? (size_t)std::max(1, std::atoi(argv[0])) : 1000000;
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10;
+    const int viewCount = 8;
+
+    AabbStream stream;
+    MakeScene(boxCount, stream);
+    AabbSoA boxes = stream.View();
+    std::vector<FrustumPlanes> views = MakeViews(viewCount);
+    WorkerPool pool;
+
+    // Эталонный порядок и состав — у скалярного варианта
+    std::vector<std::vector<uint32_t>> reference(views.size());
+    size_t visibleTotal = 0, misclassified = 0;
+    for (size_t v = 0; v < views.size(); ++v)
+    {
+        reference[v].resize(boxCount);
+        reference[v].resize(CullAabbsScalar(boxes, 0, boxCount, views[v], reference[v].data()));
+        visibleTotal += reference[v].size();
+        misclassified += CountMisclassified(boxes, views[v], reference[v]);
+    }
+    std::printf("%zu boxes, %d views, %.2f%% visible on average, %zu misclassified vs double reference\n",
+        boxCount, viewCount, 100.0 * visibleTotal / ((double)boxCount * viewCount), misclassified);
+
+    std::vector<Variant> variants = { { "scalar", CullAabbsScalar }, { "sse", CullAabbsSSE } };
+    if (CpuSupportsAVX2()) variants.push_back({ "avx2", CullAabbsAVX2 });
+    variants.push_back({ "parallel", nullptr });
+
+    bool identical = true;
+    double scalarMs = 0.0;
+    std::vector<uint32_t> visible(boxCount);
+    std::printf("variant     best ms/view   Mboxes/s   speedup   result\n");
+    for (const Variant& variant : variants)
+    {
+        double best = 1e30;
+        bool same = true;
+        for (int it = 0; it < iterations; ++it)
+        {
+            ScopedTimer timer;
+            for (size_t v = 0; v < views.size(); ++v)
+            {
+                if (variant.Kernel)
+                {
+                    visible.resize(boxCount);
+                    visible.resize(variant.Kernel(boxes, 0, boxCount, views[v], visible.data()));
+                }
+                else
+                {
+                    CullAabbsParallel(pool, boxes, views[v], visible);
+                }
+                if (it == 0) same = same && visible == reference[v];
+            }
+            best = std::min(best, timer.ElapsedMs() / views.size());
+        }
+        if (variant.Kernel == CullAabbsScalar) scalarMs = best;
+        identical = identical && same;
+        std::printf("%-10s  %12.3f  %9.1f  %7.2fx   %s\n", variant.Name, best, boxCount / best / 1000.0,
+            scalarMs / best, same ? "identical" : "DIFFERENT");
+    }
+    std::printf("parallel: %u worker threads + caller\n", pool.ThreadCount());
+
+    return identical && misclassified == 0 ? 0 : 2;
+}
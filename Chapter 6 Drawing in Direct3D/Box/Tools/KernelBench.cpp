@@ -0,0 +1,126 @@
+#include "Tools.h"
+#include "RayTriangle.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+    struct KernelVariant
+    {
+        const char*          Name;
+        IntersectTrianglesFn Fn;
+    };
+
+    struct KernelRay
+    {
+        XMFLOAT3 Origin;
+        XMFLOAT3 Dir;
+    };
+
+    std::vector<KernelRay> MakeRays(size_t count, const PositionsSoA& p)
+    {
+        XMFLOAT3 mn = { FLT_MAX, FLT_MAX, FLT_MAX }, mx = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (size_t i = 0; i < p.Count; ++i)
+        {
+            mn = { std::min(mn.x, p.X[i]), std::min(mn.y, p.Y[i]), std::min(mn.z, p.Z[i]) };
+            mx = { std::max(mx.x, p.X[i]), std::max(mx.y, p.Y[i]), std::max(mx.z, p.Z[i]) };
+        }
+
+        // Начала внутри сцены, направления случайные: много попаданий на разных t.
+        std::mt19937 rng(77);
+        std::uniform_real_distribution<float> u01(0.0f, 1.0f), sym(-1.0f, 1.0f);
+        std::vector<KernelRay> rays(count);
+        for (auto& r : rays)
+        {
+            r.Origin = { mn.x + (mx.x - mn.x) * u01(rng), mn.y + (mx.y - mn.y) * u01(rng), mn.z + (mx.z - mn.z) * u01(rng) };
+            XMStoreFloat3(&r.Dir, XMVector3Normalize(XMVectorSet(sym(rng), sym(rng), sym(rng), 0.0f)));
+        }
+        return rays;
+    }
+
+    bool SameResult(uint32_t ia, float ta, uint32_t ib, float tb)
+    {
+        return ia == ib && std::memcmp(&ta, &tb, sizeof(float)) == 0;
+    }
+}
+
+int RunKernelBench(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    size_t rayCount = argc > 1 ? (size_t)std::atoi(argv[1]) : 64;
+
+    std::vector<XMFLOAT3> verts;
+    std::vector<uint32_t> indices;
+    if (!LoadObjTriangleSoup(path, verts, indices)) return 1;
+
+    WorldVertexCache cache;
+    cache.AddRange(verts.data(), verts.size(), sizeof(XMFLOAT3));
+    TriangleStream stream;
+    stream.Build(cache.WorldPositions(), indices.data(), indices.size() / 3);
+    const TrianglesSoA tris = stream.View();
+    if (tris.Count == 0) return 1;
+    std::printf("%s: %zu triangles, AVX2 %s\n", path.c_str(), tris.Count, CpuSupportsAVX2() ? "yes" : "no");
+
+    std::vector<KernelVariant> variants = {
+        { "scalar", IntersectTrianglesScalar },
+        { "sse",    IntersectTrianglesSSE },
+    };
+    if (CpuSupportsAVX2())
+        variants.push_back({ "avx2", IntersectTrianglesAVX2 });
+
+    std::vector<KernelRay> rays = MakeRays(rayCount, cache.WorldPositions());
+
+    // Побитовое сравнение с эталоном: весь поток и случайные поддиапазоны (хвосты < 8).
+    std::mt19937 rng(5);
+    size_t checks = 0, mismatches = 0;
+    for (const auto& r : rays)
+    {
+        for (int pass = 0; pass < 8; ++pass)
+        {
+            size_t first = 0, count = tris.Count;
+            if (pass > 0)
+            {
+                first = rng() % tris.Count;
+                count = 1 + rng() % std::min<size_t>(tris.Count - first, 37);
+            }
+
+            float    refT = FLT_MAX;
+            uint32_t refIdx = IntersectTrianglesScalar(tris, first, count, r.Origin, r.Dir, 0.001f, refT);
+            for (size_t v = 1; v < variants.size(); ++v)
+            {
+                float    t = FLT_MAX;
+                uint32_t idx = variants[v].Fn(tris, first, count, r.Origin, r.Dir, 0.001f, t);
+                ++checks;
+                if (!SameResult(refIdx, refT, idx, t))
+                {
+                    if (mismatches < 8)
+                        std::printf("  mismatch %s: [%zu,+%zu) ref %u/%.9g got %u/%.9g\n",
+                            variants[v].Name, first, count, refIdx, refT, idx, t);
+                    ++mismatches;
+                }
+            }
+        }
+    }
+    std::printf("bit-exact check: %zu comparisons, %zu mismatches\n", checks, mismatches);
+
+    for (const auto& v : variants)
+    {
+        size_t hits = 0;
+        ScopedTimer timer;
+        for (const auto& r : rays)
+        {
+            float t = FLT_MAX;
+            hits += v.Fn(tris, 0, tris.Count, r.Origin, r.Dir, 0.001f, t) != UINT32_MAX ? 1 : 0;
+        }
+        double ms = timer.ElapsedMs();
+        double triPerSec = (double)tris.Count * rays.size() / (ms * 1e-3);
+        std::printf("%-7s %8.2f ms  %7.1f Mtri/s  (%zu hits)\n", v.Name, ms, triPerSec * 1e-6, hits);
+    }
+
+    return mismatches == 0 ? 0 : 2;
+}
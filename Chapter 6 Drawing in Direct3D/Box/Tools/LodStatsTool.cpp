@@ -0,0 +1,177 @@
+#include "Tools.h"
+#include "MeshSimplifier.h"
+#include "ModelImporter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    struct Vec3
+    {
+        double x, y, z;
+    };
+
+    Vec3 Sub(Vec3 a, Vec3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    Vec3 Add(Vec3 a, Vec3 b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+    Vec3 Scale(Vec3 a, double s) { return { a.x * s, a.y * s, a.z * s }; }
+    double Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vec3 ToVec(const DirectX::XMFLOAT3& p) { return { p.x, p.y, p.z }; }
+
+    // Ближайшая точка треугольника (Ericson, Real-Time Collision Detection, 5.1.5)
+    double PointTriangleDistance(Vec3 p, Vec3 a, Vec3 b, Vec3 c)
+    {
+        Vec3 ab = Sub(b, a), ac = Sub(c, a), ap = Sub(p, a);
+        double d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+        Vec3 q;
+        if (d1 <= 0 && d2 <= 0) q = a;
+        else
+        {
+            Vec3 bp = Sub(p, b);
+            double d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+            Vec3 cp = Sub(p, c);
+            double d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+            double vc = d1 * d4 - d3 * d2, vb = d5 * d2 - d1 * d6, va = d3 * d6 - d5 * d4;
+            if (d3 >= 0 && d4 <= d3) q = b;
+            else if (d6 >= 0 && d5 <= d6) q = c;
+            else if (vc <= 0 && d1 >= 0 && d3 <= 0) q = Add(a, Scale(ab, d1 / (d1 - d3)));
+            else if (vb <= 0 && d2 >= 0 && d6 <= 0) q = Add(a, Scale(ac, d2 / (d2 - d6)));
+            else if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+                q = Add(b, Scale(Sub(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+            else
+            {
+                double denom = 1.0 / (va + vb + vc);
+                q = Add(a, Add(Scale(ab, vb * denom), Scale(ac, vc * denom)));
+            }
+        }
+        Vec3 d = Sub(p, q);
+        return std::sqrt(Dot(d, d));
+    }
+
+    // Отклонение вершин LOD0 от поверхности уровня — нижняя оценка расстояния Хаусдорфа.
+    // Перебор, поэтому только на сабмешах до kMeasureMaxWork пар вершина-треугольник.
+    const double kMeasureMaxWork = 2e7;
+
+    double MeasureDeviation(const ImportedMesh& mesh, const ImportedSubmesh& s, const MeshLod& lod)
+    {
+        double worst = 0.0;
+        const uint32_t* tris = mesh.LodIndices.data() + lod.FirstIndex;
+        for (uint32_t v = s.FirstVertex; v < s.FirstVertex + s.VertexCount; ++v)
+        {
+            Vec3 p = ToVec(mesh.Vertices[v].Pos);
+            double best = 1e300;
+            for (uint32_t t = 0; t < lod.IndexCount && best > worst; t += 3)
+                best = std::min(best, PointTriangleDistance(p, ToVec(mesh.Vertices[tris[t]].Pos),
+                    ToVec(mesh.Vertices[tris[t + 1]].Pos), ToVec(mesh.Vertices[tris[t + 2]].Pos)));
+            worst = std::max(worst, best);
+        }
+        return worst;
+    }
+
+    // Индексы уровня — в пределах вершин сабмеша, без вырожденных треугольников; уровни
+    // убывают по треугольникам, ошибка не убывает
+    bool ValidChain(const ImportedMesh& mesh, const ImportedSubmesh& s)
+    {
+        uint32_t previous = s.IndexCount;
+        float previousError = 0.0f;
+        for (uint32_t l = 0; l < s.LodCount; ++l)
+        {
+            const MeshLod& lod = mesh.Lods[s.FirstLod + l];
+            if (lod.IndexCount % 3 != 0 || lod.IndexCount >= previous || lod.Error < previousError) return false;
+            const uint32_t* tris = mesh.LodIndices.data() + lod.FirstIndex;
+            for (uint32_t t = 0; t < lod.IndexCount; t += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                    if (tris[t + k] < s.FirstVertex || tris[t + k] >= s.FirstVertex + s.VertexCount) return false;
+                if (tris[t] == tris[t + 1] || tris[t + 1] == tris[t + 2] || tris[t] == tris[t + 2]) return false;
+            }
+            previous = lod.IndexCount;
+            previousError = lod.Error;
+        }
+        return true;
+    }
+}
+
+int RunLodStats(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+
+    ObjModel    model;
+    std::string error;
+    if (!LoadObjModel(path, model, &error))
+    {
+        std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+    ImportedMesh mesh;
+    ImportObjMesh(model, mesh);
+
+    // Повторная сборка цепочек: время и детерминированность
+    std::vector<uint32_t> lodIndices;
+    std::vector<MeshLod>  lods;
+    ScopedTimer timer;
+    for (const ImportedSubmesh& s : mesh.Submeshes)
+    {
+        std::vector<uint32_t> local(mesh.Indices.begin() + s.FirstIndex, mesh.Indices.begin() + s.FirstIndex + s.IndexCount);
+        for (uint32_t& i : local) i -= s.FirstVertex;
+        size_t first = lodIndices.size();
+        BuildLodChain(local.data(), local.size(), &mesh.Vertices[s.FirstVertex].Pos.x, s.VertexCount,
+            sizeof(MeshVertex), lodIndices, lods);
+        for (size_t i = first; i < lodIndices.size(); ++i) lodIndices[i] += s.FirstVertex;
+    }
+    double buildMs = timer.ElapsedMs();
+    bool deterministic = lodIndices == mesh.LodIndices && lods.size() == mesh.Lods.size() &&
+        std::equal(lods.begin(), lods.end(), mesh.Lods.begin(), [](const MeshLod& a, const MeshLod& b)
+            {
+                return a.FirstIndex == b.FirstIndex && a.IndexCount == b.IndexCount && a.Error == b.Error;
+            });
+
+    // Треугольники сцены на каждом уровне: сабмеш без такого уровня идёт своим самым грубым
+    size_t levelTris[kMaxLodCount] = {};
+    size_t withLods = 0, invalid = 0, measured = 0;
+    double worstRatio = 0.0;
+    for (const ImportedSubmesh& s : mesh.Submeshes)
+    {
+        withLods += s.LodCount > 0;
+        invalid += !ValidChain(mesh, s);
+        for (uint32_t l = 0; l < kMaxLodCount; ++l)
+        {
+            uint32_t level = std::min(l, s.LodCount);
+            levelTris[l] += (level == 0 ? s.IndexCount : mesh.Lods[s.FirstLod + level - 1].IndexCount) / 3;
+        }
+        for (uint32_t l = 0; l < s.LodCount; ++l)
+        {
+            const MeshLod& lod = mesh.Lods[s.FirstLod + l];
+            if ((double)s.VertexCount * lod.IndexCount / 3 > kMeasureMaxWork || !(lod.Error > 0.0f)) continue;
+            worstRatio = std::max(worstRatio, MeasureDeviation(mesh, s, lod) / lod.Error);
+            ++measured;
+        }
+    }
+
+    std::printf("%s: %zu submeshes, %zu with LODs, %zu LOD levels, chains built in %.1f ms, %s, %zu invalid\n",
+        path.c_str(), mesh.Submeshes.size(), withLods, mesh.Lods.size(), buildMs,
+        deterministic ? "deterministic" : "NOT DETERMINISTIC", invalid);
+    for (uint32_t l = 0; l < kMaxLodCount; ++l)
+        std::printf("  LOD%u: %9zu triangles (%5.1f%%)\n", l, levelTris[l], 100.0 * levelTris[l] / std::max<size_t>(levelTris[0], 1));
+    std::printf("  vertex deviation / reported error: max %.2f over %zu measured levels\n", worstRatio, measured);
+
+    // Вся сцена на одном расстоянии (как при mRadius) — 1080p, fovY 45°, порог 1 пиксель
+    const float projScale = LodProjectionScale(0.25f * 3.14159265f, 1080.0f);
+    std::printf("distance  drawn triangles\n");
+    for (float d : { 1.0f, 5.0f, 10.0f, 25.0f, 50.0f, 100.0f, 150.0f, 500.0f, 2000.0f })
+    {
+        size_t drawn = 0;
+        for (const ImportedSubmesh& s : mesh.Submeshes)
+        {
+            float errors[kMaxLodCount] = { 0.0f };
+            for (uint32_t l = 0; l < s.LodCount; ++l)
+                errors[l + 1] = mesh.Lods[s.FirstLod + l].Error;
+            uint32_t level = SelectLod(errors, s.LodCount + 1, d, projScale, 1.0f);
+            drawn += (level == 0 ? s.IndexCount : mesh.Lods[s.FirstLod + level - 1].IndexCount) / 3;
+        }
+        std::printf("%8.0f  %15zu (%5.1f%%)\n", d, drawn, 100.0 * drawn / std::max<size_t>(levelTris[0], 1));
+    }
+
+    return deterministic && invalid == 0 ? 0 : 2;
+}
@@ -0,0 +1,173 @@
+#include "Tools.h"
+#include "MeshPackage.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    // То, что BuildModelGeometry делает с геометрией перед CreateDefaultBuffer: копия VB и IB в блоб.
+    size_t CopyBlobs(const MeshVertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+        std::vector<uint8_t>& staging)
+    {
+        size_t vbSize = vertexCount * sizeof(MeshVertex);
+        size_t ibSize = indexCount * sizeof(uint32_t);
+        staging.resize(vbSize + ibSize);
+        std::memcpy(staging.data(), vertices, vbSize);
+        std::memcpy(staging.data() + vbSize, indices, ibSize);
+        return staging.size();
+    }
+
+    bool SameSubmeshes(const std::vector<ImportedSubmesh>& a, const std::vector<ImportedSubmesh>& b)
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i)
+            if (a[i].Name != b[i].Name || a[i].Material != b[i].Material ||
+                a[i].FirstIndex != b[i].FirstIndex || a[i].IndexCount != b[i].IndexCount ||
+                a[i].FirstVertex != b[i].FirstVertex || a[i].VertexCount != b[i].VertexCount ||
+                a[i].FirstLod != b[i].FirstLod || a[i].LodCount != b[i].LodCount)
+                return false;
+        return true;
+    }
+
+    // Пакет с индексом за пределами вершин submesh (в LOD0 и в LOD) должен отвергаться
+    bool CorruptedRejected(const std::string& packagePath, uint64_t hash, const ImportedMesh& mesh)
+    {
+        std::ifstream in(packagePath, std::ios::binary);
+        std::vector<char> original((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        MeshPackageHeader h;
+        std::memcpy(&h, original.data(), sizeof(h));
+
+        const std::string corruptPath = packagePath + ".corrupt";
+        bool rejected = true;
+        for (int variant = 0; variant < 2; ++variant)
+        {
+            if (variant == 1 && mesh.LodIndices.empty()) break;
+            std::vector<char> bytes = original;
+            uint32_t* indices = (uint32_t*)(bytes.data() + h.IndicesOffset);
+            uint32_t* lodIndices = (uint32_t*)(bytes.data() + h.LodIndicesOffset);
+            const ImportedSubmesh& s = mesh.Submeshes[0];
+            if (variant == 0)
+                indices[s.FirstIndex] = s.FirstVertex + s.VertexCount;
+            else
+                lodIndices[0] = (uint32_t)mesh.Vertices.size();
+            std::ofstream(corruptPath, std::ios::binary | std::ios::trunc).write(bytes.data(), (std::streamsize)bytes.size());
+            MeshPackage package;
+            rejected = rejected && !package.Open(corruptPath, hash);
+        }
+        std::remove(corruptPath.c_str());
+        return rejected;
+    }
+}
+
+int RunMeshPack(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    std::string outPath = argc > 1 ? argv[1] : MeshPackagePath(path);
+
+    uint64_t hash = 0;
+    if (!HashFile64(path, hash))
+    {
+        std::fprintf(stderr, "failed to read %s\n", path.c_str());
+        return 1;
+    }
+
+    ObjModel    model;
+    std::string error;
+    if (!LoadObjModel(path, model, &error))
+    {
+        std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+
+    ImportedMesh mesh;
+    ScopedTimer importTimer;
+    ImportObjMesh(model, mesh);
+    double importMs = importTimer.ElapsedMs();
+
+    ScopedTimer saveTimer;
+    if (!SaveMeshPackage(outPath, mesh, hash))
+    {
+        std::fprintf(stderr, "failed to write %s\n", outPath.c_str());
+        return 1;
+    }
+    double saveMs = saveTimer.ElapsedMs();
+
+    MappedFile file;
+    file.Open(outPath);
+    std::printf("%s -> %s\n", path.c_str(), outPath.c_str());
+    std::printf("  %zu submeshes, %zu materials, %zu vertices, %zu triangles, %.2f MB\n",
+        mesh.Submeshes.size(), mesh.DiffuseTextures.size(), mesh.Vertices.size(), mesh.Indices.size() / 3,
+        file.Size() / 1048576.0);
+    std::printf("  %zu LOD levels over %zu submeshes, %zu LOD triangles\n", mesh.Lods.size(),
+        (size_t)std::count_if(mesh.Submeshes.begin(), mesh.Submeshes.end(),
+            [](const ImportedSubmesh& s) { return s.LodCount > 0; }),
+        mesh.LodIndices.size() / 3);
+    std::printf("  parse %.1f ms, import %.1f ms, write %.1f ms\n", model.ParseMs, importMs, saveMs);
+    if (mesh.Submeshes.empty()) return 0;
+    bool corruptRejected = CorruptedRejected(outPath, hash, mesh);
+    std::printf("  out-of-range indices rejected: %s\n", corruptRejected ? "yes" : "NO");
+    return corruptRejected ? 0 : 2;
+}
+
+int RunMeshLoadBench(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+
+    // Пакет создаётся заранее, если его нет или он устарел
+    {
+        MeshPackage package;
+        if (LoadOrImportMeshPackage(path, package) == MeshSource::Failed || !package.IsMapped())
+        {
+            std::fprintf(stderr, "failed to import %s into %s\n", path.c_str(), MeshPackagePath(path).c_str());
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> objBlobs, packageBlobs;
+    std::vector<ImportedSubmesh> objSubmeshes, packageSubmeshes;
+    double objBest = 1e30, objTotal = 0.0, parseBest = 1e30;
+    double packageBest = 1e30, packageTotal = 0.0, hashBest = 1e30;
+
+    for (int it = 0; it < iterations; ++it)
+    {
+        ScopedTimer objTimer;
+        ObjModel model;
+        if (!LoadObjModel(path, model)) return 1;
+        ImportedMesh mesh;
+        ImportObjMesh(model, mesh);
+        CopyBlobs(mesh.Vertices.data(), mesh.Vertices.size(), mesh.Indices.data(), mesh.Indices.size(), objBlobs);
+        double objMs = objTimer.ElapsedMs();
+        objSubmeshes = mesh.Submeshes;
+        objBest = std::min(objBest, objMs);
+        parseBest = std::min(parseBest, model.ParseMs);
+        objTotal += objMs;
+
+        ScopedTimer packageTimer;
+        uint64_t hash = 0;
+        HashFile64(path, hash);
+        double hashMs = packageTimer.ElapsedMs();
+        MeshPackage package;
+        if (!package.Open(MeshPackagePath(path), hash)) return 1;
+        CopyBlobs(package.Vertices(), package.VertexCount(), package.Indices(), package.IndexCount(), packageBlobs);
+        double packageMs = packageTimer.ElapsedMs();
+        packageSubmeshes = package.Submeshes();
+        packageBest = std::min(packageBest, packageMs);
+        hashBest = std::min(hashBest, hashMs);
+        packageTotal += packageMs;
+    }
+
+    bool same = objBlobs == packageBlobs && SameSubmeshes(objSubmeshes, packageSubmeshes);
+    std::printf("%s: %zu submeshes, %.2f MB of VB+IB, %d iterations (warm file cache)\n", path.c_str(),
+        packageSubmeshes.size(), packageBlobs.size() / 1048576.0, iterations);
+    std::printf("  obj:     best %8.2f ms, avg %8.2f ms (parse %.2f ms)\n", objBest, objTotal / iterations, parseBest);
+    std::printf("  package: best %8.2f ms, avg %8.2f ms (source hash %.2f ms)\n",
+        packageBest, packageTotal / iterations, hashBest);
+    std::printf("  speedup %.1fx, blobs and submesh table %s\n", objBest / packageBest,
+        same ? "identical" : "DIFFERENT");
+    return same ? 0 : 1;
+}
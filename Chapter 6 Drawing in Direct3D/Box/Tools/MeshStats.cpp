@@ -0,0 +1,185 @@
+#include "Tools.h"
+#include "MeshOptimizer.h"
+#include "ModelImporter.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // Как Vertex в BoxApp: позиция, нормаль, uv.
+    const size_t kVertexBytes = 32;
+
+    // Треугольник как тройка исходных OBJ-индексов, повёрнутая к минимальному углу:
+    // переупорядочивание треугольников и вершин не должно менять этот набор.
+    struct ObjTriangle
+    {
+        int Corner[3][3];
+
+        bool operator<(const ObjTriangle& o) const
+        {
+            return std::memcmp(Corner, o.Corner, sizeof(Corner)) < 0;
+        }
+        bool operator==(const ObjTriangle& o) const
+        {
+            return std::memcmp(Corner, o.Corner, sizeof(Corner)) == 0;
+        }
+    };
+
+    void AppendTriangles(const std::vector<uint32_t>& indices,
+        const std::vector<tinyobj::index_t>& vertices, std::vector<ObjTriangle>& out)
+    {
+        for (size_t t = 0; t + 2 < indices.size(); t += 3)
+        {
+            int c[3][3];
+            for (int k = 0; k < 3; ++k)
+            {
+                const tinyobj::index_t& v = vertices[indices[t + k]];
+                c[k][0] = v.vertex_index;
+                c[k][1] = v.normal_index;
+                c[k][2] = v.texcoord_index;
+            }
+            int first = 0;
+            for (int k = 1; k < 3; ++k)
+                if (std::memcmp(c[k], c[first], sizeof(c[k])) < 0) first = k;
+
+            ObjTriangle tri;
+            for (int k = 0; k < 3; ++k)
+                std::memcpy(tri.Corner[k], c[(first + k) % 3], sizeof(c[k]));
+            out.push_back(tri);
+        }
+    }
+
+    void AppendRebased(const std::vector<uint32_t>& local, size_t vertexOffset, std::vector<uint32_t>& out)
+    {
+        for (uint32_t i : local)
+            out.push_back((uint32_t)vertexOffset + i);
+    }
+
+    void AppendPositions(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::index_t>& vertices,
+        std::vector<float>& out)
+    {
+        for (const tinyobj::index_t& v : vertices)
+            out.insert(out.end(), &attrib.vertices[3 * v.vertex_index], &attrib.vertices[3 * v.vertex_index] + 3);
+    }
+
+    void PrintStage(const char* stage, const std::vector<uint32_t>& indices,
+        const std::vector<float>& positions, double ms)
+    {
+        size_t vertexCount = positions.size() / 3;
+        VertexCacheStats cache = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+        OverdrawStats overdraw = AnalyzeOverdraw(indices.data(), indices.size(),
+            positions.data(), vertexCount, 3 * sizeof(float));
+        std::printf("  %-14s ACMR %.3f  ATVR %.3f  overdraw %.3f", stage, cache.ACMR, cache.ATVR, overdraw.Overdraw);
+        if (ms >= 0.0) std::printf("  (%.1f ms)", ms);
+        std::printf("\n");
+    }
+
+    // Та же обработка, что в BoxApp::BuildModelGeometry: сварка, затем OptimizeMesh по shape.
+    bool ReportMesh(const std::string& path)
+    {
+        ObjModel    model;
+        std::string error;
+        if (!LoadObjModel(path, model, &error))
+        {
+            std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+            return false;
+        }
+
+        std::vector<std::vector<uint32_t>>          shapeIndices(model.Shapes.size());
+        std::vector<std::vector<tinyobj::index_t>>  shapeVertices(model.Shapes.size());
+        std::vector<ObjTriangle> trianglesBefore, trianglesAfter;
+        std::vector<uint32_t>    welded, tipsified, sorted, optimized;
+        std::vector<float>       weldedPositions, optimizedPositions;
+
+        ScopedTimer weldTimer;
+        for (size_t s = 0; s < model.Shapes.size(); ++s)
+            WeldObjIndices(model.Shapes[s].mesh.indices, shapeIndices[s], shapeVertices[s]);
+        double weldMs = weldTimer.ElapsedMs();
+
+        for (size_t s = 0; s < model.Shapes.size(); ++s)
+        {
+            AppendRebased(shapeIndices[s], weldedPositions.size() / 3, welded);
+            AppendTriangles(shapeIndices[s], shapeVertices[s], trianglesBefore);
+            AppendPositions(model.Attrib, shapeVertices[s], weldedPositions);
+        }
+        size_t vertexCount = weldedPositions.size() / 3;
+
+        // Этапы замеряются по отдельности, итог — ровно то, что делает OptimizeMesh с позициями.
+        double cacheMs = 0.0, overdrawMs = 0.0, fetchMs = 0.0;
+        size_t vertexOffset = 0;
+        size_t indexBytes = 0, wideSubmeshes = 0, submeshes = 0;
+        std::vector<uint16_t> narrow;
+        std::vector<float> positions;
+        for (size_t s = 0; s < model.Shapes.size(); ++s)
+        {
+            std::vector<uint32_t>& indices = shapeIndices[s];
+            std::vector<tinyobj::index_t>& vertices = shapeVertices[s];
+            if (indices.empty()) continue;
+
+            ScopedTimer cacheTimer;
+            OptimizeVertexCache(indices.data(), indices.size(), vertices.size());
+            cacheMs += cacheTimer.ElapsedMs();
+            AppendRebased(indices, vertexOffset, tipsified);
+
+            positions.clear();
+            AppendPositions(model.Attrib, vertices, positions);
+            ScopedTimer overdrawTimer;
+            OptimizeOverdraw(indices.data(), indices.size(), positions.data(), vertices.size(), 3 * sizeof(float));
+            overdrawMs += overdrawTimer.ElapsedMs();
+            AppendRebased(indices, vertexOffset, sorted);
+            vertexOffset += vertices.size();
+
+            ScopedTimer fetchTimer;
+            std::vector<uint32_t> remap;
+            size_t used = OptimizeVertexFetchRemap(indices.data(), indices.size(), vertices.size(), remap);
+            RemapVertices(vertices, remap, used);
+            fetchMs += fetchTimer.ElapsedMs();
+
+            // Как GeometryUploadQueue::AppendIndices: 16 бит от BaseVertexLocation, где влезает
+            bool fits16 = NarrowIndices(indices.data(), indices.size(), 0, narrow);
+            indexBytes += indices.size() * (fits16 ? sizeof(uint16_t) : sizeof(uint32_t));
+            wideSubmeshes += !fits16;
+            ++submeshes;
+
+            AppendRebased(indices, optimizedPositions.size() / 3, optimized);
+            AppendTriangles(indices, vertices, trianglesAfter);
+            AppendPositions(model.Attrib, vertices, optimizedPositions);
+        }
+        size_t optimizedVertexCount = optimizedPositions.size() / 3;
+
+        std::sort(trianglesBefore.begin(), trianglesBefore.end());
+        std::sort(trianglesAfter.begin(), trianglesAfter.end());
+        bool same = trianglesBefore == trianglesAfter;
+
+        std::printf("%s: %zu shapes, %zu triangles, parse %.1f ms, weld %.1f ms\n", path.c_str(),
+            model.Shapes.size(), welded.size() / 3, model.ParseMs, weldMs);
+        std::printf("  vertices %zu -> %zu (%.2fx), VB %.2f -> %.2f MB\n", welded.size(), vertexCount,
+            vertexCount ? (double)welded.size() / vertexCount : 0.0,
+            welded.size() * kVertexBytes / 1048576.0, vertexCount * kVertexBytes / 1048576.0);
+        std::printf("  FIFO %u, unwelded ACMR 3.000; overdraw over 6 axis views\n", kVertexCacheSize);
+        PrintStage("welded", welded, weldedPositions, -1.0);
+        PrintStage("+ tipsify", tipsified, weldedPositions, cacheMs);
+        PrintStage("+ overdraw", sorted, weldedPositions, overdrawMs);
+        PrintStage("+ fetch order", optimized, optimizedPositions, fetchMs);
+        std::printf("  IB %.2f MB all 32-bit -> %.2f MB per submesh, %zu of %zu submeshes need 32-bit\n",
+            optimized.size() * sizeof(uint32_t) / 1048576.0, indexBytes / 1048576.0, wideSubmeshes, submeshes);
+        std::printf("  triangle set %s, %zu unused vertices dropped\n", same ? "preserved" : "CHANGED",
+            vertexCount - optimizedVertexCount);
+        return same;
+    }
+}
+
+int RunMeshStats(int argc, char** argv)
+{
+    std::vector<std::string> paths;
+    for (int i = 0; i < argc; ++i)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = { kDefaultSponzaPath, kDefaultStarPath };
+
+    bool ok = true;
+    for (const auto& p : paths)
+        ok = ReportMesh(p) && ok;
+    return ok ? 0 : 1;
+}
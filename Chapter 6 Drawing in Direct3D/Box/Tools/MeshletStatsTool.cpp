@@ -0,0 +1,192 @@
+#include "Tools.h"
+#include "Meshlet.h"
+#include "ModelImporter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    Vec3 Sub(Vec3 a, Vec3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    float Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vec3 Cross(Vec3 a, Vec3 b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    Vec3 Normalize(Vec3 a)
+    {
+        float l = std::sqrt(Dot(a, a));
+        return { a.x / l, a.y / l, a.z / l };
+    }
+    Vec3 ToVec(const DirectX::XMFLOAT3& p) { return { p.x, p.y, p.z }; }
+
+    // Перспективная камера: fovY 60°, 16:9; сфера проверяется против четырёх боковых плоскостей и near/far.
+    struct Camera
+    {
+        Vec3  Eye, Right, Up, Forward;
+        float TanX, TanY, Near, Far;
+
+        bool SphereVisible(Vec3 c, float r) const
+        {
+            Vec3 d = Sub(c, Eye);
+            float x = Dot(d, Right), y = Dot(d, Up), z = Dot(d, Forward);
+            if (z + r < Near || z - r > Far) return false;
+            // Плоскость |x| = z * tan: внутренняя нормаль (∓1, tan) / sqrt(1 + tan^2)
+            float kx = 1.0f / std::sqrt(1.0f + TanX * TanX), ky = 1.0f / std::sqrt(1.0f + TanY * TanY);
+            if ((z * TanX - x) * kx < -r || (z * TanX + x) * kx < -r) return false;
+            if ((z * TanY - y) * ky < -r || (z * TanY + y) * ky < -r) return false;
+            return true;
+        }
+    };
+
+    // Детерминированный облёт: камеры по эллипсу внутри AABB сцены, взгляд в центр с поворотом ±30°.
+    std::vector<Camera> MakePoses(Vec3 lo, Vec3 hi, int count)
+    {
+        Vec3 center = { (lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f, (lo.z + hi.z) * 0.5f };
+        Vec3 ext = { (hi.x - lo.x) * 0.5f, (hi.y - lo.y) * 0.5f, (hi.z - lo.z) * 0.5f };
+        float diag = 2.0f * std::sqrt(Dot(ext, ext));
+
+        std::vector<Camera> poses;
+        for (int i = 0; i < count; ++i)
+        {
+            float a = 2.0f * 3.14159265f * (float)i / (float)count;
+            Camera c;
+            c.Eye = { center.x + std::cos(a) * ext.x * 0.6f, center.y - ext.y * 0.5f, center.z + std::sin(a) * ext.z * 0.6f };
+            float yaw = std::atan2(center.z - c.Eye.z, center.x - c.Eye.x) + (i & 1 ? 0.52f : -0.52f);
+            c.Forward = Normalize({ std::cos(yaw), -0.1f, std::sin(yaw) });
+            c.Right = Normalize(Cross({ 0.0f, 1.0f, 0.0f }, c.Forward));
+            c.Up = Cross(c.Forward, c.Right);
+            c.TanY = std::tan(3.14159265f / 6.0f);
+            c.TanX = c.TanY * 16.0f / 9.0f;
+            c.Near = diag * 1e-4f;
+            c.Far = diag;
+            poses.push_back(c);
+        }
+        return poses;
+    }
+
+    void BuildAll(const ImportedMesh& mesh, MeshletSet& set)
+    {
+        set = MeshletSet();
+        for (const ImportedSubmesh& s : mesh.Submeshes)
+            AppendMeshlets(set, &mesh.Vertices[0].Pos.x, sizeof(MeshVertex),
+                mesh.Indices.data() + s.FirstIndex, s.IndexCount, 0);
+    }
+
+    bool SameSets(const MeshletSet& a, const MeshletSet& b)
+    {
+        return a.Meshlets.size() == b.Meshlets.size() && a.Vertices == b.Vertices && a.Triangles == b.Triangles &&
+            std::memcmp(a.Meshlets.data(), b.Meshlets.data(), a.Meshlets.size() * sizeof(Meshlet)) == 0;
+    }
+
+    // Мешлеты, развёрнутые обратно в индексы, должны дать исходный IB треугольник в треугольник.
+    bool Lossless(const ImportedMesh& mesh, const MeshletSet& set)
+    {
+        std::vector<uint32_t> indices;
+        for (const Meshlet& m : set.Meshlets)
+            for (uint32_t i = 0; i < m.TriangleCount * 3; ++i)
+                indices.push_back(set.Vertices[m.VertexOffset + set.Triangles[m.TriangleOffset + i]]);
+        return indices == mesh.Indices;
+    }
+}
+
+int RunMeshletStats(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    int poseCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 16;
+
+    ObjModel    model;
+    std::string error;
+    if (!LoadObjModel(path, model, &error))
+    {
+        std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+    ImportedMesh mesh;
+    ImportObjMesh(model, mesh);
+    if (mesh.Vertices.empty())
+    {
+        std::fprintf(stderr, "%s has no geometry\n", path.c_str());
+        return 1;
+    }
+
+    MeshletSet set, again;
+    ScopedTimer buildTimer;
+    BuildAll(mesh, set);
+    double buildMs = buildTimer.ElapsedMs();
+    BuildAll(mesh, again);
+    bool deterministic = SameSets(set, again);
+    bool lossless = Lossless(mesh, set);
+
+    MeshletStats stats = AnalyzeMeshlets(set);
+    std::printf("%s: %zu submeshes, %zu triangles, %zu vertices\n", path.c_str(), mesh.Submeshes.size(),
+        mesh.Indices.size() / 3, mesh.Vertices.size());
+    std::printf("  %zu meshlets (%u/%u), built in %.1f ms; %.1f verts, %.1f tris per meshlet (fill %.0f%% / %.0f%%)\n",
+        stats.Meshlets, kMeshletMaxVertices, kMeshletMaxTriangles, buildMs,
+        stats.Meshlets ? (double)stats.Vertices / stats.Meshlets : 0.0,
+        stats.Meshlets ? (double)stats.Triangles / stats.Meshlets : 0.0, stats.VertexFill * 100.0, stats.TriangleFill * 100.0);
+    std::printf("  vertex duplication %.2fx, %zu open cones (%.0f%%), %s, %s\n",
+        (double)stats.Vertices / mesh.Vertices.size(), stats.OpenCones,
+        stats.Meshlets ? 100.0 * stats.OpenCones / stats.Meshlets : 0.0,
+        deterministic ? "deterministic" : "NOT DETERMINISTIC", lossless ? "lossless" : "TRIANGLES LOST");
+
+    Vec3 lo = ToVec(mesh.Vertices[0].Pos), hi = lo;
+    for (const MeshVertex& v : mesh.Vertices)
+    {
+        lo = { std::min(lo.x, v.Pos.x), std::min(lo.y, v.Pos.y), std::min(lo.z, v.Pos.z) };
+        hi = { std::max(hi.x, v.Pos.x), std::max(hi.y, v.Pos.y), std::max(hi.z, v.Pos.z) };
+    }
+
+    // Грань считается задней, если камера за её плоскостью (CCW — лицевая); конус не должен отсекать ни одной лицевой
+    std::printf("pose  frustum-culled  cone-culled  drawn meshlets  drawn tris  back tris in drawn  cone errors\n");
+    size_t totalMeshlets = 0, totalDrawn = 0, totalTris = 0, totalDrawnTris = 0, coneErrors = 0;
+    std::vector<Camera> poses = MakePoses(lo, hi, poseCount);
+    for (size_t p = 0; p < poses.size(); ++p)
+    {
+        const Camera& cam = poses[p];
+        size_t frustumCulled = 0, coneCulled = 0, drawnTris = 0, backInDrawn = 0, errors = 0;
+        for (const Meshlet& m : set.Meshlets)
+        {
+            if (!cam.SphereVisible(ToVec(m.Center), m.Radius))
+            {
+                ++frustumCulled;
+                continue;
+            }
+            bool culled = MeshletBackfacing(m, { cam.Eye.x, cam.Eye.y, cam.Eye.z });
+            for (uint32_t t = 0; t < m.TriangleCount; ++t)
+            {
+                const uint8_t* tri = &set.Triangles[m.TriangleOffset + t * 3];
+                Vec3 a = ToVec(mesh.Vertices[set.Vertices[m.VertexOffset + tri[0]]].Pos);
+                Vec3 b = ToVec(mesh.Vertices[set.Vertices[m.VertexOffset + tri[1]]].Pos);
+                Vec3 c = ToVec(mesh.Vertices[set.Vertices[m.VertexOffset + tri[2]]].Pos);
+                Vec3 n = Cross(Sub(b, a), Sub(c, a));
+                Vec3 toEye = Sub(cam.Eye, a);
+                float d = Dot(n, toEye);
+                if (culled)
+                    errors += d > 1e-4f * std::sqrt(Dot(n, n) * Dot(toEye, toEye));   // допуск на округление float
+                else
+                    backInDrawn += d <= 0.0f;
+            }
+            if (culled) ++coneCulled;
+            else drawnTris += m.TriangleCount;
+        }
+
+        size_t drawn = set.Meshlets.size() - frustumCulled - coneCulled;
+        std::printf("%4zu  %13.1f%%  %10.1f%%  %14zu  %10zu  %17.1f%%  %11zu\n", p,
+            100.0 * frustumCulled / set.Meshlets.size(), 100.0 * coneCulled / set.Meshlets.size(),
+            drawn, drawnTris, drawnTris ? 100.0 * backInDrawn / drawnTris : 0.0, errors);
+        totalMeshlets += set.Meshlets.size();
+        totalDrawn += drawn;
+        totalTris += stats.Triangles;
+        totalDrawnTris += drawnTris;
+        coneErrors += errors;
+    }
+    std::printf("mean: %.1f%% of meshlets and %.1f%% of triangles drawn, %zu front faces wrongly cone-culled\n",
+        100.0 * totalDrawn / totalMeshlets, 100.0 * totalDrawnTris / totalTris, coneErrors);
+
+    return deterministic && lossless && coneErrors == 0 ? 0 : 2;
+}
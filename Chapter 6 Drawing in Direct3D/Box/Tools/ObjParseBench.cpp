@@ -0,0 +1,132 @@
+#include "Tools.h"
+#include "MappedFile.h"
+#include "ModelImporter.h"
+#include "ObjParser.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    template <typename T>
+    bool SameArray(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    bool SameIndices(const std::vector<tinyobj::index_t>& a, const std::vector<tinyobj::index_t>& b)
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i)
+            if (a[i].vertex_index != b[i].vertex_index || a[i].normal_index != b[i].normal_index ||
+                a[i].texcoord_index != b[i].texcoord_index)
+                return false;
+        return true;
+    }
+
+    // Побитовое сравнение со слепком tinyobj::LoadObj: атрибуты, shape и имена материалов.
+    bool SameModel(const ObjModel& a, const ObjModel& b)
+    {
+        if (!SameArray(a.Attrib.vertices, b.Attrib.vertices) || !SameArray(a.Attrib.vertex_weights, b.Attrib.vertex_weights) ||
+            !SameArray(a.Attrib.normals, b.Attrib.normals) || !SameArray(a.Attrib.texcoords, b.Attrib.texcoords) ||
+            !SameArray(a.Attrib.colors, b.Attrib.colors) || a.Shapes.size() != b.Shapes.size() ||
+            a.Materials.size() != b.Materials.size())
+            return false;
+
+        for (size_t i = 0; i < a.Shapes.size(); ++i)
+        {
+            const tinyobj::mesh_t& ma = a.Shapes[i].mesh;
+            const tinyobj::mesh_t& mb = b.Shapes[i].mesh;
+            if (a.Shapes[i].name != b.Shapes[i].name || !SameIndices(ma.indices, mb.indices) ||
+                !SameArray(ma.num_face_vertices, mb.num_face_vertices) || !SameArray(ma.material_ids, mb.material_ids) ||
+                !SameArray(ma.smoothing_group_ids, mb.smoothing_group_ids))
+                return false;
+        }
+        for (size_t i = 0; i < a.Materials.size(); ++i)
+            if (a.Materials[i].name != b.Materials[i].name ||
+                a.Materials[i].diffuse_texname != b.Materials[i].diffuse_texname)
+                return false;
+        return true;
+    }
+}
+
+int RunObjParseBench(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 3;
+
+    std::string mtlDir;
+    size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos)
+        mtlDir = path.substr(0, slash);
+
+    ObjModel reference;
+    std::string error;
+    double referenceBest = 1e30;
+    for (int it = 0; it < iterations; ++it)
+    {
+        reference = ObjModel();
+        if (!LoadObjModel(path, reference, &error))
+        {
+            std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+            return 1;
+        }
+        referenceBest = std::min(referenceBest, reference.ParseMs);
+    }
+
+    uint32_t hw = std::thread::hardware_concurrency();
+    if (hw == 0) hw = 1;
+
+    MappedFile file;
+    file.Open(path);
+    double mb = file.Size() / 1048576.0;
+    std::printf("%s: %.1f MB, %zu shapes, %zu faces, %u hardware threads, best of %d\n", path.c_str(), mb,
+        reference.Shapes.size(), reference.IndexCount() / 3, hw, iterations);
+    std::printf("threads  chunks  parse ms  merge ms  build ms  total ms     MB/s  speedup  result\n");
+    std::printf("%7s  %6s  %8s  %8s  %8s  %8.1f  %7.0f  %7s  %s\n", "tinyobj", "-", "-", "-", "-",
+        referenceBest, mb / (referenceBest / 1000.0), "1.00", "reference");
+
+    // Однопоточный эталон — tinyobj; пул начинается с двух потоков.
+    std::vector<uint32_t> counts;
+    for (uint32_t t = 2; t < hw; t *= 2)
+        counts.push_back(t);
+    counts.push_back(std::max<uint32_t>(hw, 2));
+
+    bool allSame = true;
+    for (uint32_t threads : counts)
+    {
+        // Вызывающий поток тоже разбирает куски, поэтому воркеров на один меньше.
+        WorkerPool pool(threads - 1);
+        ObjModel model;
+        ObjParseStats best;
+        double bestMs = 1e30;
+        for (int it = 0; it < iterations; ++it)
+        {
+            model = ObjModel();
+            ObjParseStats stats;
+            ScopedTimer timer;
+            if (!ParseObjParallel(path, mtlDir, pool, model.Attrib, model.Shapes, model.Materials, &error, &stats,
+                ObjTokenizer::TinyObj))
+            {
+                std::fprintf(stderr, "parallel parse failed: %s\n", error.c_str());
+                return 1;
+            }
+            double ms = timer.ElapsedMs();
+            if (ms < bestMs)
+            {
+                bestMs = ms;
+                best = stats;
+            }
+        }
+
+        bool same = SameModel(reference, model);
+        allSame &= same;
+        std::printf("%7u  %6zu  %8.1f  %8.1f  %8.1f  %8.1f  %7.0f  %7.2f  %s%s\n", threads, best.Chunks,
+            best.ParseMs, best.MergeMs, best.BuildMs, bestMs, mb / (bestMs / 1000.0), referenceBest / bestMs,
+            same ? "identical" : "DIFFERENT", best.Fallback ? " (tinyobj fallback)" : "");
+    }
+    return allSame ? 0 : 2;
+}
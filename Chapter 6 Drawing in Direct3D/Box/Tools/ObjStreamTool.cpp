@@ -0,0 +1,123 @@
+#include "Tools.h"
+#include "ModelImporter.h"
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    template <typename T>
+    size_t Bytes(const std::vector<T>& v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+
+    // Что держит в памяти обычный импорт к концу ImportObjMesh: attrib_t, все shape и ImportedMesh.
+    size_t FullImportBytes(const ObjModel& model, const ImportedMesh& mesh)
+    {
+        const tinyobj::attrib_t& a = model.Attrib;
+        size_t bytes = Bytes(a.vertices) + Bytes(a.vertex_weights) + Bytes(a.normals) + Bytes(a.texcoords) +
+            Bytes(a.colors);
+        for (const auto& shape : model.Shapes)
+            bytes += Bytes(shape.mesh.indices) + Bytes(shape.mesh.num_face_vertices) +
+                Bytes(shape.mesh.material_ids) + Bytes(shape.mesh.smoothing_group_ids);
+        return bytes + Bytes(mesh.Vertices) + Bytes(mesh.Indices);
+    }
+
+    bool SameMesh(const ImportedMesh& a, const ImportedMesh& b)
+    {
+        if (a.Vertices.size() != b.Vertices.size() || a.Indices != b.Indices ||
+            a.Submeshes.size() != b.Submeshes.size() || a.DiffuseTextures != b.DiffuseTextures)
+            return false;
+        if (!a.Vertices.empty() &&
+            std::memcmp(a.Vertices.data(), b.Vertices.data(), a.Vertices.size() * sizeof(MeshVertex)) != 0)
+            return false;
+        for (size_t i = 0; i < a.Submeshes.size(); ++i)
+        {
+            const ImportedSubmesh& x = a.Submeshes[i];
+            const ImportedSubmesh& y = b.Submeshes[i];
+            if (x.Name != y.Name || x.Material != y.Material || x.FirstIndex != y.FirstIndex ||
+                x.IndexCount != y.IndexCount || x.FirstVertex != y.FirstVertex || x.VertexCount != y.VertexCount)
+                return false;
+        }
+        return true;
+    }
+}
+
+int RunObjStream(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+
+    // Эталон — обычный импорт; пустые shape потоковый режим не отдаёт
+    ObjModel model;
+    std::string error;
+    if (!LoadObjModel(path, model, &error))
+    {
+        std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+    ImportedMesh reference;
+    ScopedTimer importTimer;
+    ImportObjMesh(model, reference);
+    double fullMs = model.ParseMs + importTimer.ElapsedMs();
+    size_t fullBytes = FullImportBytes(model, reference);
+    model = ObjModel();
+
+    std::vector<ImportedSubmesh> submeshes;
+    for (const ImportedSubmesh& s : reference.Submeshes)
+        if (s.IndexCount > 0) submeshes.push_back(s);
+    reference.Submeshes = submeshes;
+
+    // Склейка отданных сабмешей — только для сравнения; в BoxApp они сразу уходят в GPU.
+    // Прокси пикинга считается как в BoxApp::StreamModelGeometry: он остаётся в памяти после разбора
+    ImportedMesh streamed;
+    ObjStreamStats stats;
+    std::vector<uint32_t> lodIndices, proxyIndices;
+    std::vector<MeshLod> lods;
+    std::vector<DirectX::XMFLOAT3> proxyPositions;
+    size_t proxyVertices = 0, proxyTriangles = 0, skippedSubmeshes = 0;
+    bool ok = StreamObjMesh(path,
+        [&](const std::vector<std::string>& textures) { streamed.DiffuseTextures = textures; },
+        [&](const ImportedSubmesh& submesh, const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices) {
+            streamed.Submeshes.push_back(submesh);
+            for (uint32_t i : indices)
+                streamed.Indices.push_back(submesh.FirstVertex + i);
+            streamed.Vertices.insert(streamed.Vertices.end(), vertices.begin(), vertices.end());
+
+            lodIndices.clear();
+            lods.clear();
+            uint32_t lodCount = BuildLodChain(indices.data(), indices.size(), &vertices.data()->Pos.x,
+                vertices.size(), sizeof(MeshVertex), lodIndices, lods);
+            ExtractCoarsestLod(vertices.data(), vertices.size(), indices.data(), indices.size(),
+                lodIndices.data(), lods.data(), lodCount, proxyPositions, proxyIndices);
+            if (proxyTriangles + proxyIndices.size() / 3 > kStreamPickTriangles)
+            {
+                ++skippedSubmeshes;
+                return;
+            }
+            proxyTriangles += proxyIndices.size() / 3;
+            proxyVertices += proxyPositions.size();
+        },
+        &error, &stats);
+    if (!ok)
+    {
+        std::fprintf(stderr, "streaming import of %s failed: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+
+    bool same = SameMesh(reference, streamed);
+    std::printf("%s: %zu submeshes, %zu vertices, %zu triangles\n", path.c_str(), stats.Submeshes,
+        stats.Vertices, stats.Indices / 3);
+    std::printf("  full import:  %8.1f ms, %8.2f MB resident (attrib_t, shapes, ImportedMesh)\n",
+        fullMs, fullBytes / 1048576.0);
+    std::printf("  streamed:     %8.1f ms, %8.2f MB resident (attributes %.2f MB + largest submesh %.2f MB)\n",
+        stats.ParseMs, (stats.AttributeBytes + stats.PeakSubmeshBytes) / 1048576.0,
+        stats.AttributeBytes / 1048576.0, stats.PeakSubmeshBytes / 1048576.0);
+    // WorldVertexCache держит локальные и мировые SoA, индексы — uint32; BVH над прокси не считается
+    size_t proxyBytes = proxyVertices * 6 * sizeof(float) + proxyTriangles * 3 * sizeof(uint32_t);
+    std::printf("  pick proxy:   %zu of %zu triangles, %zu vertices, %.2f MB, %zu submeshes over budget\n",
+        proxyTriangles, stats.Indices / 3, proxyVertices, proxyBytes / 1048576.0, skippedSubmeshes);
+    std::printf("  app peak:     %8.2f MB after parsing (streamed + pick proxy, budget %zu triangles)\n",
+        (stats.AttributeBytes + stats.PeakSubmeshBytes + proxyBytes) / 1048576.0, kStreamPickTriangles);
+    std::printf("  submeshes, vertices and indices %s\n", same ? "identical" : "DIFFERENT");
+    return same ? 0 : 2;
+}
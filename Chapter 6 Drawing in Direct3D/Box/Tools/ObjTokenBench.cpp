@@ -0,0 +1,141 @@
+#include "Tools.h"
+#include "MappedFile.h"
+#include "ObjParser.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <sstream>
+
+namespace
+{
+    const int kIterations = 5;
+
+    // Синтетический OBJ в духе экспорта из DCC: 6 знаков после запятой, грани v/vt/vn.
+    std::string MakeSyntheticObj(size_t vertexCount)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> pos(-1000.0f, 1000.0f), unit(-1.0f, 1.0f), uv(0.0f, 1.0f);
+
+        std::string obj;
+        char line[128];
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", pos(rng), pos(rng), pos(rng));
+            obj += line;
+            std::snprintf(line, sizeof(line), "vn %.6f %.6f %.6f\n", unit(rng), unit(rng), unit(rng));
+            obj += line;
+            std::snprintf(line, sizeof(line), "vt %.6f %.6f\n", uv(rng), uv(rng));
+            obj += line;
+        }
+        std::uniform_int_distribution<size_t> index(1, vertexCount);
+        for (size_t i = 0; i < vertexCount * 2; ++i)
+        {
+            size_t a = index(rng), b = index(rng), c = index(rng);
+            std::snprintf(line, sizeof(line), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, b, b, b, c, c, c);
+            obj += line;
+        }
+        return obj;
+    }
+
+    // Расстояние в ulp между двумя float одного знака (для разных знаков — через ноль).
+    uint32_t UlpDistance(float a, float b)
+    {
+        int32_t ia, ib;
+        std::memcpy(&ia, &a, 4);
+        std::memcpy(&ib, &b, 4);
+        if (ia < 0) ia = INT32_MIN - ia;
+        if (ib < 0) ib = INT32_MIN - ib;
+        int64_t d = (int64_t)ia - (int64_t)ib;
+        return (uint32_t)std::min<int64_t>(d < 0 ? -d : d, UINT32_MAX);
+    }
+
+    double BestMs(const std::function<void()>& body)
+    {
+        double best = 1e30;
+        for (int i = 0; i < kIterations; ++i)
+        {
+            ScopedTimer timer;
+            body();
+            best = std::min(best, timer.ElapsedMs());
+        }
+        return best;
+    }
+
+    bool BenchBuffer(const char* name, const char* data, size_t size)
+    {
+        double mb = size / 1048576.0;
+
+        // Эталон — полный tinyobj::LoadObj из памяти (istream, строки std::string, сборка shape).
+        double loadObjMs = BestMs([&]() {
+            std::istringstream stream(std::string(data, size));
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn, err;
+            tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &stream, nullptr, true);
+        });
+
+        std::vector<tinyobj::real_t> tinyReals, fastReals;
+        ObjTokenStats tiny, fast;
+        double tinyMs = BestMs([&]() {
+            tinyReals.clear();
+            tiny = TokenizeObj(data, size, ObjTokenizer::TinyObj, &tinyReals);
+        });
+        double fastMs = BestMs([&]() {
+            fastReals.clear();
+            fast = TokenizeObj(data, size, ObjTokenizer::FromChars, &fastReals);
+        });
+
+        size_t differing = 0;
+        uint32_t maxUlp = 0;
+        if (tinyReals.size() == fastReals.size())
+            for (size_t i = 0; i < tinyReals.size(); ++i)
+            {
+                uint32_t ulp = UlpDistance(tinyReals[i], fastReals[i]);
+                differing += ulp != 0;
+                maxUlp = std::max(maxUlp, ulp);
+            }
+
+        bool sameIndices = tiny.Faces == fast.Faces && tiny.Corners == fast.Corners &&
+            tiny.IndexHash == fast.IndexHash && tiny.Reals == fast.Reals;
+        std::printf("%s: %.1f MB, %zu reals, %zu faces%s\n", name, mb, fast.Reals, fast.Faces,
+            fast.Unsupported ? " (stopped at an unsupported line)" : "");
+        std::printf("  tinyobj::LoadObj  %8.1f ms  %7.0f MB/s\n", loadObjMs, mb / (loadObjMs / 1000.0));
+        std::printf("  tinyobj tokens    %8.1f ms  %7.0f MB/s\n", tinyMs, mb / (tinyMs / 1000.0));
+        std::printf("  from_chars        %8.1f ms  %7.0f MB/s  %.2fx vs tinyobj tokens\n", fastMs,
+            mb / (fastMs / 1000.0), tinyMs / fastMs);
+        std::printf("  indices %s, %zu of %zu reals differ from tryParseDouble (max %u ulp)\n",
+            sameIndices ? "identical" : "DIFFERENT", differing, fastReals.size(), maxUlp);
+        return sameIndices && maxUlp <= 1;
+    }
+}
+
+int RunObjTokenBench(int argc, char** argv)
+{
+    bool ok = true;
+
+    std::string synthetic = MakeSyntheticObj(500000);
+    ok &= BenchBuffer("synthetic", synthetic.data(), synthetic.size());
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < argc; ++i)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = { kDefaultSponzaPath, kDefaultStarPath };
+
+    for (const std::string& path : paths)
+    {
+        MappedFile file;
+        if (!file.Open(path))
+        {
+            std::fprintf(stderr, "failed to map %s\n", path.c_str());
+            ok = false;
+            continue;
+        }
+        ok &= BenchBuffer(path.c_str(), (const char*)file.Data(), file.Size());
+    }
+    return ok ? 0 : 2;
+}
@@ -0,0 +1,146 @@
+#include "Tools.h"
+#include "CameraPath.h"
+#include "MappedFile.h"
+#include "ModelImporter.h"
+#include "OccluderMesh.h"
+#include "OcclusionBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace DirectX;
+
+namespace
+{
+    // Доля пикселей буфера, закрытых окклюдерами, в среднем по позам
+    double ScreenCoverage(const OccluderSet& occluders, const std::vector<CameraPose>& poses, FXMMATRIX proj)
+    {
+        OcclusionBuffer buffer;
+        double covered = 0.0;
+        for (const CameraPose& pose : poses)
+        {
+            buffer.Begin(CameraPoseView(pose) * proj);
+            buffer.RenderOccluders(occluders);
+            const float* depth = buffer.Depth();
+            size_t n = 0;
+            for (int i = 0; i < kOcclusionWidth * kOcclusionHeight; ++i) n += depth[i] < 1.0f;
+            covered += (double)n / (kOcclusionWidth * kOcclusionHeight);
+        }
+        return poses.empty() ? 0.0 : covered / poses.size();
+    }
+
+    double SurfaceArea(const OccluderSet& occluders)
+    {
+        double area = 0.0;
+        for (size_t i = 0; i < occluders.Indices.size(); i += 3)
+        {
+            XMVECTOR a = XMLoadFloat3(&occluders.Positions[occluders.Indices[i]]);
+            XMVECTOR b = XMLoadFloat3(&occluders.Positions[occluders.Indices[i + 1]]);
+            XMVECTOR c = XMLoadFloat3(&occluders.Positions[occluders.Indices[i + 2]]);
+            area += 0.5 * XMVectorGetX(XMVector3Length(XMVector3Cross(b - a, c - a)));
+        }
+        return area;
+    }
+}
+
+int RunOccluderBuild(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    std::string outPath = argc > 1 ? argv[1] : OccluderMeshPath(path);
+    std::string posesPath = argc > 2 ? argv[2] : kDefaultCameraPath;
+
+    ObjModel    model;
+    std::string error;
+    if (!LoadObjModel(path, model, &error))
+    {
+        std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+    ImportedMesh mesh;
+    ImportObjMesh(model, mesh);
+    if (mesh.Vertices.empty())
+    {
+        std::fprintf(stderr, "%s has no geometry\n", path.c_str());
+        return 1;
+    }
+    std::vector<uint8_t> masked = MaskedMaterials(model.Materials);
+
+    OccluderSet occluders;
+    OccluderBuildStats stats;
+    ScopedTimer buildTimer;
+    BuildOccluderMesh(mesh, masked, kMaxOccluderTriangles, occluders, &stats);
+    double buildMs = buildTimer.ElapsedMs();
+
+    uint64_t sourceHash = 0;
+    HashFile64(path, sourceHash);
+    if (!SaveOccluderMesh(outPath, occluders, sourceHash))
+    {
+        std::fprintf(stderr, "failed to write %s\n", outPath.c_str());
+        return 1;
+    }
+    OccluderSet loaded;
+    bool roundTrip = LoadOccluderMesh(outPath, sourceHash, loaded) &&
+        loaded.Indices == occluders.Indices && loaded.Positions.size() == occluders.Positions.size();
+    for (size_t v = 0; roundTrip && v < loaded.Positions.size(); ++v)
+        roundTrip = loaded.Positions[v].x == occluders.Positions[v].x &&
+            loaded.Positions[v].y == occluders.Positions[v].y && loaded.Positions[v].z == occluders.Positions[v].z;
+
+    std::printf("%s: %zu submeshes (%zu masked, skipped), %zu triangles\n", path.c_str(), mesh.Submeshes.size(),
+        stats.MaskedSubmeshes, mesh.Indices.size() / 3);
+    std::printf("planar patches %zu, candidates %zu, selected %zu: %zu -> %zu triangles, %zu vertices, built in %.1f ms\n",
+        stats.Patches, stats.Candidates, stats.Selected, stats.SourceTriangles, stats.Triangles,
+        occluders.Positions.size(), buildMs);
+    std::printf("surface covered %.1f%% of the model\n",
+        stats.SceneArea > 0.0 ? 100.0 * stats.SelectedArea / stats.SceneArea : 0.0);
+    std::printf("wrote %s, reloaded %s\n", outPath.c_str(), roundTrip ? "identical" : "DIFFERENT");
+
+    // Покрытие экрана на тех же позах, что у occlusion-bench
+    XMFLOAT3 lo = mesh.Vertices[0].Pos, hi = lo;
+    for (const MeshVertex& v : mesh.Vertices)
+    {
+        lo = { std::min(lo.x, v.Pos.x), std::min(lo.y, v.Pos.y), std::min(lo.z, v.Pos.z) };
+        hi = { std::max(hi.x, v.Pos.x), std::max(hi.y, v.Pos.y), std::max(hi.z, v.Pos.z) };
+    }
+    std::vector<CameraPose> poses;
+    const char* posesSource = "recorded";
+    if (!LoadCameraPath(posesPath, poses, &error) || poses.empty())
+    {
+        poses = MakeWalkPath(lo, hi, 16);
+        posesSource = "synthetic walk";
+    }
+    XMFLOAT3 diag = { hi.x - lo.x, hi.y - lo.y, hi.z - lo.z };
+    float diagLen = std::sqrt(diag.x * diag.x + diag.y * diag.y + diag.z * diag.z);
+    XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, diagLen * 1e-4f, diagLen * 2.0f);
+
+    // Предел — все непрозрачные треугольники модели
+    OccluderSet opaque;
+    for (const MeshVertex& v : mesh.Vertices) opaque.Positions.push_back(v.Pos);
+    for (const ImportedSubmesh& s : mesh.Submeshes)
+        if (s.Material < 0 || (size_t)s.Material >= masked.size() || !masked[s.Material])
+            opaque.Indices.insert(opaque.Indices.end(), mesh.Indices.begin() + s.FirstIndex,
+                mesh.Indices.begin() + s.FirstIndex + s.IndexCount);
+    double opaqueCoverage = ScreenCoverage(opaque, poses, proj);
+
+    WorldVertexCache cache;
+    cache.AddRange(&mesh.Vertices[0].Pos, mesh.Vertices.size(), sizeof(MeshVertex));
+
+    std::printf("\nscreen coverage over %zu poses (%s); all %zu opaque triangles cover %.1f%%\n",
+        poses.size(), posesSource, opaque.Indices.size() / 3, 100.0 * opaqueCoverage);
+    std::printf("budget  | offline tris  surface %%  screen %%  of opaque %% | runtime tris  surface %%  screen %%  of opaque %%\n");
+    const size_t budgets[] = { 64, 128, 256, 512, 1024, 2048, 4096 };
+    for (size_t budget : budgets)
+    {
+        if (budget > kMaxOccluderTriangles) break;
+        OccluderSet offline, runtime;
+        BuildOccluderMesh(mesh, masked, budget, offline);
+        SelectOccluders(cache.LocalPositions(), mesh.Indices.data(), mesh.Indices.size() / 3, budget, runtime);
+        double offlineScreen = ScreenCoverage(offline, poses, proj);
+        double runtimeScreen = ScreenCoverage(runtime, poses, proj);
+        std::printf("%6zu  | %12zu  %9.1f  %8.1f  %11.1f | %12zu  %9.1f  %8.1f  %11.1f\n", budget,
+            offline.Indices.size() / 3, 100.0 * SurfaceArea(offline) / stats.SceneArea, 100.0 * offlineScreen,
+            opaqueCoverage > 0.0 ? 100.0 * offlineScreen / opaqueCoverage : 0.0,
+            runtime.Indices.size() / 3, 100.0 * SurfaceArea(runtime) / stats.SceneArea, 100.0 * runtimeScreen,
+            opaqueCoverage > 0.0 ? 100.0 * runtimeScreen / opaqueCoverage : 0.0);
+    }
+    return roundTrip ? 0 : 2;
+}
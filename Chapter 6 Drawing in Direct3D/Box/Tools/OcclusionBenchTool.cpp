@@ -0,0 +1,237 @@
+#include "Tools.h"
+#include "BVH.h"
+#include "CameraPath.h"
+#include "FrustumCull.h"
+#include "MappedFile.h"
+#include "Meshlet.h"
+#include "ModelImporter.h"
+#include "OccluderMesh.h"
+#include "OcclusionBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+    struct BoundsSet
+    {
+        AabbStream Boxes;
+        std::vector<XMFLOAT3> Center, Extents;
+
+        void Add(const XMFLOAT3& center, const XMFLOAT3& extents)
+        {
+            Center.push_back(center);
+            Extents.push_back(extents);
+        }
+        void Finish()
+        {
+            Boxes.Resize(Center.size());
+            for (size_t i = 0; i < Center.size(); ++i) Boxes.Set(i, Center[i], Extents[i]);
+        }
+    };
+
+    // Точка видна из eye: на экране (внутри frustum) и луч до неё ничего не задевает раньше
+    bool PointVisible(const BVH& bvh, FXMVECTOR eye, FXMVECTOR point, CXMMATRIX viewProj)
+    {
+        XMFLOAT4 clip;
+        XMStoreFloat4(&clip, XMVector3Transform(point, viewProj));
+        if (!(clip.w > 0.0f) || clip.z < 0.0f || clip.z > clip.w || std::fabs(clip.x) > clip.w || std::fabs(clip.y) > clip.w)
+            return false;
+        RayHit hit;
+        return !bvh.IntersectClosest(eye, point - eye, 0.0f, 1.0f - 1e-3f, hit);
+    }
+
+    // Закрытый объект с видимой точкой — ложное отсечение. Проверяются центры треугольников
+    // (не больше kMaxSamples на объект, равномерно по списку). Покрытие по центру пикселя закрывает
+    // щели уже пикселя буфера, поэтому единичные ложные отсечения ожидаемы — счётчик для контроля
+    // их доли, не для кода возврата
+    const uint32_t kMaxSamples = 64;
+
+    bool AnyTriangleVisible(const BVH& bvh, const ImportedMesh& mesh, const uint32_t* tris, uint32_t triCount,
+        FXMVECTOR eye, CXMMATRIX viewProj)
+    {
+        uint32_t step = std::max(1u, triCount / kMaxSamples);
+        for (uint32_t t = 0; t < triCount; t += step)
+        {
+            XMVECTOR p = (XMLoadFloat3(&mesh.Vertices[tris[3 * t]].Pos) + XMLoadFloat3(&mesh.Vertices[tris[3 * t + 1]].Pos) +
+                XMLoadFloat3(&mesh.Vertices[tris[3 * t + 2]].Pos)) / 3.0f;
+            if (PointVisible(bvh, eye, p, viewProj)) return true;
+        }
+        return false;
+    }
+}
+
+int RunOcclusionBench(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    std::string posesPath = argc > 1 ? argv[1] : kDefaultCameraPath;
+
+    ObjModel    model;
+    std::string error;
+    if (!LoadObjModel(path, model, &error))
+    {
+        std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+    ImportedMesh mesh;
+    ImportObjMesh(model, mesh);
+    if (mesh.Vertices.empty())
+    {
+        std::fprintf(stderr, "%s has no geometry\n", path.c_str());
+        return 1;
+    }
+
+    WorldVertexCache cache;
+    cache.AddRange(&mesh.Vertices[0].Pos, mesh.Vertices.size(), sizeof(MeshVertex));
+    BVH bvh;
+    bvh.Build(cache.WorldPositions(), mesh.Indices.data(), mesh.Indices.size());
+
+    // Офлайн-окклюдер от occluder-build, если он есть и собран с этого OBJ
+    OccluderSet occluders;
+    ScopedTimer selectTimer;
+    const char* occludersSource = "offline";
+    uint64_t sourceHash = 0;
+    if (!HashFile64(path, sourceHash) || !LoadOccluderMesh(OccluderMeshPath(path), sourceHash, occluders))
+    {
+        SelectOccluders(cache.WorldPositions(), mesh.Indices.data(), mesh.Indices.size() / 3, kMaxOccluderTriangles, occluders);
+        occludersSource = "runtime";
+    }
+    double selectMs = selectTimer.ElapsedMs();
+
+    // Bounds сабмешей — как у BoxApp (AABB вершин), мешлетов — AABB их сфер
+    BoundsSet submeshes, meshlets;
+    XMFLOAT3 lo = mesh.Vertices[0].Pos, hi = lo;
+    MeshletSet meshletSet;
+    std::vector<uint32_t> meshletTris;   // абсолютные индексы треугольников мешлетов подряд
+    std::vector<uint32_t> meshletFirst;
+    for (const ImportedSubmesh& s : mesh.Submeshes)
+    {
+        XMVECTOR smin = XMLoadFloat3(&mesh.Vertices[s.FirstVertex].Pos), smax = smin;
+        for (uint32_t v = s.FirstVertex; v < s.FirstVertex + s.VertexCount; ++v)
+        {
+            smin = XMVectorMin(smin, XMLoadFloat3(&mesh.Vertices[v].Pos));
+            smax = XMVectorMax(smax, XMLoadFloat3(&mesh.Vertices[v].Pos));
+        }
+        XMFLOAT3 center, extents;
+        XMStoreFloat3(&center, (smin + smax) * 0.5f);
+        XMStoreFloat3(&extents, (smax - smin) * 0.5f);
+        submeshes.Add(center, extents);
+        lo = { std::min(lo.x, center.x - extents.x), std::min(lo.y, center.y - extents.y), std::min(lo.z, center.z - extents.z) };
+        hi = { std::max(hi.x, center.x + extents.x), std::max(hi.y, center.y + extents.y), std::max(hi.z, center.z + extents.z) };
+
+        MeshletRange range = AppendMeshlets(meshletSet, &mesh.Vertices[0].Pos.x, sizeof(MeshVertex),
+            mesh.Indices.data() + s.FirstIndex, s.IndexCount, 0);
+        for (uint32_t m = range.First; m < range.First + range.Count; ++m)
+        {
+            const Meshlet& ml = meshletSet.Meshlets[m];
+            meshlets.Add(ml.Center, { ml.Radius, ml.Radius, ml.Radius });
+            meshletFirst.push_back((uint32_t)meshletTris.size() / 3);
+            for (uint32_t i = 0; i < ml.TriangleCount * 3; ++i)
+                meshletTris.push_back(meshletSet.Vertices[ml.VertexOffset + meshletSet.Triangles[ml.TriangleOffset + i]]);
+        }
+    }
+    meshletFirst.push_back((uint32_t)meshletTris.size() / 3);
+    submeshes.Finish();
+    meshlets.Finish();
+
+    std::vector<CameraPose> poses;
+    const char* posesSource = "recorded";
+    if (!LoadCameraPath(posesPath, poses, &error) || poses.empty())
+    {
+        std::fprintf(stderr, "camera path %s: %s\n", posesPath.c_str(), poses.empty() ? error.c_str() : "no poses");
+        poses = MakeWalkPath(lo, hi, 16);
+        posesSource = "synthetic walk (no camera path)";
+    }
+
+    XMFLOAT3 diag = { hi.x - lo.x, hi.y - lo.y, hi.z - lo.z };
+    float diagLen = std::sqrt(diag.x * diag.x + diag.y * diag.y + diag.z * diag.z);
+    XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, diagLen * 1e-4f, diagLen * 2.0f);
+
+    std::printf("%s: %zu submeshes, %zu meshlets, %zu triangles\n", path.c_str(), mesh.Submeshes.size(),
+        meshletSet.Meshlets.size(), mesh.Indices.size() / 3);
+    std::printf("occluders: %zu triangles (budget %zu), %s in %.1f ms; %zu poses, %s\n",
+        occluders.Indices.size() / 3, kMaxOccluderTriangles, occludersSource, selectMs, poses.size(), posesSource);
+
+    struct Variant
+    {
+        const char*         Name;
+        RasterizeTriangleFn Kernel;
+        double              Ms;
+    };
+    std::vector<Variant> variants = { { "scalar", RasterizeTriangleScalar, 0.0 }, { "sse", RasterizeTriangleSSE, 0.0 } };
+    if (CpuSupportsAVX2()) variants.push_back({ "avx2", RasterizeTriangleAVX2, 0.0 });
+
+    OcclusionBuffer buffer, reference;
+    std::vector<uint32_t> visible(std::max(submeshes.Center.size(), meshlets.Center.size()));
+    bool identical = true;
+    double testMs = 0.0;
+    size_t totals[4] = {}, falseSubmeshes = 0, falseMeshlets = 0;
+    std::printf("pose  rasterized  frustum-vis  occluded  submesh %%  | meshlets vis  occluded  %%   | false\n");
+    for (size_t p = 0; p < poses.size(); ++p)
+    {
+        XMMATRIX viewProj = CameraPoseView(poses[p]) * proj;
+        XMVECTOR eye = XMLoadFloat3(&poses[p].Eye);
+
+        reference.Begin(viewProj);
+        reference.RenderOccluders(occluders, RasterizeTriangleScalar);
+        reference.Finish();
+        for (Variant& v : variants)
+        {
+            const int kRepeats = 20;
+            ScopedTimer timer;
+            for (int r = 0; r < kRepeats; ++r)
+            {
+                buffer.Begin(viewProj);
+                buffer.RenderOccluders(occluders, v.Kernel);
+                buffer.Finish();
+            }
+            v.Ms += timer.ElapsedMs() / kRepeats;
+            identical = identical && std::memcmp(buffer.Depth(), reference.Depth(),
+                kOcclusionWidth * kOcclusionHeight * sizeof(float)) == 0;
+        }
+
+        FrustumPlanes frustum = ExtractFrustumPlanes(viewProj);
+        size_t counts[4] = {}, falseHere = 0;
+        BoundsSet* sets[2] = { &submeshes, &meshlets };
+        for (int k = 0; k < 2; ++k)
+        {
+            size_t n = CullAabbs(sets[k]->Boxes.View(), 0, sets[k]->Boxes.Count(), frustum, visible.data());
+            ScopedTimer timer;
+            std::vector<uint32_t> occluded;
+            for (size_t i = 0; i < n; ++i)
+                if (reference.IsOccluded(sets[k]->Center[visible[i]], sets[k]->Extents[visible[i]]))
+                    occluded.push_back(visible[i]);
+            testMs += timer.ElapsedMs();
+            counts[2 * k] = n;
+            counts[2 * k + 1] = occluded.size();
+
+            for (uint32_t o : occluded)
+            {
+                bool seen = k == 0
+                    ? AnyTriangleVisible(bvh, mesh, mesh.Indices.data() + mesh.Submeshes[o].FirstIndex,
+                        mesh.Submeshes[o].IndexCount / 3, eye, viewProj)
+                    : AnyTriangleVisible(bvh, mesh, meshletTris.data() + 3 * meshletFirst[o],
+                        meshletFirst[o + 1] - meshletFirst[o], eye, viewProj);
+                falseHere += seen;
+                (k == 0 ? falseSubmeshes : falseMeshlets) += seen;
+            }
+        }
+        for (int k = 0; k < 4; ++k) totals[k] += counts[k];
+        std::printf("%4zu  %10zu  %11zu  %8zu  %8.1f%%  | %12zu  %8zu  %5.1f%% | %5zu\n", p,
+            reference.RasterizedTriangles(), counts[0], counts[1], counts[0] ? 100.0 * counts[1] / counts[0] : 0.0,
+            counts[2], counts[3], counts[2] ? 100.0 * counts[3] / counts[2] : 0.0, falseHere);
+    }
+
+    std::printf("occluded after frustum: %.1f%% of submeshes, %.1f%% of meshlets; seen through sub-pixel gaps: %zu submeshes, %zu meshlets\n",
+        totals[0] ? 100.0 * totals[1] / totals[0] : 0.0, totals[2] ? 100.0 * totals[3] / totals[2] : 0.0,
+        falseSubmeshes, falseMeshlets);
+    std::printf("raster %dx%d per pose:", kOcclusionWidth, kOcclusionHeight);
+    for (const Variant& v : variants)
+        std::printf("  %s %.3f ms", v.Name, v.Ms / poses.size());
+    std::printf("  (%s); bounds tests %.3f ms\n", identical ? "identical buffers" : "BUFFERS DIFFER", testMs / poses.size());
+
+    return identical ? 0 : 2;
+}
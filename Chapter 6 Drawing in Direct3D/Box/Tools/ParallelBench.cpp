@@ -0,0 +1,118 @@
+#include "Tools.h"
+#include "ParallelRaycast.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+
+using namespace DirectX;
+
+namespace
+{
+    struct SweepRay
+    {
+        XMFLOAT3 Origin;
+        XMFLOAT3 Dir;
+    };
+
+    // Лучи из камеры на орбите в центр сцены, как в ShootLightFromCamera.
+    std::vector<SweepRay> MakeSweepRays(size_t count)
+    {
+        std::mt19937 rng(4321);
+        std::uniform_real_distribution<float> theta(0.0f, 2.0f * XM_PI);
+        std::uniform_real_distribution<float> phi(0.1f, XM_PI - 0.1f);
+        std::uniform_real_distribution<float> radius(1.0f, 150.0f);
+
+        std::vector<SweepRay> rays(count);
+        for (auto& r : rays)
+        {
+            float t = theta(rng), p = phi(rng), rad = radius(rng);
+            XMVECTOR eye = XMVectorSet(rad * sinf(p) * cosf(t), rad * cosf(p), rad * sinf(p) * sinf(t), 1.0f);
+            XMVECTOR dir = XMVector3Normalize(XMVectorNegate(eye));
+            XMStoreFloat3(&r.Origin, eye + dir * 0.12f);
+            XMStoreFloat3(&r.Dir, dir);
+        }
+        return rays;
+    }
+}
+
+int RunParallelBench(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    size_t rayCount = argc > 1 ? (size_t)std::atoi(argv[1]) : 256;
+    size_t chunkTris = argc > 2 ? (size_t)std::atoi(argv[2]) : 16384;
+
+    std::vector<XMFLOAT3> verts;
+    std::vector<uint32_t> indices;
+    if (!LoadObjTriangleSoup(path, verts, indices)) return 1;
+
+    WorldVertexCache cache;
+    cache.AddRange(verts.data(), verts.size(), sizeof(XMFLOAT3));
+    TriangleStream stream;
+    stream.Build(cache.WorldPositions(), indices.data(), indices.size() / 3);
+    const TrianglesSoA tris = stream.View();
+    if (tris.Count == 0) return 1;
+
+    uint32_t hw = std::thread::hardware_concurrency();
+    if (hw == 0) hw = 1;
+    std::printf("%s: %zu triangles, chunk %zu, %u hardware threads\n", path.c_str(), tris.Count, chunkTris, hw);
+
+    std::vector<SweepRay> rays = MakeSweepRays(rayCount);
+
+    // Эталон — один поток, тот же ядровой цикл по всему потоку.
+    std::vector<RayHit> reference(rays.size());
+    ScopedTimer serialTimer;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        float t = FLT_MAX;
+        reference[i].TriangleId = IntersectTriangles(tris, 0, tris.Count, rays[i].Origin, rays[i].Dir, 0.001f, t);
+        reference[i].T = t;
+    }
+    double serialMs = serialTimer.ElapsedMs();
+    std::printf("threads  ms/ray    Mtri/s   speedup  efficiency  mismatches\n");
+    std::printf("%7s  %7.3f  %8.0f  %7s  %10s  %10s\n", "serial", serialMs / rays.size(),
+        tris.Count * rays.size() / (serialMs * 1e3), "1.00", "-", "-");
+
+    std::vector<uint32_t> counts;
+    for (uint32_t t = 1; t < hw; t *= 2)
+        counts.push_back(t);
+    counts.push_back(hw);
+
+    size_t totalMismatches = 0;
+    for (uint32_t threads : counts)
+    {
+        // Вызывающий поток тоже берёт куски, поэтому воркеров на один меньше.
+        WorkerPool pool(threads > 1 ? threads - 1 : 1);
+        bool callerOnly = threads == 1;
+
+        size_t mismatches = 0;
+        ScopedTimer timer;
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            RayHit hit;
+            if (callerOnly)
+            {
+                float t = FLT_MAX;
+                hit.TriangleId = IntersectTriangles(tris, 0, tris.Count, rays[i].Origin, rays[i].Dir, 0.001f, t);
+                hit.T = t;
+            }
+            else
+            {
+                RaycastLinearParallel(pool, tris, rays[i].Origin, rays[i].Dir, 0.001f, FLT_MAX, hit, chunkTris);
+            }
+
+            if (hit.TriangleId != reference[i].TriangleId ||
+                std::memcmp(&hit.T, &reference[i].T, sizeof(float)) != 0)
+                ++mismatches;
+        }
+        double ms = timer.ElapsedMs();
+        totalMismatches += mismatches;
+
+        double speedup = serialMs / ms;
+        std::printf("%7u  %7.3f  %8.0f  %7.2f  %9.0f%%  %10zu\n", threads, ms / rays.size(),
+            tris.Count * rays.size() / (ms * 1e3), speedup, 100.0 * speedup / threads, mismatches);
+    }
+
+    return totalMismatches == 0 ? 0 : 2;
+}
@@ -0,0 +1,118 @@
+#include "Tools.h"
+#include "BVH.h"
+#include "RayTriangle.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+    struct BenchRay
+    {
+        XMFLOAT3 Origin;
+        XMFLOAT3 Dir;
+    };
+
+    // Лучи как в ShootLightFromCamera: камера на сфере вокруг начала координат, луч в центр.
+    std::vector<BenchRay> MakeOrbitRays(size_t count)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> theta(0.0f, 2.0f * XM_PI);
+        std::uniform_real_distribution<float> phi(0.1f, XM_PI - 0.1f);
+        std::uniform_real_distribution<float> radius(1.0f, 150.0f);
+
+        std::vector<BenchRay> rays(count);
+        for (auto& r : rays)
+        {
+            float t = theta(rng), p = phi(rng), rad = radius(rng);
+            XMVECTOR eye = XMVectorSet(rad * sinf(p) * cosf(t), rad * cosf(p), rad * sinf(p) * sinf(t), 1.0f);
+            XMVECTOR dir = XMVector3Normalize(XMVectorNegate(eye));
+            XMStoreFloat3(&r.Origin, eye + dir * 0.12f);
+            XMStoreFloat3(&r.Dir, dir);
+        }
+        return rays;
+    }
+
+    // Исходный цикл из BoxApp: трансформ каждой вершины + тест каждого треугольника.
+    float LinearClosest(const BenchRay& ray, const std::vector<XMFLOAT3>& verts,
+        const std::vector<uint32_t>& indices, FXMMATRIX world)
+    {
+        XMVECTOR o = XMLoadFloat3(&ray.Origin);
+        XMVECTOR d = XMLoadFloat3(&ray.Dir);
+        float tMin = FLT_MAX;
+        uint32_t triCount = (uint32_t)indices.size() / 3;
+        for (uint32_t i = 0; i < triCount; ++i)
+        {
+            XMVECTOR v0 = XMVector3Transform(XMLoadFloat3(&verts[indices[3 * i + 0]]), world);
+            XMVECTOR v1 = XMVector3Transform(XMLoadFloat3(&verts[indices[3 * i + 1]]), world);
+            XMVECTOR v2 = XMVector3Transform(XMLoadFloat3(&verts[indices[3 * i + 2]]), world);
+            float t = 0.0f;
+            if (RayTriangleIntersect(o, d, v0, v1, v2, t) && t > 0.001f && t < tMin)
+                tMin = t;
+        }
+        return tMin;
+    }
+}
+
+int RunRaycastBench(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    size_t bvhRays = argc > 1 ? (size_t)std::atoi(argv[1]) : 100000;
+    size_t linearRays = bvhRays < 256 ? bvhRays : 256;
+
+    std::vector<XMFLOAT3> verts;
+    std::vector<uint32_t> indices;
+    ScopedTimer loadTimer;
+    if (!LoadObjTriangleSoup(path, verts, indices)) return 1;
+    std::printf("%s: %zu triangles, load %.1f ms\n", path.c_str(), indices.size() / 3, loadTimer.ElapsedMs());
+
+    WorldVertexCache cache;
+    cache.AddRange(verts.data(), verts.size(), sizeof(XMFLOAT3));
+
+    BVH bvh;
+    ScopedTimer buildTimer;
+    bvh.Build(cache.WorldPositions(), indices.data(), indices.size());
+    std::printf("BVH build: %.1f ms, %zu nodes, depth %u, SAH cost %.2f\n",
+        buildTimer.ElapsedMs(), bvh.NodeCount(), bvh.Depth(), bvh.SahCost());
+
+    std::vector<BenchRay> rays = MakeOrbitRays(bvhRays);
+    XMMATRIX world = XMMatrixIdentity();
+
+    std::vector<float> linearT(linearRays);
+    ScopedTimer linearTimer;
+    for (size_t i = 0; i < linearRays; ++i)
+        linearT[i] = LinearClosest(rays[i], verts, indices, world);
+    double linearMs = linearTimer.ElapsedMs();
+
+    std::vector<float> bvhT(rays.size());
+    size_t hits = 0;
+    ScopedTimer bvhTimer;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        RayHit hit;
+        bool h = bvh.IntersectClosest(XMLoadFloat3(&rays[i].Origin), XMLoadFloat3(&rays[i].Dir),
+            0.001f, FLT_MAX, hit);
+        bvhT[i] = h ? hit.T : FLT_MAX;
+        hits += h ? 1 : 0;
+    }
+    double bvhMs = bvhTimer.ElapsedMs();
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < linearRays; ++i)
+    {
+        bool a = linearT[i] != FLT_MAX, b = bvhT[i] != FLT_MAX;
+        if (a != b || (a && std::fabs(linearT[i] - bvhT[i]) > 1e-4f * std::max(1.0f, linearT[i])))
+            ++mismatches;
+    }
+
+    double linearRate = linearRays / (linearMs * 1e-3);
+    double bvhRate = rays.size() / (bvhMs * 1e-3);
+    std::printf("linear: %zu rays, %.3f ms/ray, %.0f rays/s\n", linearRays, linearMs / linearRays, linearRate);
+    std::printf("bvh:    %zu rays (%zu hits), %.4f ms/ray, %.0f rays/s\n", rays.size(), hits, bvhMs / rays.size(), bvhRate);
+    std::printf("speedup %.0fx, mismatches %zu/%zu\n", bvhRate / linearRate, mismatches, linearRays);
+    return mismatches == 0 ? 0 : 2;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <DirectXMath.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Консольные утилиты (бенчмарки и офлайн-обработка ассетов), запускаются без окна и D3D.
+// Рабочая директория — папка Box, как у самого приложения.
+
+static const char kDefaultSponzaPath[] = "Sponza-master/sponza.obj";
+static const char kDefaultStarPath[] = "models/source/725b3a4da0ef_Tiny_green_starw__3.obj";
+
+// Треугольный суп в том же виде, что собирает BoxApp::BuildModelGeometry:
+// по вершине на каждый индекс OBJ. shapeFirstIndex — начало каждого shape в indices.
+bool LoadObjTriangleSoup(const std::string& path,
+    std::vector<DirectX::XMFLOAT3>& positions,
+    std::vector<uint32_t>& indices,
+    std::vector<uint32_t>* shapeFirstIndex = nullptr);
+
+class ScopedTimer
+{
+public:
+    ScopedTimer() : mStart(std::chrono::high_resolution_clock::now()) {}
+    double ElapsedMs() const
+    {
+        auto d = std::chrono::high_resolution_clock::now() - mStart;
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+private:
+    std::chrono::high_resolution_clock::time_point mStart;
+};
+
+int RunRaycastBench(int argc, char** argv);
+int RunKernelBench(int argc, char** argv);
+int RunParallelBench(int argc, char** argv);
+int RunBatchBench(int argc, char** argv);
+int RunBVHCache(int argc, char** argv);
+int RunWideBench(int argc, char** argv);
+int RunMeshStats(int argc, char** argv);
+int RunMeshPack(int argc, char** argv);
+int RunMeshLoadBench(int argc, char** argv);
+int RunObjParseBench(int argc, char** argv);
+int RunObjTokenBench(int argc, char** argv);
+int RunObjStream(int argc, char** argv);
+int RunVertexCompress(int argc, char** argv);
+int RunMeshletStats(int argc, char** argv);
+int RunLodStats(int argc, char** argv);
+int RunCullBench(int argc, char** argv);
+int RunOcclusionBench(int argc, char** argv);
+int RunOccluderBuild(int argc, char** argv);
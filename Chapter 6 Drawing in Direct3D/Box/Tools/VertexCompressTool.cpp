@@ -0,0 +1,152 @@
+#include "Tools.h"
+#include "ModelImporter.h"
+#include "VertexCompression.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    // Октаэдрическая SNORM16 с выбором лучшего соседа укладывается в сотые доли градуса.
+    const double kMaxNormalErrorDeg = 0.01;
+
+    double AngleDeg(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        double la = std::sqrt((double)a.x * a.x + (double)a.y * a.y + (double)a.z * a.z);
+        double lb = std::sqrt((double)b.x * b.x + (double)b.y * b.y + (double)b.z * b.z);
+        double d = ((double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z) / (la * lb);
+        return std::acos(std::clamp(d, -1.0, 1.0)) * 180.0 / 3.14159265358979323846;
+    }
+
+    // Ошибка half относительно половины шага в точке значения (для денормалей — 2^-25).
+    double HalfErrorInSteps(float value, float decoded)
+    {
+        double a = std::fabs((double)value);
+        double step = a < std::ldexp(1.0, -14) ? std::ldexp(1.0, -24) : std::ldexp(1.0, std::ilogb(a) - 10);
+        return std::fabs((double)decoded - value) / (step * 0.5);
+    }
+
+    bool CheckHalf()
+    {
+        // Все конечные half переживают круг half -> float -> half без изменений
+        size_t mismatched = 0;
+        for (uint32_t h = 0; h < 0x10000; ++h)
+        {
+            bool nan = (h & 0x7c00) == 0x7c00 && (h & 0x3ff) != 0;
+            if (!nan && FloatToHalf(HalfToFloat((uint16_t)h)) != h) ++mismatched;
+        }
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> mantissa(1.0f, 2.0f);
+        std::uniform_int_distribution<int> exponent(-26, 15);
+        double worst = 0.0;
+        for (int i = 0; i < 1000000; ++i)
+        {
+            float f = std::ldexp(mantissa(rng), exponent(rng)) * (i & 1 ? -1.0f : 1.0f);
+            if (std::fabs(f) >= 65504.0f) continue;
+            worst = std::max(worst, HalfErrorInSteps(f, HalfToFloat(FloatToHalf(f))));
+        }
+
+        bool ok = mismatched == 0 && worst <= 1.0;
+        std::printf("half: %zu of 65536 codes change on round trip, max error %.3f of half a step on 1M floats\n",
+            mismatched, worst);
+        return ok;
+    }
+
+    bool CheckNormals()
+    {
+        std::mt19937 rng(11);
+        std::normal_distribution<float> gauss;
+        PositionBounds bounds;
+        double worst = 0.0, sum = 0.0;
+        const int count = 1000000;
+        for (int i = 0; i < count; ++i)
+        {
+            MeshVertex v = {};
+            v.Normal = { gauss(rng), gauss(rng), gauss(rng) };
+            double e = AngleDeg(v.Normal, UnpackVertex(PackVertex(v, bounds), bounds).Normal);
+            worst = std::max(worst, e);
+            sum += e;
+        }
+        std::printf("octahedral normals: 1M random directions, mean %.5f deg, max %.5f deg (limit %.2f)\n",
+            sum / count, worst, kMaxNormalErrorDeg);
+        return worst <= kMaxNormalErrorDeg;
+    }
+
+    bool ReportMesh(const std::string& path)
+    {
+        ObjModel    model;
+        std::string error;
+        if (!LoadObjModel(path, model, &error))
+        {
+            std::fprintf(stderr, "failed to load %s: %s\n", path.c_str(), error.c_str());
+            return false;
+        }
+        ImportedMesh mesh;
+        ImportObjMesh(model, mesh);
+
+        // Позиция: не дальше половины шага UNORM16 по каждой оси (Extents / 65535) плюс округление float
+        double posSteps = 0.0, posAbs = 0.0, normalDeg = 0.0, uvSteps = 0.0, uvAbs = 0.0, packMs = 0.0;
+        std::vector<PackedVertex> packed;
+        for (const ImportedSubmesh& s : mesh.Submeshes)
+        {
+            if (s.VertexCount == 0) continue;
+            const MeshVertex* vertices = mesh.Vertices.data() + s.FirstVertex;
+            ScopedTimer timer;
+            PositionBounds bounds = ComputePositionBounds(vertices, s.VertexCount);
+            PackVertices(vertices, s.VertexCount, bounds, packed);
+            packMs += timer.ElapsedMs();
+
+            const float ext[3] = { bounds.Extents.x, bounds.Extents.y, bounds.Extents.z };
+            for (uint32_t i = 0; i < s.VertexCount; ++i)
+            {
+                const MeshVertex& a = vertices[i];
+                MeshVertex b = UnpackVertex(packed[i], bounds);
+                const float pa[3] = { a.Pos.x, a.Pos.y, a.Pos.z };
+                const float pb[3] = { b.Pos.x, b.Pos.y, b.Pos.z };
+                for (int k = 0; k < 3; ++k)
+                {
+                    double d = std::fabs((double)pa[k] - pb[k]);
+                    double slack = 4.0 * FLT_EPSILON * (std::fabs(pa[k]) + ext[k]);
+                    posAbs = std::max(posAbs, d);
+                    if (ext[k] > 0.0f)
+                        posSteps = std::max(posSteps, (d - slack) / (ext[k] / 65535.0));
+                    else if (d > slack)
+                        posSteps = 1e9;
+                }
+                normalDeg = std::max(normalDeg, AngleDeg(a.Normal, b.Normal));
+                uvAbs = std::max({ uvAbs, std::fabs((double)a.TexC.x - b.TexC.x), std::fabs((double)a.TexC.y - b.TexC.y) });
+                uvSteps = std::max({ uvSteps, HalfErrorInSteps(a.TexC.x, b.TexC.x), HalfErrorInSteps(a.TexC.y, b.TexC.y) });
+            }
+        }
+
+        size_t n = mesh.Vertices.size();
+        bool ok = posSteps <= 1.0 && normalDeg <= kMaxNormalErrorDeg && uvSteps <= 1.0;
+        std::printf("%s: %zu submeshes, %zu vertices, VB %.2f -> %.2f MB, pack %.1f ms (%.0f Mverts/s)\n",
+            path.c_str(), mesh.Submeshes.size(), n, n * sizeof(MeshVertex) / 1048576.0,
+            n * sizeof(PackedVertex) / 1048576.0, packMs, packMs > 0.0 ? n / packMs / 1000.0 : 0.0);
+        std::printf("  position max %.6g units, %.3f of the UNORM16 half-step (Extents / 65535)\n", posAbs, posSteps);
+        std::printf("  normal   max %.5f deg\n", normalDeg);
+        std::printf("  texcoord max %.6g, %.3f of the half-float half-step\n", uvAbs, uvSteps);
+        std::printf("  %s\n", ok ? "within bounds" : "OUT OF BOUNDS");
+        return ok;
+    }
+}
+
+int RunVertexCompress(int argc, char** argv)
+{
+    bool ok = CheckHalf();
+    ok = CheckNormals() && ok;
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < argc; ++i)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = { kDefaultSponzaPath, kDefaultStarPath };
+
+    for (const auto& p : paths)
+        ok = ReportMesh(p) && ok;
+    return ok ? 0 : 2;
+}
@@ -0,0 +1,159 @@
+#include "Tools.h"
+#include "WideBVH.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+    struct WideRay
+    {
+        XMFLOAT3 Origin;
+        XMFLOAT3 Dir;
+    };
+
+    // Половина лучей — с орбиты в центр (как выстрелы), половина — изнутри сцены в случайную сторону.
+    std::vector<WideRay> MakeWideRays(size_t count, const std::vector<XMFLOAT3>& verts)
+    {
+        std::mt19937 rng(808);
+        std::uniform_real_distribution<float> theta(0.0f, 2.0f * XM_PI);
+        std::uniform_real_distribution<float> phi(0.1f, XM_PI - 0.1f);
+        std::uniform_real_distribution<float> radius(1.0f, 150.0f);
+        std::uniform_real_distribution<float> sym(-1.0f, 1.0f);
+
+        std::vector<WideRay> rays(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            XMVECTOR eye, dir;
+            if (i % 2 == 0)
+            {
+                float t = theta(rng), p = phi(rng), rad = radius(rng);
+                eye = XMVectorSet(rad * sinf(p) * cosf(t), rad * cosf(p), rad * sinf(p) * sinf(t), 1.0f);
+                dir = XMVector3Normalize(XMVectorNegate(eye));
+            }
+            else
+            {
+                const XMFLOAT3& v = verts[rng() % verts.size()];
+                eye = XMVectorSet(v.x + sym(rng), v.y + sym(rng), v.z + sym(rng), 1.0f);
+                dir = XMVector3Normalize(XMVectorSet(sym(rng), sym(rng), sym(rng), 0.0f));
+            }
+            XMStoreFloat3(&rays[i].Origin, eye);
+            XMStoreFloat3(&rays[i].Dir, dir);
+        }
+        return rays;
+    }
+
+    // 300 треугольников с общим центроидом (0, 0, 0) и 200 случайных: бинарный BVH оставляет
+    // первые одним листом больше 255 — WideBVH обязан его разделить, а не обрезать счётчик.
+    // Центроид в BVH — центр AABB треугольника; здесь AABB каждого симметричны относительно нуля.
+    size_t CoincidentCentroidMismatches(size_t rayCount, uint32_t& largestLeaf)
+    {
+        std::mt19937 rng(255);
+        std::uniform_int_distribution<int> extent(1, 20);
+        std::uniform_real_distribution<float> sym(-1.0f, 1.0f);
+        std::vector<XMFLOAT3> verts;
+        for (int i = 0; i < 300; ++i)
+        {
+            float x = (float)extent(rng), y = (float)extent(rng), z = (float)extent(rng);
+            verts.push_back({ -x, -y, z * sym(rng) });
+            verts.push_back({ x, y * sym(rng), -z });
+            verts.push_back({ x * sym(rng), y, z });
+        }
+        for (int i = 0; i < 200 * 3; ++i)
+            verts.push_back({ 60.0f + 10.0f * sym(rng), 10.0f * sym(rng), 10.0f * sym(rng) });
+        std::vector<uint32_t> indices(verts.size());
+        for (uint32_t i = 0; i < indices.size(); ++i) indices[i] = i;
+
+        WorldVertexCache cache;
+        cache.AddRange(verts.data(), verts.size(), sizeof(XMFLOAT3));
+        BVH bvh;
+        bvh.Build(cache.WorldPositions(), indices.data(), indices.size());
+        WideBVH wide;
+        wide.Build(bvh);
+
+        largestLeaf = 0;
+        for (size_t i = 0; i < bvh.NodeCount(); ++i)
+            largestLeaf = std::max(largestLeaf, bvh.View().Nodes[i].TriCount);
+
+        size_t mismatches = 0;
+        for (const WideRay& ray : MakeWideRays(rayCount, verts))
+        {
+            RayHit a, b;
+            bool ha = bvh.IntersectClosest(XMLoadFloat3(&ray.Origin), XMLoadFloat3(&ray.Dir), 0.001f, FLT_MAX, a);
+            bool hb = wide.IntersectClosest(XMLoadFloat3(&ray.Origin), XMLoadFloat3(&ray.Dir), 0.001f, FLT_MAX, b);
+            if (ha != hb || std::memcmp(&a.T, &b.T, sizeof(float)) != 0)
+                ++mismatches;
+        }
+        return mismatches;
+    }
+}
+
+int RunWideBench(int argc, char** argv)
+{
+    std::string path = argc > 0 ? argv[0] : kDefaultSponzaPath;
+    size_t rayCount = argc > 1 ? (size_t)std::atoi(argv[1]) : 200000;
+
+    std::vector<XMFLOAT3> verts;
+    std::vector<uint32_t> indices;
+    if (!LoadObjTriangleSoup(path, verts, indices)) return 1;
+
+    WorldVertexCache cache;
+    cache.AddRange(verts.data(), verts.size(), sizeof(XMFLOAT3));
+
+    BVH bvh;
+    bvh.Build(cache.WorldPositions(), indices.data(), indices.size());
+
+    WideBVH wide;
+    ScopedTimer collapseTimer;
+    wide.Build(bvh);
+    double collapseMs = collapseTimer.ElapsedMs();
+
+    const BVHView& v = bvh.View();
+    size_t triBytes = v.TriCount * sizeof(uint32_t) + 9 * (v.TriCount + 8) * sizeof(float);
+    size_t binaryBytes = v.NodeCount * sizeof(BVHNode);
+    std::printf("%s: %zu triangles, collapse %.1f ms\n", path.c_str(), v.TriCount, collapseMs);
+    std::printf("layout      nodes    node B   node MB  depth  (+ shared triangles %.2f MB)\n", triBytes / 1048576.0);
+    std::printf("binary   %8zu  %8zu  %8.2f  %5u\n", v.NodeCount, sizeof(BVHNode), binaryBytes / 1048576.0, bvh.Depth());
+    std::printf("wide4-q8 %8zu  %8zu  %8.2f  %5u  (%.0f%% of binary)\n", wide.NodeCount(), sizeof(WideBVHNode),
+        wide.NodeBytes() / 1048576.0, wide.Depth(), 100.0 * wide.NodeBytes() / binaryBytes);
+
+    std::vector<WideRay> rays = MakeWideRays(rayCount, verts);
+    std::vector<RayHit> binaryHits(rays.size()), wideHits(rays.size());
+
+    ScopedTimer binaryTimer;
+    for (size_t i = 0; i < rays.size(); ++i)
+        bvh.IntersectClosest(XMLoadFloat3(&rays[i].Origin), XMLoadFloat3(&rays[i].Dir), 0.001f, FLT_MAX, binaryHits[i]);
+    double binaryMs = binaryTimer.ElapsedMs();
+
+    ScopedTimer wideTimer;
+    for (size_t i = 0; i < rays.size(); ++i)
+        wide.IntersectClosest(XMLoadFloat3(&rays[i].Origin), XMLoadFloat3(&rays[i].Dir), 0.001f, FLT_MAX, wideHits[i]);
+    double wideMs = wideTimer.ElapsedMs();
+
+    // Ближайшее t обязано совпасть побитно; id может отличаться только на общем ребре (равные t).
+    size_t mismatches = 0, tieIds = 0;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        const RayHit& a = binaryHits[i];
+        const RayHit& b = wideHits[i];
+        if (a.IsHit() != b.IsHit() || std::memcmp(&a.T, &b.T, sizeof(float)) != 0)
+            ++mismatches;
+        else if (a.TriangleId != b.TriangleId)
+            ++tieIds;
+    }
+
+    std::printf("binary   %.0f rays/s\n", rays.size() / (binaryMs * 1e-3));
+    std::printf("wide4-q8 %.0f rays/s (%.2fx)\n", rays.size() / (wideMs * 1e-3), binaryMs / wideMs);
+    std::printf("mismatches %zu/%zu, equal-t id ties %zu\n", mismatches, rays.size(), tieIds);
+
+    uint32_t largestLeaf = 0;
+    size_t dupRays = std::min<size_t>(rayCount, 2000);
+    size_t dupMismatches = CoincidentCentroidMismatches(dupRays, largestLeaf);
+    std::printf("coincident centroids (largest binary leaf %u tris): mismatches %zu/%zu\n",
+        largestLeaf, dupMismatches, dupRays);
+    return mismatches == 0 && dupMismatches == 0 ? 0 : 2;
+}
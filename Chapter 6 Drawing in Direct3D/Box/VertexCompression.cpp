@@ -0,0 +1,213 @@
+#include "VertexCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    uint16_t EncodeUnorm16(float p, float center, float extent)
+    {
+        if (!(extent > 0.0f)) return 0;
+        float t = std::clamp((p - center) / extent * 0.5f + 0.5f, 0.0f, 1.0f);
+        return (uint16_t)std::lround(t * 65535.0f);
+    }
+
+    float DecodeUnorm16(uint16_t code, float center, float extent)
+    {
+        return center + ((float)code / 65535.0f * 2.0f - 1.0f) * extent;
+    }
+
+    // Правила D3D для SNORM: -32768 и -32767 оба дают -1.
+    float DecodeSnorm16(int16_t code)
+    {
+        return std::max((float)code / 32767.0f, -1.0f);
+    }
+
+    float SignNotZero(float v)
+    {
+        return v >= 0.0f ? 1.0f : -1.0f;
+    }
+}
+
+PositionBounds ComputePositionBounds(const MeshVertex* vertices, size_t count)
+{
+    PositionBounds bounds;
+    if (count == 0) return bounds;
+
+    float lo[3] = { vertices[0].Pos.x, vertices[0].Pos.y, vertices[0].Pos.z };
+    float hi[3] = { lo[0], lo[1], lo[2] };
+    for (size_t i = 1; i < count; ++i)
+    {
+        const float p[3] = { vertices[i].Pos.x, vertices[i].Pos.y, vertices[i].Pos.z };
+        for (int a = 0; a < 3; ++a)
+        {
+            lo[a] = std::min(lo[a], p[a]);
+            hi[a] = std::max(hi[a], p[a]);
+        }
+    }
+    bounds.Center = { (lo[0] + hi[0]) * 0.5f, (lo[1] + hi[1]) * 0.5f, (lo[2] + hi[2]) * 0.5f };
+    bounds.Extents = { (hi[0] - lo[0]) * 0.5f, (hi[1] - lo[1]) * 0.5f, (hi[2] - lo[2]) * 0.5f };
+    return bounds;
+}
+
+uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent == 0xff)
+        return (uint16_t)(sign | 0x7c00 | (mantissa ? 0x200 | (mantissa >> 13) : 0));
+
+    int e = (int)exponent - 127 + 15;
+    if (e >= 31) return (uint16_t)(sign | 0x7c00);
+
+    if (e <= 0)
+    {
+        // Денормализованный half: mantissa * 2^-24; всё меньше 2^-25 уходит в ноль
+        if (e < -10) return (uint16_t)sign;
+        mantissa |= 0x800000;
+        uint32_t shift = (uint32_t)(14 - e);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t tie = 1u << (shift - 1);
+        if (rest > tie || (rest == tie && (half & 1))) ++half;
+        return (uint16_t)(sign | half);
+    }
+
+    // Перенос из мантиссы при округлении корректно увеличивает порядок (вплоть до inf)
+    uint32_t half = sign | ((uint32_t)e << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) ++half;
+    return (uint16_t)half;
+}
+
+float HalfToFloat(uint16_t value)
+{
+    uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+
+    uint32_t bits;
+    if (exponent == 0)
+    {
+        float f = std::ldexp((float)mantissa, -24);
+        return sign ? -f : f;
+    }
+    if (exponent == 31)
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+    float f;
+    std::memcpy(&f, &bits, 4);
+    return f;
+}
+
+void OctEncode(float x, float y, float z, float& u, float& v)
+{
+    // Нулевая нормаль кодируется как (0, 1, 0) — так же её подменяет PS gbuffer.hlsl
+    float l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    if (!(l1 > 0.0f))
+    {
+        u = 0.0f;
+        v = 1.0f;
+        return;
+    }
+
+    u = x / l1;
+    v = y / l1;
+    if (z < 0.0f)
+    {
+        float pu = u;
+        u = (1.0f - std::fabs(v)) * SignNotZero(pu);
+        v = (1.0f - std::fabs(pu)) * SignNotZero(v);
+    }
+}
+
+void OctDecode(float u, float v, float& x, float& y, float& z)
+{
+    x = u;
+    y = v;
+    z = 1.0f - std::fabs(u) - std::fabs(v);
+    float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    float len = std::sqrt(x * x + y * y + z * z);
+    x /= len;
+    y /= len;
+    z /= len;
+}
+
+PackedVertex PackVertex(const MeshVertex& vertex, const PositionBounds& bounds)
+{
+    PackedVertex packed;
+    packed.Pos[0] = EncodeUnorm16(vertex.Pos.x, bounds.Center.x, bounds.Extents.x);
+    packed.Pos[1] = EncodeUnorm16(vertex.Pos.y, bounds.Center.y, bounds.Extents.y);
+    packed.Pos[2] = EncodeUnorm16(vertex.Pos.z, bounds.Center.z, bounds.Extents.z);
+    packed.Pos[3] = 0;
+
+    float nx = vertex.Normal.x, ny = vertex.Normal.y, nz = vertex.Normal.z;
+    float len = std::sqrt(nx * nx + ny * ny + nz * nz);
+    if (len > 0.0f)
+    {
+        nx /= len;
+        ny /= len;
+        nz /= len;
+    }
+    else
+    {
+        nx = 0.0f;
+        ny = 1.0f;
+        nz = 0.0f;
+    }
+
+    float u, v;
+    OctEncode(nx, ny, nz, u, v);
+    float fu = std::floor(std::clamp(u, -1.0f, 1.0f) * 32767.0f);
+    float fv = std::floor(std::clamp(v, -1.0f, 1.0f) * 32767.0f);
+    float best = -2.0f;
+    for (int i = 0; i < 4; ++i)
+    {
+        int16_t cu = (int16_t)std::clamp(fu + (float)(i & 1), -32767.0f, 32767.0f);
+        int16_t cv = (int16_t)std::clamp(fv + (float)(i >> 1), -32767.0f, 32767.0f);
+        float x, y, z;
+        OctDecode(DecodeSnorm16(cu), DecodeSnorm16(cv), x, y, z);
+        float d = x * nx + y * ny + z * nz;
+        if (d > best)
+        {
+            best = d;
+            packed.Normal[0] = cu;
+            packed.Normal[1] = cv;
+        }
+    }
+
+    packed.TexC[0] = FloatToHalf(vertex.TexC.x);
+    packed.TexC[1] = FloatToHalf(vertex.TexC.y);
+    return packed;
+}
+
+MeshVertex UnpackVertex(const PackedVertex& vertex, const PositionBounds& bounds)
+{
+    MeshVertex unpacked;
+    unpacked.Pos = {
+        DecodeUnorm16(vertex.Pos[0], bounds.Center.x, bounds.Extents.x),
+        DecodeUnorm16(vertex.Pos[1], bounds.Center.y, bounds.Extents.y),
+        DecodeUnorm16(vertex.Pos[2], bounds.Center.z, bounds.Extents.z)
+    };
+    OctDecode(DecodeSnorm16(vertex.Normal[0]), DecodeSnorm16(vertex.Normal[1]),
+        unpacked.Normal.x, unpacked.Normal.y, unpacked.Normal.z);
+    unpacked.TexC = { HalfToFloat(vertex.TexC[0]), HalfToFloat(vertex.TexC[1]) };
+    return unpacked;
+}
+
+void PackVertices(const MeshVertex* vertices, size_t count, const PositionBounds& bounds,
+    std::vector<PackedVertex>& out)
+{
+    out.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        out[i] = PackVertex(vertices[i], bounds);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "ModelImporter.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Формат вершин в VB геометрии сцены (см. RenderingSystem::BuildGeometryPassPSO).
+enum class VertexFormat
+{
+    Full,         // MeshVertex, 32 байта
+    Compressed    // PackedVertex, 16 байт
+};
+
+// Сжатая вершина: позиция — UNORM16 внутри AABB сабмеша, нормаль — октаэдрическая развёртка
+// в SNORM16, текстурные координаты — half. Поля идут в порядке input layout Compressed.
+struct PackedVertex
+{
+    uint16_t Pos[4];      // R16G16B16A16_UNORM, w не используется
+    int16_t  Normal[2];   // R16G16_SNORM
+    uint16_t TexC[2];     // R16G16_FLOAT
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must match the compressed input layout");
+
+// AABB позиций сабмеша в виде центра и полуразмеров, как у DirectX::BoundingBox.
+// VS восстанавливает позицию как Center + (2 * unorm - 1) * Extents.
+struct PositionBounds
+{
+    DirectX::XMFLOAT3 Center = { 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT3 Extents = { 0.0f, 0.0f, 0.0f };
+};
+
+PositionBounds ComputePositionBounds(const MeshVertex* vertices, size_t count);
+
+// IEEE 754 binary16: округление к ближайшему чётному, переполнение — ±inf, NaN сохраняется.
+uint16_t FloatToHalf(float value);
+float    HalfToFloat(uint16_t value);
+
+// Октаэдрическая развёртка единичного вектора в [-1, 1]^2 (Cigolle et al. 2014) и обратно;
+// OctDecode возвращает нормализованный вектор.
+void OctEncode(float x, float y, float z, float& u, float& v);
+void OctDecode(float u, float v, float& x, float& y, float& z);
+
+// Из четырёх соседних SNORM16-точек берётся та, что даёт наименьшую угловую ошибку.
+PackedVertex PackVertex(const MeshVertex& vertex, const PositionBounds& bounds);
+
+// Ровно то, что делает VS gbuffer.hlsl с COMPRESSED_VERTICES.
+MeshVertex UnpackVertex(const PackedVertex& vertex, const PositionBounds& bounds);
+
+void PackVertices(const MeshVertex* vertices, size_t count, const PositionBounds& bounds,
+    std::vector<PackedVertex>& out);
@@ -0,0 +1,306 @@
+#include "WideBVH.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+using namespace DirectX;
+
+namespace
+{
+    const int kMinExp = -100;
+    const int kMaxExp = 127;
+    // Лист бинарного BVH бывает больше (совпавшие центроиды, предел глубины) — такие делятся
+    // пополам по leaf-порядку; 24 уровня деления хватает на 2^32 треугольников.
+    const uint32_t kMaxWideLeafTris = 255;   // TriCount в WideBVHNode — байт
+    const uint32_t kMaxLeafSplitLevels = 24;
+    // Глубина <= глубины бинарного BVH с делением листьев, +3 записи на уровень
+    const int kStackSize = 3 * (kBVHMaxDepth + kMaxLeafSplitLevels) + 4;
+
+    float ExpToScale(int e)
+    {
+        uint32_t bits = (uint32_t)(e + 127) << 23;
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    // Та же последовательность операций (mul, затем add), что и в SSE-декодере обхода.
+    float Decode(float origin, uint8_t q, float scale)
+    {
+        return origin + (float)q * scale;
+    }
+
+    float Axis(const XMFLOAT3& v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    float HalfArea(const BVHNode& n)
+    {
+        float ex = n.BoundsMax.x - n.BoundsMin.x;
+        float ey = n.BoundsMax.y - n.BoundsMin.y;
+        float ez = n.BoundsMax.z - n.BoundsMin.z;
+        return ex * ey + ey * ez + ez * ex;
+    }
+
+    float SafeInv(float d)
+    {
+        return std::fabs(d) > 1e-20f ? 1.0f / d : (d < 0.0f ? -1e30f : 1e30f);
+    }
+
+    // Наименьший показатель, при котором 255 шагов покрывают [origin, maxV].
+    int ChooseExp(float origin, float maxV)
+    {
+        float extent = maxV - origin;
+        int e = kMinExp;
+        if (extent > 0.0f)
+        {
+            int ex;
+            std::frexp(extent / 255.0f, &ex);
+            e = std::max(kMinExp, ex - 1);
+        }
+        while (e < kMaxExp && Decode(origin, 255, ExpToScale(e)) < maxV)
+            ++e;
+        return e;
+    }
+
+    // Копия узлов бинарного BVH, где листья больше kMaxWideLeafTris заменены поддеревьями
+    // с тем же боксом. Новые узлы дописываются в конец и проверяются тем же проходом.
+    std::vector<BVHNode> SplitOversizedLeaves(const BVHView& v)
+    {
+        std::vector<BVHNode> nodes(v.Nodes, v.Nodes + v.NodeCount);
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (nodes[i].TriCount <= kMaxWideLeafTris) continue;
+            BVHNode left = nodes[i], right = nodes[i];
+            left.TriCount = nodes[i].TriCount / 2;
+            right.LeftFirst = nodes[i].LeftFirst + left.TriCount;
+            right.TriCount = nodes[i].TriCount - left.TriCount;
+            nodes[i].LeftFirst = (uint32_t)nodes.size();
+            nodes[i].TriCount = 0;
+            nodes.push_back(left);
+            nodes.push_back(right);
+        }
+        return nodes;
+    }
+
+    struct StackEntry
+    {
+        uint32_t Ref;
+        uint32_t TriCount;   // 0 — внутренний узел
+        float    T;
+    };
+}
+
+void WideBVH::Clear()
+{
+    mNodes.clear();
+    mSource = nullptr;
+    mDepth = 0;
+}
+
+void WideBVH::Build(const BVH& source)
+{
+    Clear();
+    const BVHView& v = source.View();
+    if (v.NodeCount == 0) return;
+
+    mSource = &source;
+    std::vector<BVHNode> binary = SplitOversizedLeaves(v);
+    mNodes.reserve(binary.size() / 2 + 1);
+    mNodes.emplace_back();
+    BuildNode(binary.data(), 0, 0, 1);
+}
+
+void WideBVH::BuildNode(const BVHNode* bin, uint32_t wideIdx, uint32_t binaryIdx, uint32_t depth)
+{
+    mDepth = std::max(mDepth, depth);
+    const BVHNode& parent = bin[binaryIdx];
+
+    // Раскрываем детей с наибольшей площадью, пока их не станет 4.
+    uint32_t children[4];
+    uint32_t count = 0;
+    if (parent.IsLeaf())
+    {
+        children[count++] = binaryIdx;
+    }
+    else
+    {
+        children[count++] = parent.LeftFirst;
+        children[count++] = parent.LeftFirst + 1;
+        while (count < 4)
+        {
+            int best = -1;
+            float bestArea = -1.0f;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const BVHNode& c = bin[children[i]];
+                if (!c.IsLeaf() && HalfArea(c) > bestArea)
+                {
+                    best = (int)i;
+                    bestArea = HalfArea(c);
+                }
+            }
+            if (best < 0) break;
+            uint32_t expanded = children[best];
+            children[best] = bin[expanded].LeftFirst;
+            children[count++] = bin[expanded].LeftFirst + 1;
+        }
+    }
+
+    WideBVHNode node;
+    std::memset(&node, 0, sizeof(node));
+    node.ChildCount = (uint8_t)count;
+
+    float scale[3];
+    for (int a = 0; a < 3; ++a)
+    {
+        node.Origin[a] = Axis(parent.BoundsMin, a);
+        int e = ChooseExp(node.Origin[a], Axis(parent.BoundsMax, a));
+        node.Exp[a] = (int8_t)e;
+        scale[a] = ExpToScale(e);
+        for (int c = 0; c < 4; ++c)
+        {
+            node.QMin[a][c] = 255;
+            node.QMax[a][c] = 0;
+        }
+    }
+
+    uint32_t innerChildren[4];
+    uint32_t innerWide[4];
+    uint32_t innerCount = 0;
+    for (uint32_t c = 0; c < count; ++c)
+    {
+        const BVHNode& child = bin[children[c]];
+        for (int a = 0; a < 3; ++a)
+        {
+            float o = node.Origin[a];
+            float cMin = Axis(child.BoundsMin, a);
+            float cMax = Axis(child.BoundsMax, a);
+
+            float lo = std::floor((cMin - o) / scale[a]);
+            float hi = std::ceil((cMax - o) / scale[a]);
+            int qMin = (int)std::min(255.0f, std::max(0.0f, lo));
+            int qMax = (int)std::min(255.0f, std::max(0.0f, hi));
+            while (qMin > 0 && Decode(o, (uint8_t)qMin, scale[a]) > cMin) --qMin;
+            while (qMax < 255 && Decode(o, (uint8_t)qMax, scale[a]) < cMax) ++qMax;
+
+            node.QMin[a][c] = (uint8_t)qMin;
+            node.QMax[a][c] = (uint8_t)qMax;
+        }
+
+        if (child.IsLeaf())
+        {
+            assert(child.TriCount <= kMaxWideLeafTris);
+            node.Child[c] = child.LeftFirst;
+            node.TriCount[c] = (uint8_t)child.TriCount;
+        }
+        else
+        {
+            innerChildren[innerCount] = children[c];
+            innerWide[innerCount] = (uint32_t)mNodes.size();
+            node.Child[c] = innerWide[innerCount];
+            mNodes.emplace_back();
+            ++innerCount;
+        }
+    }
+
+    mNodes[wideIdx] = node;
+    for (uint32_t i = 0; i < innerCount; ++i)
+        BuildNode(bin, innerWide[i], innerChildren[i], depth + 1);
+}
+
+bool WideBVH::IntersectClosest(FXMVECTOR orig, FXMVECTOR dir,
+    float tMin, float tMax, RayHit& hit) const
+{
+    if (mNodes.empty()) return false;
+
+    XMFLOAT3 o, d;
+    XMStoreFloat3(&o, orig);
+    XMStoreFloat3(&d, dir);
+
+    const BVHView&      src = mSource->View();
+    const TrianglesSoA& tris = src.Tris;
+
+    const __m128 ox = _mm_set1_ps(o.x), oy = _mm_set1_ps(o.y), oz = _mm_set1_ps(o.z);
+    const __m128 ix = _mm_set1_ps(SafeInv(d.x)), iy = _mm_set1_ps(SafeInv(d.y)), iz = _mm_set1_ps(SafeInv(d.z));
+    const __m128 vMin = _mm_set1_ps(tMin);
+    const __m128i zero = _mm_setzero_si128();
+
+    auto unpack = [&](const uint8_t* q) {
+        int32_t packed;
+        std::memcpy(&packed, q, 4);
+        __m128i v = _mm_cvtsi32_si128(packed);
+        v = _mm_unpacklo_epi8(v, zero);
+        v = _mm_unpacklo_epi16(v, zero);
+        return _mm_cvtepi32_ps(v);
+    };
+
+    float closest = tMax;
+    uint32_t closestTri = UINT32_MAX;
+
+    StackEntry stack[kStackSize];
+    int sp = 0;
+    stack[sp++] = { 0, 0, tMin };
+
+    while (sp > 0)
+    {
+        StackEntry e = stack[--sp];
+        if (e.T > closest) continue;
+
+        if (e.TriCount > 0)
+        {
+            uint32_t tri = IntersectTriangles(tris, e.Ref, e.TriCount, o, d, tMin, closest);
+            if (tri != UINT32_MAX) closestTri = tri;
+            continue;
+        }
+
+        const WideBVHNode& n = mNodes[e.Ref];
+        const __m128 vMax = _mm_set1_ps(closest);
+
+        __m128 t0 = vMin, t1 = vMax;
+        const __m128 oAxis[3] = { ox, oy, oz };
+        const __m128 iAxis[3] = { ix, iy, iz };
+        for (int a = 0; a < 3; ++a)
+        {
+            __m128 origin = _mm_set1_ps(n.Origin[a]);
+            __m128 scale = _mm_set1_ps(ExpToScale(n.Exp[a]));
+            __m128 lo = _mm_add_ps(origin, _mm_mul_ps(unpack(n.QMin[a]), scale));
+            __m128 hi = _mm_add_ps(origin, _mm_mul_ps(unpack(n.QMax[a]), scale));
+            __m128 ta = _mm_mul_ps(_mm_sub_ps(lo, oAxis[a]), iAxis[a]);
+            __m128 tb = _mm_mul_ps(_mm_sub_ps(hi, oAxis[a]), iAxis[a]);
+            t0 = _mm_max_ps(t0, _mm_min_ps(ta, tb));
+            t1 = _mm_min_ps(t1, _mm_max_ps(ta, tb));
+        }
+        int mask = _mm_movemask_ps(_mm_cmple_ps(t0, t1)) & ((1 << n.ChildCount) - 1);
+        if (mask == 0) continue;
+
+        alignas(16) float tNear[4];
+        _mm_store_ps(tNear, t0);
+
+        // Попавшие дети по убыванию t: ближний окажется на вершине стека.
+        StackEntry hits[4];
+        int hitCount = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            if (!(mask & (1 << c))) continue;
+            StackEntry h = { n.Child[c], n.TriCount[c], tNear[c] };
+            int i = hitCount++;
+            while (i > 0 && hits[i - 1].T < h.T)
+            {
+                hits[i] = hits[i - 1];
+                --i;
+            }
+            hits[i] = h;
+        }
+        for (int i = 0; i < hitCount; ++i)
+            stack[sp++] = hits[i];
+    }
+
+    if (closestTri == UINT32_MAX) return false;
+    hit.T = closest;
+    hit.TriangleId = src.TriIds[closestTri];
+    return true;
+}
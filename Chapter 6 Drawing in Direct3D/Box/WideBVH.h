@@ -0,0 +1,49 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "BVH.h"
+
+// Узел 4-арного BVH, ровно одна кэш-линия.
+// Боксы детей квантованы в 8 бит относительно бокса узла: min = Origin + q * 2^Exp по каждой оси.
+// Квантование консервативное — декодированный бокс всегда содержит исходный.
+struct alignas(64) WideBVHNode
+{
+    float    Origin[3];
+    int8_t   Exp[3];
+    uint8_t  ChildCount;
+    uint8_t  QMin[3][4];     // [ось][ребёнок]; пустые слоты: QMin = 255, QMax = 0
+    uint8_t  QMax[3][4];
+    uint32_t Child[4];       // inner: индекс узла, leaf: первый треугольник в leaf-порядке
+    uint8_t  TriCount[4];    // 0 у внутренних детей; листья больше 255 Build делит
+};
+
+static_assert(sizeof(WideBVHNode) == 64, "WideBVHNode must be one cache line");
+
+// Сворачивает бинарный BVH в 4-арный. Треугольники не копируются: обход идёт
+// по leaf-порядку исходного BVH, поэтому он должен жить не меньше WideBVH
+// и не перестраиваться (после Build/Refit исходного — пересобрать).
+class WideBVH
+{
+public:
+    void Build(const BVH& source);
+    void Clear();
+
+    bool IntersectClosest(
+        DirectX::FXMVECTOR orig, DirectX::FXMVECTOR dir,
+        float tMin, float tMax, RayHit& hit) const;
+
+    bool     Empty()       const { return mNodes.empty(); }
+    size_t   NodeCount()   const { return mNodes.size(); }
+    uint32_t Depth()       const { return mDepth; }
+    size_t   NodeBytes()   const { return mNodes.size() * sizeof(WideBVHNode); }
+
+    const std::vector<WideBVHNode>& Nodes() const { return mNodes; }
+
+private:
+    void BuildNode(const BVHNode* binary, uint32_t wideIdx, uint32_t binaryIdx, uint32_t depth);
+
+    std::vector<WideBVHNode> mNodes;   // корень — 0; C++17 выделяет с alignas(64)
+    const BVH*               mSource = nullptr;
+    uint32_t                 mDepth = 0;
+};
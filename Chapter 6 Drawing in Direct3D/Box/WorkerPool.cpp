@@ -0,0 +1,105 @@
+#include "WorkerPool.h"
+#include <atomic>
+
+WorkerPool::WorkerPool(uint32_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        uint32_t hw = std::thread::hardware_concurrency();
+        threadCount = hw > 1 ? hw - 1 : 1;
+    }
+
+    mThreads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i)
+        mThreads.emplace_back([this] { WorkerLoop(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCv.notify_all();
+    for (auto& t : mThreads)
+        t.join();
+}
+
+void WorkerPool::Submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTasks.push_back(std::move(task));
+    }
+    mCv.notify_one();
+}
+
+void WorkerPool::WorkerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCv.wait(lock, [this] { return mStop || !mTasks.empty(); });
+            // При остановке сначала дорабатываем очередь.
+            if (mTasks.empty()) return;
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+        task();
+    }
+}
+
+void WorkerPool::ParallelFor(size_t count, size_t grain,
+    const std::function<void(size_t begin, size_t end)>& body)
+{
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+
+    const size_t chunks = (count + grain - 1) / grain;
+    std::atomic<size_t>   next(0);
+    std::atomic<uint32_t> pending(0);
+
+    auto run = [&]() {
+        for (;;)
+        {
+            size_t c = next.fetch_add(1);
+            if (c >= chunks) break;
+            size_t begin = c * grain;
+            size_t end = begin + grain < count ? begin + grain : count;
+            body(begin, end);
+        }
+    };
+
+    size_t helpers = chunks - 1 < mThreads.size() ? chunks - 1 : mThreads.size();
+    pending = (uint32_t)helpers;
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        Submit([&]() {
+            run();
+            if (pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mCv.notify_all();
+            }
+        });
+    }
+
+    run();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (pending.load() != 0)
+    {
+        if (!mTasks.empty())
+        {
+            std::function<void()> task = std::move(mTasks.front());
+            mTasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+            continue;
+        }
+        mCv.wait(lock);
+    }
+}
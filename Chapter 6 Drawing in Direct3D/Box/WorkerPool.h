@@ -0,0 +1,39 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Фиксированный пул потоков с общей очередью задач.
+class WorkerPool
+{
+public:
+    // threadCount = 0: по числу ядер минус один (вызывающий поток тоже работает в ParallelFor).
+    explicit WorkerPool(uint32_t threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    uint32_t ThreadCount() const { return (uint32_t)mThreads.size(); }
+
+    void Submit(std::function<void()> task);
+
+    // Делит [0, count) на куски по grain и раздаёт их пулу и вызывающему потоку.
+    // Возвращается, когда выполнены все куски. Пока ждёт, сам разбирает очередь,
+    // поэтому безопасен и при вызове из задачи пула.
+    void ParallelFor(size_t count, size_t grain,
+        const std::function<void(size_t begin, size_t end)>& body);
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread>          mThreads;
+    std::deque<std::function<void()>> mTasks;
+    std::mutex                        mMutex;
+    std::condition_variable           mCv;
+    bool                              mStop = false;
+};
@@ -0,0 +1,101 @@
+#include "WorldVertexCache.h"
+#include <cstring>
+
+using namespace DirectX;
+
+uint32_t WorldVertexCache::AddRange(const void* positions, size_t count, size_t stride)
+{
+    Range r;
+    r.First = (uint32_t)mLocalX.size();
+    r.Count = (uint32_t)count;
+    XMStoreFloat4x4(&r.World, XMMatrixIdentity());
+
+    const uint8_t* src = static_cast<const uint8_t*>(positions);
+    for (size_t i = 0; i < count; ++i, src += stride)
+    {
+        const XMFLOAT3* p = reinterpret_cast<const XMFLOAT3*>(src);
+        mLocalX.push_back(p->x);
+        mLocalY.push_back(p->y);
+        mLocalZ.push_back(p->z);
+    }
+
+    // С единичной матрицей мировые позиции совпадают с локальными.
+    mWorldX.insert(mWorldX.end(), mLocalX.begin() + r.First, mLocalX.end());
+    mWorldY.insert(mWorldY.end(), mLocalY.begin() + r.First, mLocalY.end());
+    mWorldZ.insert(mWorldZ.end(), mLocalZ.begin() + r.First, mLocalZ.end());
+
+    mRanges.push_back(r);
+    ++mVersion;
+    return (uint32_t)mRanges.size() - 1;
+}
+
+void WorldVertexCache::SetWorld(uint32_t range, const XMFLOAT4X4& world)
+{
+    Range& r = mRanges[range];
+    if (std::memcmp(&r.World, &world, sizeof(XMFLOAT4X4)) == 0) return;
+    r.World = world;
+    r.Dirty = true;
+}
+
+bool WorldVertexCache::Update()
+{
+    bool changed = false;
+    for (auto& r : mRanges)
+    {
+        if (!r.Dirty) continue;
+        TransformRange(r);
+        r.Dirty = false;
+        changed = true;
+    }
+    if (changed) ++mVersion;
+    return changed;
+}
+
+void WorldVertexCache::TransformRange(const Range& r)
+{
+    const XMFLOAT4X4& m = r.World;
+    const float* lx = mLocalX.data() + r.First;
+    const float* ly = mLocalY.data() + r.First;
+    const float* lz = mLocalZ.data() + r.First;
+    float* wx = mWorldX.data() + r.First;
+    float* wy = mWorldY.data() + r.First;
+    float* wz = mWorldZ.data() + r.First;
+
+    // Построчная схема (row vector * matrix), как у XMVector3TransformCoord без деления на w:
+    // мировые матрицы аффинные.
+    for (uint32_t i = 0; i < r.Count; ++i)
+    {
+        float x = lx[i], y = ly[i], z = lz[i];
+        wx[i] = x * m._11 + y * m._21 + z * m._31 + m._41;
+        wy[i] = x * m._12 + y * m._22 + z * m._32 + m._42;
+        wz[i] = x * m._13 + y * m._23 + z * m._33 + m._43;
+    }
+}
+
+void WorldVertexCache::Clear()
+{
+    mLocalX.clear(); mLocalY.clear(); mLocalZ.clear();
+    mWorldX.clear(); mWorldY.clear(); mWorldZ.clear();
+    mRanges.clear();
+    ++mVersion;
+}
+
+PositionsSoA WorldVertexCache::WorldPositions() const
+{
+    PositionsSoA p;
+    p.X = mWorldX.data();
+    p.Y = mWorldY.data();
+    p.Z = mWorldZ.data();
+    p.Count = mWorldX.size();
+    return p;
+}
+
+PositionsSoA WorldVertexCache::LocalPositions() const
+{
+    PositionsSoA p;
+    p.X = mLocalX.data();
+    p.Y = mLocalY.data();
+    p.Z = mLocalZ.data();
+    p.Count = mLocalX.size();
+    return p;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+// Невладеющий вид на позиции в SoA-раскладке: X[i], Y[i], Z[i].
+struct PositionsSoA
+{
+    const float* X = nullptr;
+    const float* Y = nullptr;
+    const float* Z = nullptr;
+    size_t       Count = 0;
+
+    DirectX::XMFLOAT3 Get(uint32_t i) const { return { X[i], Y[i], Z[i] }; }
+};
+
+// Кэш вершин в мировом пространстве для CPU-пикинга.
+// Вершины разбиты на диапазоны (по одному на RenderItem), у каждого своя мировая матрица.
+// Диапазон пересчитывается только когда его матрица реально изменилась.
+class WorldVertexCache
+{
+public:
+    // positions — первые 12 байт каждой вершины с шагом stride (как в vertex buffer).
+    uint32_t AddRange(const void* positions, size_t count, size_t stride);
+
+    // Помечает диапазон грязным, только если матрица отличается от текущей.
+    void SetWorld(uint32_t range, const DirectX::XMFLOAT4X4& world);
+
+    // Пересчитывает грязные диапазоны. true — мировые позиции изменились.
+    bool Update();
+
+    void Clear();
+
+    PositionsSoA WorldPositions() const;
+    // Исходные позиции, как их передали в AddRange, — не зависят от SetWorld.
+    PositionsSoA LocalPositions() const;
+    size_t       VertexCount() const { return mWorldX.size(); }
+    size_t       RangeCount()  const { return mRanges.size(); }
+    uint64_t     Version()     const { return mVersion; }
+
+private:
+    struct Range
+    {
+        uint32_t            First = 0;
+        uint32_t            Count = 0;
+        DirectX::XMFLOAT4X4 World;
+        bool                Dirty = false;
+    };
+
+    void TransformRange(const Range& r);
+
+    std::vector<float> mLocalX, mLocalY, mLocalZ;
+    std::vector<float> mWorldX, mWorldY, mWorldZ;
+    std::vector<Range> mRanges;
+    uint64_t           mVersion = 0;
+};